@@ -0,0 +1,138 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_ALARM_H__
+#define __SEEKNODE_ALARM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Enumerated type representing the alarm conditions.
+typedef enum seeknode_alarm_type_t
+{
+	SEEKNODE_ALARM_TYPE_ABOVE = 0,   // Any pixel of the region above the threshold
+	SEEKNODE_ALARM_TYPE_BELOW,       // Any pixel of the region below the threshold
+	SEEKNODE_ALARM_TYPE_RISE,        // Region mean risen by more than the threshold within the window
+} seeknode_alarm_type_t;
+
+// Alarm rule over a rectangular region.
+// Rules latch: a rule fires once when its condition is met and clears once the value is back by the hysteresis.
+typedef struct seeknode_alarm_rule_t
+{
+	// Options
+	std::string name;
+	seeknode_alarm_type_t type;
+	int x;
+	int y;
+	int width;                 // Region; a width or height of 0 extends to the frame edge
+	int height;
+	float threshold;           // Degrees (above/below) or degrees of rise (rise)
+	float hysteresis;          // Degrees the value must move back by to clear
+	int64_t window_ns;         // Rise window
+	bool is_recording;         // Whether the rule triggers recording
+
+	// Region clipped to the frame.
+	size_t left;
+	size_t top;
+	size_t right;
+	size_t bottom;
+
+	// State.
+	bool is_active;
+	float value;               // Last evaluated value: region max/min or rise
+	uint16_t value_x;          // Location of the region max/min
+	uint16_t value_y;
+	std::vector<std::pair<int64_t, float> > history;  // Ascending region means within the window from history_head (rise)
+	size_t history_head;
+} seeknode_alarm_rule_t;
+
+// Alarm state change produced by a frame.
+typedef struct seeknode_alarm_event_t
+{
+	size_t rule;
+	bool is_active;
+	float value;
+	uint16_t x;
+	uint16_t y;
+} seeknode_alarm_event_t;
+
+// Evaluates a set of alarm rules on thermography frames.
+// The frame header extrema bound every region extremum, so most frames are decided without reading any pixel;
+// only rules that may change state scan their region.
+typedef struct seeknode_alarm_engine_t
+{
+	std::vector<seeknode_alarm_rule_t> rules;
+
+	// Frame geometry the regions are clipped to, and its position on the sensor (regions are in sensor coordinates).
+	size_t origin_x;
+	size_t origin_y;
+	size_t width;
+	size_t height;
+
+	// Events of the last processed frame.
+	std::vector<seeknode_alarm_event_t> events;
+
+	// Statistics.
+	uint64_t num_frames;
+	uint64_t num_scans;
+	uint64_t num_skips;
+} seeknode_alarm_engine_t;
+
+// Initializes an engine without rules.
+void seeknode_alarm_engine_init(seeknode_alarm_engine_t* engine);
+
+// Gets the alarm type from its name ("above", "below" or "rise").
+bool seeknode_alarm_type_from_str(const char* str, seeknode_alarm_type_t* type);
+
+// Gets the name of an alarm type.
+const char* seeknode_alarm_type_get_str(seeknode_alarm_type_t type);
+
+// Adds a rule; the state fields are reset.
+void seeknode_alarm_engine_add_rule(seeknode_alarm_engine_t* engine, const seeknode_alarm_rule_t* rule);
+
+// Clips the regions to a frame geometry.
+void seeknode_alarm_engine_configure(seeknode_alarm_engine_t* engine, size_t width, size_t height);
+
+// Clips the regions to a frame covering a window of the sensor.
+// Event locations are then relative to the window origin.
+void seeknode_alarm_engine_configure_window(seeknode_alarm_engine_t* engine, size_t origin_x, size_t origin_y, size_t width, size_t height);
+
+// Evaluates the rules on a thermography frame with its header extrema and timestamp.
+// Returns true if any rule changed state; the changes are in engine->events.
+// The stride is expressed in bytes to accommodate SDK line padding.
+bool seeknode_alarm_engine_process(
+	seeknode_alarm_engine_t* engine,
+	const float* pixels,
+	size_t stride,
+	float min_value,
+	float max_value,
+	int64_t timestamp_ns);
+
+// Returns true while any recording rule is active.
+bool seeknode_alarm_engine_is_recording(const seeknode_alarm_engine_t* engine);
+
+#endif /* __SEEKNODE_ALARM_H__ */
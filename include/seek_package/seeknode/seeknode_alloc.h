@@ -0,0 +1,66 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_ALLOC_H__
+#define __SEEKNODE_ALLOC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Heap allocation tracking for the frame path.
+//
+// In the allocation tracking build (cmake -DSEEKNODE_ALLOC_TRACKING=ON) the malloc family, and with it operator new,
+// is interposed. Allocations made by tracked threads while tracking is armed are counted, and the call stacks of the
+// first ones are kept for the report. Processing threads mark themselves tracked; tracking is armed once they are warm,
+// after which a steady-state frame path must not allocate. In regular builds every function is a no-op.
+
+// Maximum number of call stacks kept for the report.
+#define SEEKNODE_ALLOC_MAX_STACKS 8
+
+// Checks whether allocation tracking is compiled in.
+bool seeknode_alloc_is_available();
+
+// Marks the calling thread as a processing thread, or not.
+void seeknode_alloc_track_thread(bool is_tracked);
+
+// Starts (or stops) counting the allocations of tracked threads; starting resets the count.
+void seeknode_alloc_arm(bool is_armed);
+
+// Gets the number of allocations counted since armed.
+uint64_t seeknode_alloc_get_count();
+
+// Prints the count and the call stacks of the first allocations counted.
+void seeknode_alloc_print_report(FILE* file);
+
+// Pauses tracking on the calling thread for its lifetime, around calls that allocate by design (e.g. roscpp
+// serializing a message into a new buffer).
+typedef struct seeknode_alloc_pause_t
+{
+	bool was_tracked;
+
+	seeknode_alloc_pause_t();
+	~seeknode_alloc_pause_t();
+} seeknode_alloc_pause_t;
+
+#endif /* __SEEKNODE_ALLOC_H__ */
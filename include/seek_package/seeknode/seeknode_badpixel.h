@@ -0,0 +1,113 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_BADPIXEL_H__
+#define __SEEKNODE_BADPIXEL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "seekcamera/seekcamera_frame.h"
+
+// Learns and corrects defective pixels of a core.
+//
+// Learning accumulates, for every pixel and over a number of frames, its temporal variance and how often it is a
+// spatial outlier (residual against the median of its 8-neighbours beyond outlier_sigma robust deviations).
+// A pixel is flagged when it is an outlier in most frames (hot/cold), when it barely varies while the rest of the
+// array does (stuck), or when it varies much more than the rest (flickering).
+//
+// Correction replaces each flagged pixel with the median of its good neighbours.
+// The neighbour lists are resolved once into a flat replacement index so the frame path is a gather and a median.
+// Isolated defects (all 8 neighbours good, the common case) are corrected four at a time with a vector median;
+// clusters and pixels at the sensor or window edge go through the general index.
+typedef struct seeknode_badpixel_t
+{
+	// Options
+	size_t learn_frames;        // Number of frames to learn from
+	float outlier_sigma;        // Spatial residual, in robust deviations, considered an outlier
+	float outlier_fraction;     // Fraction of the frames a pixel must be an outlier in to be flagged
+	float stuck_ratio;          // Variance, relative to the median variance, under which a pixel is stuck
+	float flicker_ratio;        // Variance, relative to the median variance, over which a pixel is flickering
+
+	// Frame geometry.
+	size_t width;
+	size_t height;
+
+	// Bad pixel bitmap (one byte per pixel, non-zero when bad).
+	std::vector<uint8_t> bitmap;
+	bool has_map;
+
+	// Replacement index: pixel i = bad[i] is replaced by the median of neighbours[offsets[i]..offsets[i + 1]).
+	std::vector<uint32_t> bad;
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> neighbours;
+	std::vector<uint32_t> isolated;     // Entries of bad with exactly the 8 neighbours of the 3x3 neighbourhood
+	std::vector<uint32_t> clustered;    // Every other entry of bad
+
+	// Learning state.
+	size_t learned_frames;
+	std::vector<float> mean;
+	std::vector<float> m2;
+	std::vector<uint16_t> outliers;
+	std::vector<float> residuals;
+	std::vector<float> scratch;
+} seeknode_badpixel_t;
+
+// Initializes an empty map with the default options.
+void seeknode_badpixel_init(seeknode_badpixel_t* badpixel);
+
+// Sets the frame geometry and discards the map and learning state if it changed.
+void seeknode_badpixel_configure(seeknode_badpixel_t* badpixel, size_t width, size_t height);
+
+// Restarts learning from scratch.
+void seeknode_badpixel_start_learning(seeknode_badpixel_t* badpixel);
+
+// Returns true while the map is being learned.
+bool seeknode_badpixel_is_learning(const seeknode_badpixel_t* badpixel);
+
+// Feeds a frame to the learner.
+// Returns true on the frame that completes learning; the map is then built and ready to be applied and saved.
+bool seeknode_badpixel_learn(seeknode_badpixel_t* badpixel, const float* pixels, size_t stride);
+
+// Replaces the flagged pixels of a thermography frame in place.
+void seeknode_badpixel_apply(const seeknode_badpixel_t* badpixel, float* pixels, size_t stride);
+
+// Same as seeknode_badpixel_apply for a frame covering a window of the sensor (see seekcamera_set_thermography_window).
+// Pixels points at the window origin; neighbours outside the window are left out of the median.
+void seeknode_badpixel_apply_window(const seeknode_badpixel_t* badpixel, float* pixels, size_t stride, size_t x0, size_t y0, size_t width, size_t height);
+
+// Recomputes the thermography min/max (and spot value) of a frame header from the pixels.
+// Pixels may cover a window of the sensor with its origin at (x0, y0); the header keeps sensor coordinates, and the
+// spot value is left as is when the spot falls outside the window.
+void seeknode_badpixel_update_header(seekcamera_frame_header_t* header, const float* pixels, size_t stride, size_t x0, size_t y0, size_t width, size_t height);
+
+// Loads a map saved with seeknode_badpixel_save.
+// Fails if the file is missing, invalid or was saved for another frame geometry.
+bool seeknode_badpixel_load(seeknode_badpixel_t* badpixel, const char* path);
+
+// Saves the map.
+bool seeknode_badpixel_save(const seeknode_badpixel_t* badpixel, const char* path);
+
+#endif /* __SEEKNODE_BADPIXEL_H__ */
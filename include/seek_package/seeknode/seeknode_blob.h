@@ -0,0 +1,112 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_BLOB_H__
+#define __SEEKNODE_BLOB_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Connected region of pixels above the detection threshold.
+typedef struct seeknode_blob_t
+{
+	uint32_t area;
+	float centroid_x;
+	float centroid_y;
+	uint16_t bbox_x;
+	uint16_t bbox_y;
+	uint16_t bbox_width;
+	uint16_t bbox_height;
+	uint16_t peak_x;
+	uint16_t peak_y;
+	float peak_value;
+	float mean_value;
+} seeknode_blob_t;
+
+// Horizontal run of above-threshold pixels [x0, x1) on row y.
+typedef struct seeknode_blob_run_t
+{
+	uint16_t y;
+	uint16_t x0;
+	uint16_t x1;
+} seeknode_blob_run_t;
+
+// Per blob accumulator used while labeling.
+typedef struct seeknode_blob_accumulator_t
+{
+	uint32_t area;
+	double sum_x;
+	double sum_y;
+	double sum_value;
+	uint16_t min_x;
+	uint16_t min_y;
+	uint16_t max_x;
+	uint16_t max_y;
+	uint16_t peak_x;
+	uint16_t peak_y;
+	float peak_value;
+} seeknode_blob_accumulator_t;
+
+// Detects hot spots with run-length connected-components labeling.
+// The frame is thresholded four pixels at a time into a packed bitmask, runs are extracted from the mask words,
+// and runs that touch on consecutive rows are merged with union-find. Statistics are accumulated per run,
+// so only above-threshold pixels are ever revisited.
+typedef struct seeknode_blob_detector_t
+{
+	// Options
+	float threshold;          // Pixels strictly above this temperature are foreground
+	uint32_t min_area;        // Smaller blobs are discarded
+	size_t max_blobs;         // Only the hottest blobs are kept
+	bool connectivity_8;      // Diagonal neighbours are connected when true
+
+	// Results of the last frame, sorted by decreasing peak value.
+	std::vector<seeknode_blob_t> blobs;
+
+	// Frame geometry the buffers are sized for.
+	size_t width;
+	size_t height;
+
+	// Working buffers (preallocated on configure).
+	std::vector<uint64_t> mask;
+	size_t mask_words_per_row;
+	std::vector<seeknode_blob_run_t> runs;
+	std::vector<size_t> row_start;
+	std::vector<uint32_t> parent;
+	std::vector<int32_t> blob_index;
+	std::vector<seeknode_blob_accumulator_t> accumulators;
+} seeknode_blob_detector_t;
+
+// Initializes the detector with the default options.
+void seeknode_blob_detector_init(seeknode_blob_detector_t* detector);
+
+// Allocates the working buffers for a frame geometry.
+// It is a no-op when the geometry did not change.
+void seeknode_blob_detector_configure(seeknode_blob_detector_t* detector, size_t width, size_t height);
+
+// Detects the blobs of a thermography frame.
+// The stride is expressed in bytes to accommodate SDK line padding.
+void seeknode_blob_detector_process(seeknode_blob_detector_t* detector, const float* pixels, size_t stride);
+
+#endif /* __SEEKNODE_BLOB_H__ */
@@ -0,0 +1,106 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_CLOCK_H__
+#define __SEEKNODE_CLOCK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Estimates the relation between the camera clock (timestamp_utc_ns in the frame header) and the host monotonic clock.
+// The model is host = host_ref + (camera - camera_ref) * (1 + drift) + offset.
+// It is fitted online from frame arrival times with a weighted recursive least squares filter.
+// Arrival delays (transport, scheduling, callback) only ever make a frame late, so the filter follows their mean. The
+// offset is then moved down to the lower envelope of the arrivals: the smallest residual seen over the last one to
+// two envelope windows. Mapped times are therefore late by the minimum arrival delay only, not by the mean one.
+// Late arrivals are also down weighted with a one-sided Huber weight; early ones are always trusted.
+typedef struct seeknode_clock_t
+{
+	// Options
+	double forgetting_factor;      // Recursive least squares forgetting factor in (0, 1]
+	double outlier_threshold;      // Residual magnitude, in units of jitter, above which samples are down weighted
+	double reset_threshold_s;      // Residual magnitude, in seconds, considered to be a clock jump
+	size_t reset_count;            // Number of consecutive clock jumps required to reset the estimator
+	size_t warmup_samples;         // Number of samples required before the estimate is used
+	int64_t envelope_window_ns;    // Duration over which the minimum residual is taken
+	int64_t latency_ns;            // Residual constant: minimum capture-to-arrival latency, which no fit can observe
+
+	// Reference points
+	bool has_reference;
+	uint64_t camera_ref_ns;
+	int64_t host_ref_ns;
+
+	// Filter state
+	double offset_s;               // Offset between the clocks at the reference point
+	double drift;                  // Relative rate difference between the clocks (host / camera - 1)
+	double covariance[2][2];       // Parameter covariance
+	double jitter_s;               // Robust estimate of the arrival time jitter
+
+	// Lower envelope, as minimum residuals of the current and the previous window
+	int64_t envelope_start_ns;
+	double envelope_min_s;
+	double previous_min_s;
+	double envelope_s;             // Offset correction (<= 0) from the fitted mean to the earliest arrivals
+
+	// Statistics
+	size_t num_samples;
+	size_t num_outliers;
+	size_t num_jumps;
+	size_t num_resets;
+} seeknode_clock_t;
+
+// Initializes the estimator with the default options.
+void seeknode_clock_init(seeknode_clock_t* clock);
+
+// Discards the estimate but keeps the options.
+// Should be called whenever the camera clock may have been reset (e.g. on reconnect).
+void seeknode_clock_reset(seeknode_clock_t* clock);
+
+// Feeds the estimator with a camera timestamp and the host monotonic time at which it arrived.
+void seeknode_clock_update(seeknode_clock_t* clock, uint64_t camera_ns, int64_t host_ns);
+
+// Returns true once the estimator has seen enough samples to be trusted.
+bool seeknode_clock_is_locked(const seeknode_clock_t* clock);
+
+// Maps a camera timestamp to the host monotonic clock.
+int64_t seeknode_clock_to_host_ns(const seeknode_clock_t* clock, uint64_t camera_ns);
+
+// Gets the estimated drift in parts per million.
+double seeknode_clock_get_drift_ppm(const seeknode_clock_t* clock);
+
+// Gets the estimated arrival jitter in nanoseconds.
+int64_t seeknode_clock_get_jitter_ns(const seeknode_clock_t* clock);
+
+// Gets the mean arrival delay above the minimum one in nanoseconds, i.e. what the lower envelope removes.
+int64_t seeknode_clock_get_excess_delay_ns(const seeknode_clock_t* clock);
+
+// Gets the current value of the host monotonic clock (CLOCK_MONOTONIC).
+int64_t seeknode_clock_monotonic_ns();
+
+// Gets the current value of the host wall clock (CLOCK_REALTIME), comparable across synchronized hosts.
+int64_t seeknode_clock_realtime_ns();
+
+// Gets the CPU time consumed by the calling thread (CLOCK_THREAD_CPUTIME_ID).
+int64_t seeknode_clock_thread_cpu_ns();
+
+#endif /* __SEEKNODE_CLOCK_H__ */
@@ -0,0 +1,75 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_COMPOSITE_H__
+#define __SEEKNODE_COMPOSITE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Layout of a grid of camera tiles in a single mono8 image.
+// The image itself is owned by the caller (typically the message that gets published) so tiles are written in place.
+// Frames whose size differs from the tile size are scaled with nearest neighbour sampling.
+typedef struct seeknode_composite_t
+{
+	// Grid geometry.
+	size_t tiles;
+	size_t columns;
+	size_t rows;
+	size_t tile_width;
+	size_t tile_height;
+
+	// Composite image geometry.
+	size_t width;
+	size_t height;
+
+	// One row of scaled thermography per tile so different tiles can be written concurrently.
+	std::vector<float> scratch;
+} seeknode_composite_t;
+
+// Initializes an empty layout.
+void seeknode_composite_init(seeknode_composite_t* composite);
+
+// Sets the grid geometry; columns of 0 picks a near square grid.
+void seeknode_composite_configure(seeknode_composite_t* composite, size_t tiles, size_t columns, size_t tile_width, size_t tile_height);
+
+// Fills a tile with black.
+void seeknode_composite_clear_tile(const seeknode_composite_t* composite, uint8_t* image, size_t step, size_t tile);
+
+// Writes a thermography frame into a tile, mapping [min_value, max_value] to [0, 255].
+// The frame stride is expressed in bytes to accommodate SDK line padding.
+void seeknode_composite_write_tile(
+	seeknode_composite_t* composite,
+	uint8_t* image,
+	size_t step,
+	size_t tile,
+	const float* pixels,
+	size_t width,
+	size_t height,
+	size_t stride,
+	float min_value,
+	float max_value);
+
+#endif /* __SEEKNODE_COMPOSITE_H__ */
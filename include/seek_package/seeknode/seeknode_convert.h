@@ -0,0 +1,74 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_CONVERT_H__
+#define __SEEKNODE_CONVERT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "seekcamera/seekcamera_frame.h"
+
+// Enumerated type representing an image encoding frames are converted to (sensor_msgs/image_encodings names).
+typedef enum seeknode_encoding_t
+{
+	SEEKNODE_ENCODING_32FC1 = 0,     // float degrees Celsius
+	SEEKNODE_ENCODING_MONO8,         // Grey scaled between a min and max value
+	SEEKNODE_ENCODING_MONO16,        // Raw 16-bit samples
+	SEEKNODE_ENCODING_BGR8,
+	SEEKNODE_ENCODING_BGRA8,
+	SEEKNODE_ENCODING_RGB8,
+	SEEKNODE_ENCODING_YUV422,        // UYVY
+	SEEKNODE_ENCODING_COUNT,
+} seeknode_encoding_t;
+
+// Converts a frame of width x height pixels; rows are src_stride and dst_stride bytes apart.
+// min_value and max_value are the range of scaled encodings (mono8) and are ignored otherwise.
+typedef void (*seeknode_convert_frame_fn)(const void* src, size_t src_stride, void* dst, size_t dst_stride, size_t width, size_t height, float min_value, float max_value);
+
+// Conversion of a camera frame format to an image encoding.
+//
+// Every supported (format, encoding) pair has a kernel specialized at compile time, with the pixel layouts of both
+// sides fixed and the row loop inlined. A consumer looks its pair up once per capture session and then calls convert
+// for every frame, without branching on the format, channels, depth or padding of the frames again.
+typedef struct seeknode_converter_t
+{
+	seekcamera_frame_format_t format;
+	seeknode_encoding_t encoding;
+	size_t src_pixel_size;           // Bytes
+	size_t dst_pixel_size;           // Bytes
+	seeknode_convert_frame_fn convert;
+} seeknode_converter_t;
+
+// Maps thermography to 8-bit grey: 0 at min_value and 255 at max_value.
+// Values outside the range saturate and NaN (e.g. pixels outside a rectified image) maps to 0.
+void seeknode_convert_f32_to_mono8(const float* src, uint8_t* dst, size_t count, float min_value, float max_value);
+
+// Gets the sensor_msgs name of an encoding.
+const char* seeknode_encoding_get_str(seeknode_encoding_t encoding);
+
+// Gets the converter of a frame format to an encoding.
+// Returns NULL if the pair is not supported.
+const seeknode_converter_t* seeknode_converter_find(seekcamera_frame_format_t format, seeknode_encoding_t encoding);
+
+#endif /* __SEEKNODE_CONVERT_H__ */
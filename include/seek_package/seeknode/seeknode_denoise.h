@@ -0,0 +1,79 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_DENOISE_H__
+#define __SEEKNODE_DENOISE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Enumerated type representing the temporal filters.
+typedef enum seeknode_denoise_mode_t
+{
+	SEEKNODE_DENOISE_MODE_OFF = 0,
+	SEEKNODE_DENOISE_MODE_EMA,
+	SEEKNODE_DENOISE_MODE_MOTION_ADAPTIVE,
+} seeknode_denoise_mode_t;
+
+// Recursive temporal filter for thermography frames.
+// EMA: every pixel is blended with its filtered history using a constant weight.
+// Motion adaptive: the weight grows with the frame-to-history difference, reaching 1 at motion_threshold,
+// so static areas are smoothed strongly while moving edges follow the input without ghosting.
+// The frame is filtered in place; the only extra memory is the filtered history.
+typedef struct seeknode_denoise_t
+{
+	// Options
+	seeknode_denoise_mode_t mode;
+	float alpha;               // Weight of the new frame in static areas, in (0, 1]
+	float motion_threshold;    // Difference (degrees) treated as motion; should be several times the pixel noise; <= 0 treats every difference as motion
+
+	// Frame geometry the history is sized for.
+	size_t width;
+	size_t height;
+
+	// Filtered history.
+	std::vector<float> history;
+	bool has_history;
+} seeknode_denoise_t;
+
+// Initializes the filter with the default options.
+void seeknode_denoise_init(seeknode_denoise_t* denoise);
+
+// Gets the mode from its name ("off", "ema" or "adaptive").
+bool seeknode_denoise_mode_from_str(const char* str, seeknode_denoise_mode_t* mode);
+
+// Allocates the history for a frame geometry.
+// The history is discarded when the geometry changes. An alpha outside (0, 1] is clamped to 1 above the range and reset
+// to the default below it.
+void seeknode_denoise_configure(seeknode_denoise_t* denoise, size_t width, size_t height);
+
+// Discards the history so the next frame seeds it (e.g. when a window of the same size moves).
+void seeknode_denoise_reset(seeknode_denoise_t* denoise);
+
+// Filters a thermography frame in place.
+// The stride is expressed in bytes to accommodate SDK line padding.
+void seeknode_denoise_process(seeknode_denoise_t* denoise, float* pixels, size_t stride);
+
+#endif /* __SEEKNODE_DENOISE_H__ */
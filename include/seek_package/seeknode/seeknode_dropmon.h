@@ -0,0 +1,99 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_DROPMON_H__
+#define __SEEKNODE_DROPMON_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+// Enumerated type representing where frames are lost on their way out of the driver.
+typedef enum seeknode_drop_stage_t
+{
+	SEEKNODE_DROP_STAGE_SDK = 0,           // Gap in fpa_frame_count: never delivered by the SDK
+	SEEKNODE_DROP_STAGE_RING,              // Replaced in a full frame queue before being consumed
+	SEEKNODE_DROP_STAGE_WRITER,            // Refused by a transport (full socket buffer, oversized frame)
+	SEEKNODE_DROP_STAGE_PUBLISH,           // Delivered by the SDK but not published
+	SEEKNODE_DROP_STAGE_COUNT,
+} seeknode_drop_stage_t;
+
+// Per-camera frame loss and stall monitor.
+//
+// The frame callback feeds every frame's fpa_frame_count and arrival time: gaps in the count (in units of the
+// smallest step seen, as some cores skip FPA frames on purpose) are SDK drops, and the regular arrival intervals give
+// the frame period and its jitter. The other stages report their own losses. Counters are atomic so a watchdog thread
+// can detect stalls (no frame for stall_timeout_ns) and collect pending drops for alerts while frames flow.
+typedef struct seeknode_dropmon_t
+{
+	// Options
+	int64_t stall_timeout_ns;
+	double smoothing;                      // Weight of a new interval in the period and jitter estimates
+
+	// Sequence state (frame callback only).
+	bool has_last;
+	uint32_t last_fpa_frame_count;
+	uint32_t step;                         // Smallest fpa_frame_count increment seen
+	int64_t last_interval_arrival_ns;
+	double period_ns;
+	double variance_ns2;
+	int64_t max_interval_ns;
+	uint64_t num_gaps;
+	uint32_t max_gap;
+	uint64_t num_resyncs;                  // Count jumps backwards or too far ahead (session restarts)
+
+	// Shared with the watchdog.
+	std::atomic<int64_t> last_arrival_ns;
+	std::atomic<uint32_t> last_seen_fpa_frame_count;
+	std::atomic<bool> is_stalled;
+	std::atomic<uint64_t> num_frames;
+	std::atomic<uint64_t> num_stalls;
+	std::atomic<uint64_t> num_dropped[SEEKNODE_DROP_STAGE_COUNT];
+	uint64_t num_alerted[SEEKNODE_DROP_STAGE_COUNT];   // Watchdog only
+} seeknode_dropmon_t;
+
+// Initializes the monitor with the default options.
+void seeknode_dropmon_init(seeknode_dropmon_t* monitor);
+
+// Gets the name of a stage.
+const char* seeknode_drop_stage_get_str(seeknode_drop_stage_t stage);
+
+// Records a frame delivered by the SDK (arrival on the monotonic clock).
+// Returns the number of frames missing before it; *stall_ns is set to the stall it ends, or 0.
+uint32_t seeknode_dropmon_frame(seeknode_dropmon_t* monitor, uint32_t fpa_frame_count, int64_t arrival_ns, int64_t* stall_ns);
+
+// Records frames lost at a stage; safe from any thread.
+void seeknode_dropmon_add_drops(seeknode_dropmon_t* monitor, seeknode_drop_stage_t stage, uint64_t count);
+
+// Checks for a stall; returns its duration so far the first time it is seen, 0 otherwise.
+// Only frames after the first one are watched, so a camera that never streamed is not reported.
+int64_t seeknode_dropmon_check_stall(seeknode_dropmon_t* monitor, int64_t now_ns);
+
+// Gets the frames lost at a stage since the last call (watchdog thread only).
+uint64_t seeknode_dropmon_take_drops(seeknode_dropmon_t* monitor, seeknode_drop_stage_t stage);
+
+// Gets the standard deviation of the regular arrival intervals.
+double seeknode_dropmon_get_jitter_ns(const seeknode_dropmon_t* monitor);
+
+#endif /* __SEEKNODE_DROPMON_H__ */
@@ -0,0 +1,141 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_FRAMERING_H__
+#define __SEEKNODE_FRAMERING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "seekcamera/seekcamera.h"
+#include "seeknode/seeknode_convert.h"
+
+// Slot of a frame ring: one frame, its header and the camera it came from.
+typedef struct seeknode_frame_slot_t
+{
+	std::atomic<uint32_t> refcount;        // References held by the writer, the ready queue and the readers
+	uint64_t sequence;
+	seekcamera_chipid_t chipid;
+	seekcamera_frame_header_t header;      // Copy of the SDK frame header
+	seeknode_encoding_t encoding;          // Pixel format of data
+	size_t width;
+	size_t height;
+	size_t stride;                         // Bytes per row
+	std::vector<uint8_t> data;
+} seeknode_frame_slot_t;
+
+// Hands frames from capture threads to a consumer without copying them again.
+//
+// A writer fills a free slot and publishes it to a bounded queue of ready frames. When the consumer falls behind,
+// the oldest ready frame is dropped rather than blocking the capture thread. The consumer pops frames and may keep
+// referencing slot memory (e.g. through an array view) for as long as it needs; a slot is only reused once its last
+// reference is released. Slot buffers grow to the largest frame seen and are not reallocated afterwards; the ready
+// queue is a fixed circular buffer, so a warmed-up ring never allocates.
+typedef struct seeknode_frame_ring_t
+{
+	// Options
+	size_t depth;                          // Maximum number of ready frames
+
+	std::mutex mutex;
+	std::condition_variable frame_ready;
+	std::vector<std::unique_ptr<seeknode_frame_slot_t> > slots;
+	std::vector<seeknode_frame_slot_t*> ready; // Circular buffer of depth entries, oldest at ready_head
+	size_t ready_head;
+	size_t num_ready;
+	uint64_t sequence;
+	bool is_closed;
+
+	// Statistics.
+	uint64_t num_published;
+	uint64_t num_dropped;                  // Ready frames replaced by newer ones before being read
+	uint64_t num_exhausted;                // Frames lost because every slot was referenced
+} seeknode_frame_ring_t;
+
+// Allocates the slots of a ring.
+// The number of slots bounds the frames referenced at once: the ready queue, the readers and one per writer.
+void seeknode_frame_ring_init(seeknode_frame_ring_t* ring, size_t num_slots, size_t depth);
+
+// Grows the buffer of every free slot to size bytes, so that acquiring a slot for frames up to that size never allocates.
+void seeknode_frame_ring_reserve(seeknode_frame_ring_t* ring, size_t size);
+
+// Gets a free slot with room for size bytes, referenced once by the caller.
+// Returns NULL if every slot is referenced.
+seeknode_frame_slot_t* seeknode_frame_ring_acquire(seeknode_frame_ring_t* ring, size_t size);
+
+// Publishes a filled slot; the caller's reference is handed to the ready queue.
+// Returns the number of frames dropped to make room (or the slot itself once the ring is closed).
+size_t seeknode_frame_ring_publish(seeknode_frame_ring_t* ring, seeknode_frame_slot_t* slot);
+
+// Waits up to timeout_ns for a ready frame; the queue's reference is handed to the caller.
+// Returns NULL on timeout or once the ring is closed.
+seeknode_frame_slot_t* seeknode_frame_ring_pop(seeknode_frame_ring_t* ring, int64_t timeout_ns);
+
+// Adds a reference to a slot.
+void seeknode_frame_ring_retain(seeknode_frame_slot_t* slot);
+
+// Drops a reference to a slot; the slot is free again once none is left.
+void seeknode_frame_ring_release(seeknode_frame_slot_t* slot);
+
+// Shared reference to a ring slot.
+//
+// Copying a handle adds a reference to the slot and destroying one drops it. Any number of consumers, on any threads,
+// can therefore keep the same frame without copying it, and the slot returns to its ring with the last handle. The
+// contents of a published slot are never written again until then.
+//
+// A handle never refers to SDK memory: writers copy (or convert) the SDK frame into the slot in the frame callback,
+// and the SDK releases its buffer when the callback returns. The ring must outlive its handles.
+typedef struct seeknode_frame_handle_t
+{
+	seeknode_frame_slot_t* slot;           // NULL for an empty handle
+
+	seeknode_frame_handle_t();
+	explicit seeknode_frame_handle_t(seeknode_frame_slot_t* slot);   // Takes over a reference the caller holds
+	seeknode_frame_handle_t(const seeknode_frame_handle_t& other);
+	seeknode_frame_handle_t(seeknode_frame_handle_t&& other);
+	seeknode_frame_handle_t& operator=(seeknode_frame_handle_t other);
+	~seeknode_frame_handle_t();
+
+	// Drops the reference, leaving the handle empty.
+	void reset();
+
+	const seeknode_frame_slot_t* operator->() const { return slot; }
+	explicit operator bool() const { return slot != NULL; }
+} seeknode_frame_handle_t;
+
+// Waits up to timeout_ns for a ready frame, like seeknode_frame_ring_pop.
+// Returns an empty handle on timeout or once the ring is closed.
+seeknode_frame_handle_t seeknode_frame_ring_pop_handle(seeknode_frame_ring_t* ring, int64_t timeout_ns);
+
+// Drops the ready frames and wakes up the waiting readers.
+void seeknode_frame_ring_close(seeknode_frame_ring_t* ring);
+
+// Checks whether the ring was closed.
+bool seeknode_frame_ring_is_closed(seeknode_frame_ring_t* ring);
+
+#endif /* __SEEKNODE_FRAMERING_H__ */
@@ -0,0 +1,88 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_GATE_H__
+#define __SEEKNODE_GATE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Decides whether a frame differs enough from the last published one to be worth publishing.
+// The metric is the mean absolute difference over a subsampled grid: every row_step-th row and,
+// within it, every column_step-th block of four pixels. The header extrema are checked as well so
+// a small hot object appearing between grid points is not missed.
+// Unchanged frames are still let through at the heartbeat period so subscribers know the camera is alive.
+typedef struct seeknode_gate_t
+{
+	// Options
+	float threshold;            // Mean absolute difference (degrees) above which a frame is published
+	float extrema_threshold;    // Change of the header min/max (degrees) above which a frame is published (NaN disables it)
+	size_t row_step;            // Sampled row spacing
+	size_t column_step;         // Sampled four pixel block spacing
+	int64_t heartbeat_ns;       // Maximum time between published frames
+
+	// Frame geometry the buffers are sized for.
+	size_t width;
+	size_t height;
+
+	// Sampled grid of the last published frame and of the current frame.
+	// They are swapped when a frame is published, so the current frame is never copied twice.
+	std::vector<float> reference;
+	std::vector<float> candidate;
+	bool has_reference;
+	float reference_min;
+	float reference_max;
+	int64_t last_publish_ns;
+
+	// Statistics
+	float last_metric;
+	uint64_t num_published;
+	uint64_t num_suppressed;
+	uint64_t bytes_published;
+	uint64_t bytes_suppressed;
+} seeknode_gate_t;
+
+// Initializes the gate with the default options.
+void seeknode_gate_init(seeknode_gate_t* gate);
+
+// Allocates the sampled grids for a frame geometry.
+// The reference is discarded when the geometry changes so the next frame is always published.
+void seeknode_gate_configure(seeknode_gate_t* gate, size_t width, size_t height);
+
+// Discards the reference so the next frame is always published (e.g. when a window of the same size moves).
+void seeknode_gate_reset(seeknode_gate_t* gate);
+
+// Evaluates a thermography frame and returns true if it should be published.
+// The stride is expressed in bytes; frame_bytes is the size of the output the decision applies to (for statistics).
+bool seeknode_gate_process(
+	seeknode_gate_t* gate,
+	const float* pixels,
+	size_t stride,
+	float min_value,
+	float max_value,
+	int64_t now_ns,
+	size_t frame_bytes);
+
+#endif /* __SEEKNODE_GATE_H__ */
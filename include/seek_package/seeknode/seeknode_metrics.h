@@ -0,0 +1,117 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_METRICS_H__
+#define __SEEKNODE_METRICS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Number of counter shards; threads beyond it share shards (still correct, only contended).
+#define SEEKNODE_METRICS_SHARDS 16
+
+// Enumerated type representing the kind of a metric, as exported.
+typedef enum seeknode_metric_type_t
+{
+	SEEKNODE_METRIC_COUNTER = 0,           // Only ever increases
+	SEEKNODE_METRIC_GAUGE,                 // Current value
+} seeknode_metric_type_t;
+
+typedef std::vector<std::pair<std::string, std::string> > seeknode_metric_labels_t;
+
+// Counter shard, aligned to a cache line so threads on different shards do not share one.
+typedef struct alignas(64) seeknode_metric_shard_t
+{
+	std::atomic<uint64_t> value;
+} seeknode_metric_shard_t;
+
+// Metric of the registry.
+// Counters are sharded per thread: adding is a relaxed atomic add on the calling thread's shard and reading sums the
+// shards. A counter that mirrors a count kept elsewhere may be stored instead of added to, but not both.
+typedef struct seeknode_metric_t
+{
+	std::string name;
+	std::string help;
+	seeknode_metric_labels_t labels;
+	seeknode_metric_type_t type;
+	double scale;                          // Applied to the counter value on read (e.g. 1e-9 for nanoseconds)
+	seeknode_metric_shard_t shards[SEEKNODE_METRICS_SHARDS];
+	std::atomic<double> gauge;
+
+	// Allocates on a cache line boundary; plain new only guarantees 16 bytes before C++17.
+	static void* operator new(size_t size);
+	static void operator delete(void* pointer);
+} seeknode_metric_t;
+
+// Registry of metrics.
+// Registration takes a lock and returns a handle that stays valid for the registry lifetime; updates through handles
+// are lock-free.
+typedef struct seeknode_metrics_t
+{
+	std::mutex mutex;
+	std::vector<std::unique_ptr<seeknode_metric_t> > metrics;
+} seeknode_metrics_t;
+
+// Value of a metric at read time.
+typedef struct seeknode_metric_sample_t
+{
+	const seeknode_metric_t* metric;
+	double value;
+} seeknode_metric_sample_t;
+
+// Gets the counter with a name and labels, registering it on first use.
+seeknode_metric_t* seeknode_metrics_counter(seeknode_metrics_t* metrics, const std::string& name, const std::string& help, const seeknode_metric_labels_t& labels, double scale = 1.0);
+
+// Gets the gauge with a name and labels, registering it on first use.
+seeknode_metric_t* seeknode_metrics_gauge(seeknode_metrics_t* metrics, const std::string& name, const std::string& help, const seeknode_metric_labels_t& labels);
+
+// Adds to a counter.
+void seeknode_metric_add(seeknode_metric_t* metric, uint64_t value);
+
+// Stores the value of a counter mirroring a count kept elsewhere.
+void seeknode_metric_store(seeknode_metric_t* metric, uint64_t value);
+
+// Sets a gauge.
+void seeknode_metric_set(seeknode_metric_t* metric, double value);
+
+// Reads a metric (scaled counter sum or gauge).
+double seeknode_metric_read(const seeknode_metric_t* metric);
+
+// Gets the label value of a metric, or an empty string.
+std::string seeknode_metric_get_label(const seeknode_metric_t* metric, const std::string& name);
+
+// Reads every metric, in registration order.
+void seeknode_metrics_snapshot(seeknode_metrics_t* metrics, std::vector<seeknode_metric_sample_t>* samples);
+
+// Writes every metric in the Prometheus text format (e.g. for the node_exporter textfile collector).
+// The file is written next to path and renamed over it, so a scrape never sees a partial file.
+bool seeknode_metrics_write_prometheus(seeknode_metrics_t* metrics, const std::string& path);
+
+#endif /* __SEEKNODE_METRICS_H__ */
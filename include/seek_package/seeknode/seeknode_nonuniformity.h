@@ -0,0 +1,74 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_NONUNIFORMITY_H__
+#define __SEEKNODE_NONUNIFORMITY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Estimates the fixed pattern non-uniformity of a core while it looks at a uniform scene.
+//
+// Every frame whose thermography range (from the frame header) is within uniform_range is high-pass filtered
+// (pixel minus the mean of its 4-neighbours) and the residuals are averaged over a number of consecutive frames.
+// Averaging removes the temporal noise and leaves the fixed pattern; its robust spatial spread (MAD) is the estimate.
+// A non-uniform frame restarts the accumulation so scene structure never leaks into the estimate.
+typedef struct seeknode_nonuniformity_t
+{
+	// Options
+	float uniform_range;   // Maximum thermography range (max - min, degrees) of a frame considered uniform
+	size_t frames;         // Number of consecutive uniform frames averaged per estimate
+
+	// Frame geometry.
+	size_t width;
+	size_t height;
+
+	// Sum of the residuals of the current run of uniform frames.
+	std::vector<float> residuals;
+	size_t num_frames;
+
+	// Subsample of the averaged residuals used to compute the median absolute deviation.
+	std::vector<float> scratch;
+
+	// Last estimate (degrees, standard deviation of the fixed pattern); NaN until the first estimate.
+	float estimate;
+} seeknode_nonuniformity_t;
+
+// Initializes the estimator with the default options.
+void seeknode_nonuniformity_init(seeknode_nonuniformity_t* nonuniformity);
+
+// Allocates the residual plane for a frame geometry.
+// The accumulation is discarded when the geometry changes.
+void seeknode_nonuniformity_configure(seeknode_nonuniformity_t* nonuniformity, size_t width, size_t height);
+
+// Restarts the accumulation (e.g. after a flat scene correction).
+void seeknode_nonuniformity_reset(seeknode_nonuniformity_t* nonuniformity);
+
+// Feeds a thermography frame with its header extrema.
+// Returns true when a new estimate is available.
+// The stride is expressed in bytes to accommodate SDK line padding.
+bool seeknode_nonuniformity_process(seeknode_nonuniformity_t* nonuniformity, const float* pixels, size_t stride, float min_value, float max_value);
+
+#endif /* __SEEKNODE_NONUNIFORMITY_H__ */
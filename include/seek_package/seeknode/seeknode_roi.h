@@ -0,0 +1,127 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_ROI_H__
+#define __SEEKNODE_ROI_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+// Horizontal run of pixels [x0, x1) on row y.
+typedef struct seeknode_span_t
+{
+	uint16_t y;
+	uint16_t x0;
+	uint16_t x1;
+} seeknode_span_t;
+
+// Region of interest.
+// Rectangles are evaluated directly from the summed-area tables.
+// Polygons are rasterized once into spans and evaluated span by span.
+typedef struct seeknode_roi_t
+{
+	std::string name;
+	bool is_polygon;
+
+	// Rectangle in image coordinates (clipped to the frame on configure).
+	int x;
+	int y;
+	int w;
+	int h;
+
+	// Polygon vertices (x0, y0, x1, y1, ...) in image coordinates and the spans they cover.
+	std::vector<float> vertices;
+	std::vector<seeknode_span_t> spans;
+
+	// Temperature threshold used for the area above threshold (NaN disables it).
+	float threshold;
+	int threshold_index;
+} seeknode_roi_t;
+
+// Statistics of a region of interest for a single frame.
+typedef struct seeknode_roi_stats_t
+{
+	float mean;
+	float stddev;
+	float min;
+	float max;
+	uint32_t area;
+	uint32_t area_above;
+} seeknode_roi_stats_t;
+
+// Computes region statistics from summed-area tables.
+// The tables are (width + 1) x (height + 1) with a zero first row and column so that any rectangle sum is four lookups.
+// Sums are accumulated in double precision; single precision loses whole degrees on the squared table.
+typedef struct seeknode_roi_engine_t
+{
+	// Options
+	bool compute_extrema;      // Scan the regions for min/max (the only statistic that is not O(1) per rectangle)
+
+	// Regions and results (same order)
+	std::vector<seeknode_roi_t> rois;
+	std::vector<seeknode_roi_stats_t> stats;
+
+	// Frame geometry the tables are sized for, and its position on the sensor (regions are in sensor coordinates).
+	size_t origin_x;
+	size_t origin_y;
+	size_t width;
+	size_t height;
+
+	// Summed-area tables.
+	std::vector<double> sum;
+	std::vector<double> sum_sq;
+
+	// Distinct thresholds and one count table per threshold.
+	std::vector<float> thresholds;
+	std::vector<uint32_t> counts;
+
+	// Scratch row used while building the tables.
+	std::vector<double> row_sum;
+	std::vector<double> row_sum_sq;
+} seeknode_roi_engine_t;
+
+// Initializes an empty engine.
+void seeknode_roi_engine_init(seeknode_roi_engine_t* engine);
+
+// Adds a rectangular region.
+void seeknode_roi_engine_add_rect(seeknode_roi_engine_t* engine, const std::string& name, int x, int y, int w, int h, float threshold);
+
+// Adds a polygonal region given as interleaved vertex coordinates (x0, y0, x1, y1, ...).
+void seeknode_roi_engine_add_polygon(seeknode_roi_engine_t* engine, const std::string& name, const std::vector<float>& vertices, float threshold);
+
+// Allocates the tables and rasterizes the regions for a frame geometry.
+// Must be called before processing and whenever the frame size changes; it is a no-op otherwise.
+void seeknode_roi_engine_configure(seeknode_roi_engine_t* engine, size_t width, size_t height);
+
+// Same as seeknode_roi_engine_configure for frames covering a window of the sensor (see seekcamera_set_thermography_window).
+// Regions are translated by the window origin; their statistics only cover the part inside the window.
+void seeknode_roi_engine_configure_window(seeknode_roi_engine_t* engine, size_t origin_x, size_t origin_y, size_t width, size_t height);
+
+// Builds the tables for a thermography frame and evaluates every region.
+// The stride is expressed in bytes to accommodate SDK line padding.
+void seeknode_roi_engine_process(seeknode_roi_engine_t* engine, const float* pixels, size_t stride);
+
+#endif /* __SEEKNODE_ROI_H__ */
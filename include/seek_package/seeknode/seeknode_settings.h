@@ -0,0 +1,72 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_SETTINGS_H__
+#define __SEEKNODE_SETTINGS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "seekcamera/seekcamera.h"
+
+// Enumerated type representing a camera setting (used as a bit mask).
+typedef enum seeknode_setting_t
+{
+	SEEKNODE_SETTING_SHUTTER_MODE = 1 << 0,
+	SEEKNODE_SETTING_SCENE_EMISSIVITY = 1 << 1,
+	SEEKNODE_SETTING_THERMOGRAPHY_OFFSET = 1 << 2,
+	SEEKNODE_SETTING_GRADIENT_CORRECTION = 1 << 3,
+	SEEKNODE_SETTING_FLAT_SCENE_CORRECTION = 1 << 4,
+	SEEKNODE_SETTING_ALL = (1 << 5) - 1,
+} seeknode_setting_t;
+
+// Camera settings that do not survive a capture session restart.
+// Kept as plain values so a configuration can be cached, compared against the core defaults and reapplied
+// without querying the camera.
+typedef struct seeknode_settings_t
+{
+	seekcamera_shutter_mode_t shutter_mode;
+	float scene_emissivity;
+	float thermography_offset;
+	seekcamera_filter_state_t gradient_correction;
+	seekcamera_filter_state_t flat_scene_correction;
+} seeknode_settings_t;
+
+// Initializes the settings with nominal defaults, kept for any setting a core fails to report.
+void seeknode_settings_init(seeknode_settings_t* settings);
+
+// Reads the settings of a camera; the capture session must be running.
+// Returns the mask of the settings that could not be read (they keep their value).
+uint32_t seeknode_settings_read(seekcamera_t* camera, seeknode_settings_t* settings);
+
+// Returns the mask of the settings that differ between two configurations.
+uint32_t seeknode_settings_diff(const seeknode_settings_t* a, const seeknode_settings_t* b);
+
+// Applies the masked settings to a camera.
+// Returns the mask of the settings that failed to apply.
+uint32_t seeknode_settings_apply(seekcamera_t* camera, const seeknode_settings_t* settings, uint32_t mask);
+
+// Returns the number of settings in a mask.
+size_t seeknode_settings_count(uint32_t mask);
+
+#endif /* __SEEKNODE_SETTINGS_H__ */
@@ -0,0 +1,168 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_SHM_H__
+#define __SEEKNODE_SHM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+#include "seekcamera/seekcamera.h"
+
+// Version of the shared memory layout; readers refuse any other.
+#define SEEKNODE_SHM_VERSION 1
+
+// Enumerated type representing the pixel format of a shared memory frame.
+typedef enum seeknode_shm_format_t
+{
+	SEEKNODE_SHM_FORMAT_THERMOGRAPHY_FLOAT = 0,    // float degrees Celsius
+} seeknode_shm_format_t;
+
+// Slot of the shared memory ring, followed by the pixel data (at data_offset from the slot).
+// The sequence is a seqlock: 2n + 1 while frame n is being written and 2n + 2 once it is complete.
+typedef struct seeknode_shm_slot_t
+{
+	std::atomic<uint64_t> sequence;
+	uint64_t frame_index;
+	int64_t stamp_ns;                      // Corrected host stamp (ROS time)
+	uint32_t format;                       // seeknode_shm_format_t
+	uint32_t width;
+	uint32_t height;
+	uint32_t stride;                       // Bytes per row; rows are packed
+	uint32_t origin_x;                     // Window origin on the sensor
+	uint32_t origin_y;
+	seekcamera_frame_header_t header;
+} seeknode_shm_slot_t;
+
+// Header of the shared memory segment.
+typedef struct seeknode_shm_header_t
+{
+	std::atomic<uint32_t> magic;           // Written last by the writer
+	uint32_t version;
+	uint32_t num_slots;
+	uint32_t slot_size;                    // Bytes from one slot to the next
+	uint32_t data_offset;                  // Bytes from a slot to its pixel data
+	uint32_t max_data_size;
+	uint32_t writer_pid;
+	seekcamera_chipid_t chipid;
+	alignas(64) std::atomic<uint64_t> published;   // Number of frames written
+	std::atomic<uint32_t> notify;          // Futex word; bumped on every publish
+	std::atomic<uint32_t> is_closed;
+} seeknode_shm_header_t;
+
+// Writer side of a named shared memory frame ring (one writer per segment).
+//
+// Frames are written into fixed slots in turn without ever waiting on readers: a reader that falls more than
+// num_slots frames behind loses frames and a slot overwritten while being read is detected by its seqlock.
+// Every publish wakes the readers sleeping on the futex word.
+typedef struct seeknode_shm_writer_t
+{
+	std::string name;
+	int fd;
+	uint8_t* base;
+	size_t size;
+	seeknode_shm_header_t* header;
+	uint64_t next_index;
+} seeknode_shm_writer_t;
+
+// Reader side of a shared memory frame ring, mapped read-only.
+typedef struct seeknode_shm_reader_t
+{
+	int fd;
+	const uint8_t* base;
+	size_t size;
+	const seeknode_shm_header_t* header;
+	uint64_t next_index;
+
+	// Statistics.
+	uint64_t num_read;
+	uint64_t num_lost;                     // Frames overwritten before being read
+	uint64_t num_torn;                     // Views overwritten while in use
+	uint64_t lag;                          // Frames published but not read yet, after the last read
+	uint64_t max_lag;
+} seeknode_shm_reader_t;
+
+// Zero-copy view of a frame in a reader's mapping.
+// Valid until the writer laps the ring; check with seeknode_shm_reader_validate once done with it.
+typedef struct seeknode_shm_view_t
+{
+	const seeknode_shm_slot_t* slot;
+	const void* data;
+	uint64_t sequence;
+} seeknode_shm_view_t;
+
+// Enumerated type representing the result of a read.
+typedef enum seeknode_shm_read_result_t
+{
+	SEEKNODE_SHM_READ_OK = 0,
+	SEEKNODE_SHM_READ_TIMEOUT,
+	SEEKNODE_SHM_READ_CLOSED,              // The writer closed or died; reopen the segment
+} seeknode_shm_read_result_t;
+
+// Initializes a closed writer.
+void seeknode_shm_writer_init(seeknode_shm_writer_t* writer);
+
+// Creates (or replaces) the segment, e.g. "/seeknode_<chipid>", with room for frames of max_data_size bytes.
+bool seeknode_shm_writer_open(seeknode_shm_writer_t* writer, const std::string& name, const char* chipid, size_t num_slots, size_t max_data_size);
+
+// Checks whether the segment is open.
+bool seeknode_shm_writer_is_open(const seeknode_shm_writer_t* writer);
+
+// Copies a frame into the next slot and wakes the readers; rows are packed on the way.
+// Returns false if the frame does not fit in a slot.
+bool seeknode_shm_writer_publish(
+	seeknode_shm_writer_t* writer,
+	const seekcamera_frame_header_t* header,
+	int64_t stamp_ns,
+	seeknode_shm_format_t format,
+	const void* pixels,
+	size_t stride,
+	size_t width,
+	size_t height,
+	size_t pixel_size,
+	size_t origin_x,
+	size_t origin_y);
+
+// Marks the segment closed for the readers and removes its name.
+void seeknode_shm_writer_close(seeknode_shm_writer_t* writer);
+
+// Initializes a closed reader.
+void seeknode_shm_reader_init(seeknode_shm_reader_t* reader);
+
+// Maps an existing segment; reading starts at the next frame published.
+bool seeknode_shm_reader_open(seeknode_shm_reader_t* reader, const std::string& name);
+
+// Gets the oldest unread frame, waiting up to timeout_ns for one.
+// A reader that was lapped skips to the newest frame and counts the ones in between as lost.
+seeknode_shm_read_result_t seeknode_shm_reader_next(seeknode_shm_reader_t* reader, seeknode_shm_view_t* view, int64_t timeout_ns);
+
+// Checks that a view was not overwritten while it was used; data read through a failed view must be discarded.
+bool seeknode_shm_reader_validate(seeknode_shm_reader_t* reader, const seeknode_shm_view_t* view);
+
+// Unmaps the segment.
+void seeknode_shm_reader_close(seeknode_shm_reader_t* reader);
+
+#endif /* __SEEKNODE_SHM_H__ */
@@ -0,0 +1,89 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_SHUTTER_H__
+#define __SEEKNODE_SHUTTER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Enumerated type representing why a shutter was scheduled.
+typedef enum seeknode_shutter_reason_t
+{
+	SEEKNODE_SHUTTER_REASON_NONE = 0,
+	SEEKNODE_SHUTTER_REASON_INTERVAL,      // Maximum interval elapsed
+	SEEKNODE_SHUTTER_REASON_TEMPERATURE,   // Environment temperature drifted
+	SEEKNODE_SHUTTER_REASON_DIODE,         // FPA diode count drifted
+	SEEKNODE_SHUTTER_REASON_DEADLINE,      // Hard interval elapsed while busy
+} seeknode_shutter_reason_t;
+
+// Shutter (flat field correction) scheduling policy for cameras in manual shutter mode, and frame gap monitor.
+//
+// A shutter is due when the maximum interval elapsed or the FPA drifted since the last one. A due shutter waits
+// for a moment the platform is not busy, but never longer than the hard interval. Shutters closer together than
+// the minimum interval are never scheduled.
+//
+// Every frame arrival also feeds a gap monitor: an interval longer than gap_factor nominal frame periods is a
+// blackout (shutter or dropout). Blackouts shortly after a scheduled shutter are counted as scheduled.
+typedef struct seeknode_shutter_t
+{
+	// Options
+	int64_t min_interval_ns;
+	int64_t max_interval_ns;
+	int64_t hard_interval_ns;
+	float temperature_drift;    // Degrees; 0 disables
+	uint32_t diode_drift;       // Counts; 0 disables
+	float gap_factor;
+
+	// Scheduling state.
+	bool has_reference;
+	int64_t last_shutter_ns;
+	float reference_temperature;
+	uint32_t reference_diode;
+	seeknode_shutter_reason_t last_reason;
+
+	// Frame gap monitor.
+	int64_t last_frame_ns;
+	double period_ns;
+	uint64_t num_shutters;
+	uint64_t num_blackouts;
+	uint64_t num_scheduled_blackouts;
+	int64_t total_blackout_ns;
+	int64_t max_blackout_ns;
+} seeknode_shutter_t;
+
+// Initializes the scheduler with the default options.
+void seeknode_shutter_init(seeknode_shutter_t* shutter);
+
+// Gets the name of a shutter reason.
+const char* seeknode_shutter_reason_get_str(seeknode_shutter_reason_t reason);
+
+// Records a frame arrival (monotonic clock) and updates the blackout statistics.
+// Returns the blackout duration if the frame ends one, 0 otherwise.
+int64_t seeknode_shutter_frame(seeknode_shutter_t* shutter, int64_t now_ns);
+
+// Decides whether a shutter should be triggered now.
+// On true, the trigger is assumed to happen and the drift references are reset.
+bool seeknode_shutter_update(seeknode_shutter_t* shutter, int64_t now_ns, float environment_temperature, uint32_t diode_count, bool is_busy);
+
+#endif /* __SEEKNODE_SHUTTER_H__ */
@@ -0,0 +1,85 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_SIMCAM_H__
+#define __SEEKNODE_SIMCAM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "seekcamera/seekcamera.h"
+#include "seekcamera/seekcamera_frame.h"
+
+// Thermography frame of a simulated camera, as the SDK would hand it to the frame callback.
+typedef struct seeknode_simcam_frame_t
+{
+	seekcamera_frame_header_t header;
+	std::vector<float> pixels;
+	size_t stride;                 // Bytes
+	int64_t capture_ns;            // Monotonic clock time the frame was due
+} seeknode_simcam_frame_t;
+
+typedef std::function<void(const seeknode_simcam_frame_t*)> seeknode_simcam_callback_t;
+
+// Simulated camera for testing the frame pipeline without hardware.
+//
+// Each camera delivers frames from a thread of its own, like the SDK frame callback, at a fixed rate on absolute
+// deadlines. The scene is a background with fixed noise and a hot spot moving across it, so change detection, regions,
+// blobs and alarms all have work to do. A callback that overruns makes the camera skip the frames it missed, as a
+// sensor overwriting its buffer would.
+typedef struct seeknode_simcam_t
+{
+	// Options
+	std::string chipid;
+	size_t width;
+	size_t height;
+	double rate;                   // Frames per second
+	float background;              // Degrees
+	float hot_spot;                // Degrees
+	size_t hot_spot_size;          // Pixels
+
+	// Scene, built on start.
+	std::vector<float> noise;
+
+	std::thread thread;
+	std::atomic<bool> is_running;
+	std::atomic<uint64_t> num_frames;
+	std::atomic<uint64_t> num_skipped;
+} seeknode_simcam_t;
+
+// Initializes a camera with the default options (320x240 at 27 Hz).
+void seeknode_simcam_init(seeknode_simcam_t* camera);
+
+// Starts delivering frames to the callback.
+void seeknode_simcam_start(seeknode_simcam_t* camera, seeknode_simcam_callback_t callback);
+
+// Stops the camera; the callback is not called anymore once it returns.
+void seeknode_simcam_stop(seeknode_simcam_t* camera);
+
+#endif /* __SEEKNODE_SIMCAM_H__ */
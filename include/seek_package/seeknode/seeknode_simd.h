@@ -0,0 +1,419 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_SIMD_H__
+#define __SEEKNODE_SIMD_H__
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// Minimal 128-bit vector abstraction used by the frame processing stages.
+// Both supported host architectures have a 128-bit baseline: SSE2 on x86_64 and NEON (AdvSIMD) on aarch64.
+// Other targets fall back to plain scalar code with the same semantics.
+// Defining SEEKNODE_SIMD_DISABLE forces the scalar fallback (useful to compare results and timings).
+#if defined(SEEKNODE_SIMD_DISABLE)
+#	define SEEKNODE_SIMD_SCALAR 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#	define SEEKNODE_SIMD_SSE2 1
+#	include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#	define SEEKNODE_SIMD_NEON 1
+#	include <arm_neon.h>
+#else
+#	define SEEKNODE_SIMD_SCALAR 1
+#endif
+
+// Number of single precision lanes.
+#define SEEKNODE_F32X4_LANES 4
+
+#if defined(SEEKNODE_SIMD_SSE2)
+typedef __m128 seeknode_f32x4_t;
+typedef __m128d seeknode_f64x2_t;
+#elif defined(SEEKNODE_SIMD_NEON)
+typedef float32x4_t seeknode_f32x4_t;
+typedef float64x2_t seeknode_f64x2_t;
+#else
+typedef struct seeknode_f32x4_t
+{
+	float v[4];
+} seeknode_f32x4_t;
+typedef struct seeknode_f64x2_t
+{
+	double v[2];
+} seeknode_f64x2_t;
+#endif
+
+//------------------------------------------------------------------------------
+// Single precision
+//------------------------------------------------------------------------------
+
+// Loads four unaligned values.
+static inline seeknode_f32x4_t seeknode_f32x4_load(const float* p)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_loadu_ps(p);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vld1q_f32(p);
+#else
+	seeknode_f32x4_t r = { { p[0], p[1], p[2], p[3] } };
+	return r;
+#endif
+}
+
+// Stores four unaligned values.
+static inline void seeknode_f32x4_store(float* p, seeknode_f32x4_t a)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	_mm_storeu_ps(p, a);
+#elif defined(SEEKNODE_SIMD_NEON)
+	vst1q_f32(p, a);
+#else
+	p[0] = a.v[0];
+	p[1] = a.v[1];
+	p[2] = a.v[2];
+	p[3] = a.v[3];
+#endif
+}
+
+// Broadcasts a value to all lanes.
+static inline seeknode_f32x4_t seeknode_f32x4_set1(float x)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_set1_ps(x);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vdupq_n_f32(x);
+#else
+	seeknode_f32x4_t r = { { x, x, x, x } };
+	return r;
+#endif
+}
+
+#if defined(SEEKNODE_SIMD_SCALAR)
+#	define SEEKNODE_F32X4_SCALAR_BINARY(name, expr)                                  \
+		static inline seeknode_f32x4_t name(seeknode_f32x4_t a, seeknode_f32x4_t b) \
+		{                                                                            \
+			seeknode_f32x4_t r;                                                      \
+			for(int i = 0; i < 4; ++i)                                               \
+			{                                                                        \
+				const float x = a.v[i];                                              \
+				const float y = b.v[i];                                              \
+				r.v[i] = (expr);                                                     \
+			}                                                                        \
+			return r;                                                                \
+		}
+SEEKNODE_F32X4_SCALAR_BINARY(seeknode_f32x4_add, x + y)
+SEEKNODE_F32X4_SCALAR_BINARY(seeknode_f32x4_sub, x - y)
+SEEKNODE_F32X4_SCALAR_BINARY(seeknode_f32x4_mul, x * y)
+SEEKNODE_F32X4_SCALAR_BINARY(seeknode_f32x4_min, x < y ? x : y)
+SEEKNODE_F32X4_SCALAR_BINARY(seeknode_f32x4_max, x > y ? x : y)
+#	undef SEEKNODE_F32X4_SCALAR_BINARY
+#else
+static inline seeknode_f32x4_t seeknode_f32x4_add(seeknode_f32x4_t a, seeknode_f32x4_t b)
+{
+#	if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_add_ps(a, b);
+#	else
+	return vaddq_f32(a, b);
+#	endif
+}
+
+static inline seeknode_f32x4_t seeknode_f32x4_sub(seeknode_f32x4_t a, seeknode_f32x4_t b)
+{
+#	if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_sub_ps(a, b);
+#	else
+	return vsubq_f32(a, b);
+#	endif
+}
+
+static inline seeknode_f32x4_t seeknode_f32x4_mul(seeknode_f32x4_t a, seeknode_f32x4_t b)
+{
+#	if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_mul_ps(a, b);
+#	else
+	return vmulq_f32(a, b);
+#	endif
+}
+
+static inline seeknode_f32x4_t seeknode_f32x4_min(seeknode_f32x4_t a, seeknode_f32x4_t b)
+{
+#	if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_min_ps(a, b);
+#	else
+	return vminq_f32(a, b);
+#	endif
+}
+
+static inline seeknode_f32x4_t seeknode_f32x4_max(seeknode_f32x4_t a, seeknode_f32x4_t b)
+{
+#	if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_max_ps(a, b);
+#	else
+	return vmaxq_f32(a, b);
+#	endif
+}
+#endif
+
+// Returns a 4-bit mask with bit i set when a[i] > b[i].
+static inline uint32_t seeknode_f32x4_cmpgt_mask(seeknode_f32x4_t a, seeknode_f32x4_t b)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	return (uint32_t)_mm_movemask_ps(_mm_cmpgt_ps(a, b));
+#elif defined(SEEKNODE_SIMD_NEON)
+	static const uint32_t bits[4] = { 1, 2, 4, 8 };
+	return vaddvq_u32(vandq_u32(vcgtq_f32(a, b), vld1q_u32(bits)));
+#else
+	uint32_t mask = 0;
+	for(int i = 0; i < 4; ++i)
+	{
+		mask |= (a.v[i] > b.v[i]) ? (1u << i) : 0u;
+	}
+	return mask;
+#endif
+}
+
+// Returns the smallest lane.
+static inline float seeknode_f32x4_reduce_min(seeknode_f32x4_t a)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	a = _mm_min_ps(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 0, 3, 2)));
+	a = _mm_min_ps(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtss_f32(a);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vminvq_f32(a);
+#else
+	float r = a.v[0];
+	for(int i = 1; i < 4; ++i)
+	{
+		r = a.v[i] < r ? a.v[i] : r;
+	}
+	return r;
+#endif
+}
+
+// Returns the largest lane.
+static inline float seeknode_f32x4_reduce_max(seeknode_f32x4_t a)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	a = _mm_max_ps(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 0, 3, 2)));
+	a = _mm_max_ps(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtss_f32(a);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vmaxvq_f32(a);
+#else
+	float r = a.v[0];
+	for(int i = 1; i < 4; ++i)
+	{
+		r = a.v[i] > r ? a.v[i] : r;
+	}
+	return r;
+#endif
+}
+
+// Returns the absolute value of every lane.
+static inline seeknode_f32x4_t seeknode_f32x4_abs(seeknode_f32x4_t a)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vabsq_f32(a);
+#else
+	for(int i = 0; i < 4; ++i)
+	{
+		a.v[i] = a.v[i] < 0.0f ? -a.v[i] : a.v[i];
+	}
+	return a;
+#endif
+}
+
+// Returns the sum of the lanes.
+static inline float seeknode_f32x4_reduce_add(seeknode_f32x4_t a)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	a = _mm_add_ps(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 0, 3, 2)));
+	a = _mm_add_ps(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtss_f32(a);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vaddvq_f32(a);
+#else
+	return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]);
+#endif
+}
+
+// Computes the inclusive prefix sum across the lanes: [a, a+b, a+b+c, a+b+c+d].
+static inline seeknode_f32x4_t seeknode_f32x4_prefix_sum(seeknode_f32x4_t a)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	a = _mm_add_ps(a, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(a), 4)));
+	a = _mm_add_ps(a, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(a), 8)));
+	return a;
+#elif defined(SEEKNODE_SIMD_NEON)
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	a = vaddq_f32(a, vextq_f32(zero, a, 3));
+	a = vaddq_f32(a, vextq_f32(zero, a, 2));
+	return a;
+#else
+	a.v[1] += a.v[0];
+	a.v[2] += a.v[1];
+	a.v[3] += a.v[2];
+	return a;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Double precision
+//------------------------------------------------------------------------------
+
+// Loads two unaligned values.
+static inline seeknode_f64x2_t seeknode_f64x2_load(const double* p)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_loadu_pd(p);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vld1q_f64(p);
+#else
+	seeknode_f64x2_t r = { { p[0], p[1] } };
+	return r;
+#endif
+}
+
+// Stores two unaligned values.
+static inline void seeknode_f64x2_store(double* p, seeknode_f64x2_t a)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	_mm_storeu_pd(p, a);
+#elif defined(SEEKNODE_SIMD_NEON)
+	vst1q_f64(p, a);
+#else
+	p[0] = a.v[0];
+	p[1] = a.v[1];
+#endif
+}
+
+// Broadcasts a value to both lanes.
+static inline seeknode_f64x2_t seeknode_f64x2_set1(double x)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_set1_pd(x);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vdupq_n_f64(x);
+#else
+	seeknode_f64x2_t r = { { x, x } };
+	return r;
+#endif
+}
+
+static inline seeknode_f64x2_t seeknode_f64x2_add(seeknode_f64x2_t a, seeknode_f64x2_t b)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_add_pd(a, b);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vaddq_f64(a, b);
+#else
+	seeknode_f64x2_t r = { { a.v[0] + b.v[0], a.v[1] + b.v[1] } };
+	return r;
+#endif
+}
+
+static inline seeknode_f64x2_t seeknode_f64x2_sub(seeknode_f64x2_t a, seeknode_f64x2_t b)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_sub_pd(a, b);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vsubq_f64(a, b);
+#else
+	seeknode_f64x2_t r = { { a.v[0] - b.v[0], a.v[1] - b.v[1] } };
+	return r;
+#endif
+}
+
+static inline seeknode_f64x2_t seeknode_f64x2_mul(seeknode_f64x2_t a, seeknode_f64x2_t b)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_mul_pd(a, b);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vmulq_f64(a, b);
+#else
+	seeknode_f64x2_t r = { { a.v[0] * b.v[0], a.v[1] * b.v[1] } };
+	return r;
+#endif
+}
+
+// Widens the two low single precision lanes.
+static inline seeknode_f64x2_t seeknode_f32x4_cvt_low_f64(seeknode_f32x4_t a)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_cvtps_pd(a);
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vcvt_f64_f32(vget_low_f32(a));
+#else
+	seeknode_f64x2_t r = { { a.v[0], a.v[1] } };
+	return r;
+#endif
+}
+
+// Widens the two high single precision lanes.
+static inline seeknode_f64x2_t seeknode_f32x4_cvt_high_f64(seeknode_f32x4_t a)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	return _mm_cvtps_pd(_mm_movehl_ps(a, a));
+#elif defined(SEEKNODE_SIMD_NEON)
+	return vcvt_high_f64_f32(a);
+#else
+	seeknode_f64x2_t r = { { a.v[2], a.v[3] } };
+	return r;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Conversion
+//------------------------------------------------------------------------------
+
+// Rounds four values to the nearest integer, saturates them to [0, 255] and stores them as bytes.
+// NaN lanes are stored as 0.
+static inline void seeknode_f32x4_store_u8(uint8_t* p, seeknode_f32x4_t a)
+{
+#if defined(SEEKNODE_SIMD_SSE2)
+	// Out of range values (+inf included) convert to INT32_MIN, so the range is clamped first.
+	// maxps returns its second operand when either one is NaN, which maps NaN to 0 like the other backends.
+	const __m128 clamped = _mm_min_ps(_mm_max_ps(a, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+	const __m128i i32 = _mm_cvtps_epi32(clamped);
+	const __m128i i16 = _mm_packs_epi32(i32, i32);
+	const int32_t u8 = _mm_cvtsi128_si32(_mm_packus_epi16(i16, i16));
+	memcpy(p, &u8, sizeof(u8));
+#elif defined(SEEKNODE_SIMD_NEON)
+	// NaN converts to 0.
+	const uint16x4_t u16 = vqmovun_s32(vcvtnq_s32_f32(a));
+	const uint32_t u8 = vget_lane_u32(vreinterpret_u32_u8(vqmovn_u16(vcombine_u16(u16, u16))), 0);
+	memcpy(p, &u8, sizeof(u8));
+#else
+	for(int i = 0; i < 4; ++i)
+	{
+		const float v = a.v[i];
+		p[i] = !(v > 0.0f) ? 0 : (v >= 255.0f ? 255 : (uint8_t)lrintf(v));
+	}
+#endif
+}
+
+#endif /* __SEEKNODE_SIMD_H__ */
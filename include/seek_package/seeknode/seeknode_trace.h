@@ -0,0 +1,109 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_TRACE_H__
+#define __SEEKNODE_TRACE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+// Tracing is compiled in unless SEEKNODE_TRACE is defined to 0 (cmake -DSEEKNODE_TRACE=OFF); the macros below then
+// expand to nothing. When compiled in, it is off until enabled at run time and costs a relaxed load per event.
+#ifndef SEEKNODE_TRACE
+#	define SEEKNODE_TRACE 1
+#endif
+
+// Maximum length of the camera recorded with an event (chip ids are shorter).
+#define SEEKNODE_TRACE_CAMERA_LENGTH 16
+
+// Trace event: a span (begin and end) or an instant.
+typedef struct seeknode_trace_event_t
+{
+	const char* name;                          // Static string
+	int64_t start_ns;                          // Monotonic clock
+	int64_t duration_ns;                       // Negative for an instant
+	char camera[SEEKNODE_TRACE_CAMERA_LENGTH]; // Camera of the thread when the event was recorded, may be empty
+} seeknode_trace_event_t;
+
+extern std::atomic<bool> g_seeknode_trace_enabled;
+
+// Starts recording; each thread keeps its last capacity events in a buffer of its own.
+// The buffers of the last threads that exited are kept for a later write as well.
+// Restarting clears the buffers.
+void seeknode_trace_enable(size_t capacity);
+
+// Stops recording; the buffers are kept for a later write.
+void seeknode_trace_disable();
+
+inline bool seeknode_trace_is_enabled()
+{
+	return g_seeknode_trace_enabled.load(std::memory_order_relaxed);
+}
+
+// Sets the camera recorded with the next events of the calling thread.
+void seeknode_trace_set_camera(const char* camera);
+
+// Names the calling thread in the trace.
+void seeknode_trace_set_thread_name(const std::string& name);
+
+// Records a span of the calling thread.
+void seeknode_trace_complete(const char* name, int64_t start_ns, int64_t end_ns);
+
+// Records an instant of the calling thread.
+void seeknode_trace_instant(const char* name);
+
+// Writes the buffered events of every thread as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+// Recording may go on while writing; events overwritten meanwhile are missing from the file.
+bool seeknode_trace_write_json(const std::string& path);
+
+// Span covering the lifetime of the object; not recorded if tracing was off when it started.
+typedef struct seeknode_trace_scope_t
+{
+	const char* name;
+	int64_t start_ns;
+
+	explicit seeknode_trace_scope_t(const char* name);
+	~seeknode_trace_scope_t();
+} seeknode_trace_scope_t;
+
+#define SEEKNODE_TRACE_JOIN_(a, b) a##b
+#define SEEKNODE_TRACE_JOIN(a, b) SEEKNODE_TRACE_JOIN_(a, b)
+
+#if SEEKNODE_TRACE
+#	define SEEKNODE_TRACE_SCOPE(name) seeknode_trace_scope_t SEEKNODE_TRACE_JOIN(trace_scope_, __LINE__)(name)
+#	define SEEKNODE_TRACE_COMPLETE(name, start_ns, end_ns) do { if(seeknode_trace_is_enabled()) seeknode_trace_complete(name, start_ns, end_ns); } while(0)
+#	define SEEKNODE_TRACE_INSTANT(name) do { if(seeknode_trace_is_enabled()) seeknode_trace_instant(name); } while(0)
+#	define SEEKNODE_TRACE_CAMERA(camera) seeknode_trace_set_camera(camera)
+#	define SEEKNODE_TRACE_THREAD_NAME(name) seeknode_trace_set_thread_name(name)
+#else
+#	define SEEKNODE_TRACE_SCOPE(name) do { } while(0)
+#	define SEEKNODE_TRACE_COMPLETE(name, start_ns, end_ns) do { } while(0)
+#	define SEEKNODE_TRACE_INSTANT(name) do { } while(0)
+#	define SEEKNODE_TRACE_CAMERA(camera) do { } while(0)
+#	define SEEKNODE_TRACE_THREAD_NAME(name) do { } while(0)
+#endif
+
+#endif /* __SEEKNODE_TRACE_H__ */
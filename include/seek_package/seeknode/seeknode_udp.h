@@ -0,0 +1,212 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_UDP_H__
+#define __SEEKNODE_UDP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <string>
+#include <vector>
+
+// Version of the packet layout; receivers ignore any other.
+#define SEEKNODE_UDP_VERSION 2
+
+// Enumerated type representing the pixel format of a streamed frame.
+typedef enum seeknode_udp_format_t
+{
+	SEEKNODE_UDP_FORMAT_THERMOGRAPHY_FLOAT = 0,    // float degrees Celsius
+	SEEKNODE_UDP_FORMAT_MONO8,                     // 8-bit grey, scaled between the frame min and max
+} seeknode_udp_format_t;
+
+// Enumerated type representing the kind of a packet.
+typedef enum seeknode_udp_packet_type_t
+{
+	SEEKNODE_UDP_PACKET_DATA = 0,          // Fragment of the frame
+	SEEKNODE_UDP_PACKET_PARITY,            // XOR of the data fragments of one FEC group
+} seeknode_udp_packet_type_t;
+
+#pragma pack(push, 1)
+
+// Header carried by every packet, in host (little-endian) byte order.
+// Every packet repeats the frame fields so any fragment can open the frame at the receiver.
+typedef struct seeknode_udp_packet_header_t
+{
+	uint32_t magic;
+	uint8_t version;
+	uint8_t type;                          // seeknode_udp_packet_type_t
+	uint8_t format;                        // seeknode_udp_format_t
+	uint8_t fec_group_size;                // Data fragments per parity packet; 0 without FEC
+	uint32_t session_id;                   // Random, drawn by the sender on every open
+	uint32_t frame_id;                     // Sender frame counter, from 0 in every session
+	uint16_t index;                        // Fragment index, or FEC group index for parity packets
+	uint16_t num_fragments;                // Data fragments in the frame
+	uint16_t fragment_size;                // Payload bytes of every fragment but the last
+	uint16_t width;
+	uint16_t height;
+	uint16_t reserved;
+	uint32_t frame_size;                   // Payload bytes of the whole frame
+	uint32_t fpa_frame_count;
+	uint64_t timestamp_utc_ns;             // Camera timestamp
+	int64_t send_time_ns;                  // Sender wall clock when the frame was sent
+	float min_value;                       // Thermography range of the frame (degrees Celsius)
+	float max_value;
+} seeknode_udp_packet_header_t;
+
+#pragma pack(pop)
+
+// Description of a streamed frame.
+typedef struct seeknode_udp_frame_info_t
+{
+	uint32_t session_id;                   // Assigned by the sender
+	uint32_t frame_id;                     // Assigned by the sender
+	seeknode_udp_format_t format;
+	size_t width;
+	size_t height;
+	uint32_t fpa_frame_count;
+	uint64_t timestamp_utc_ns;
+	int64_t send_time_ns;                  // Assigned by the sender
+	float min_value;
+	float max_value;
+} seeknode_udp_frame_info_t;
+
+// Frame delivered by the receiver.
+typedef struct seeknode_udp_frame_t
+{
+	seeknode_udp_frame_info_t info;
+	std::vector<uint8_t> data;             // Packed rows
+} seeknode_udp_frame_t;
+
+// Sends frames as datagrams of at most fragment_size payload bytes, plus one XOR parity packet per group of
+// fec_group_size fragments when enabled, which lets the receiver rebuild one lost fragment per group.
+// All the packets of a frame are handed to the kernel in one sendmmsg call.
+typedef struct seeknode_udp_sender_t
+{
+	// Options
+	size_t fragment_size;                  // Keep header + fragment under the path MTU (1400 for 1500)
+	size_t fec_group_size;                 // 0 disables FEC
+	double drop_probability;               // Packets discarded on purpose, to exercise the receiver
+
+	int fd;
+	uint32_t session_id;
+	uint32_t next_frame_id;
+	uint32_t random_state;
+	std::vector<seeknode_udp_packet_header_t> headers;
+	std::vector<uint8_t> parity;
+	std::vector<struct iovec> iovecs;      // Kept across frames so a steady stream does not allocate
+	std::vector<struct mmsghdr> messages;
+
+	// Statistics.
+	uint64_t num_frames;
+	uint64_t num_packets;
+	uint64_t num_bytes;
+	uint64_t num_dropped;                  // Packets discarded on purpose
+	uint64_t num_errors;                   // Packets the kernel refused (e.g. full socket buffer)
+} seeknode_udp_sender_t;
+
+// Assembly of one frame in the receiver's jitter buffer.
+typedef struct seeknode_udp_assembly_t
+{
+	bool is_used;
+	bool is_complete;
+	seeknode_udp_packet_header_t header;
+	int64_t first_arrival_ns;
+	size_t num_received;                   // Distinct data fragments received
+	size_t num_rebuilt;                    // Data fragments rebuilt from parity
+	std::vector<uint8_t> has_fragment;
+	std::vector<uint8_t> has_parity;
+	std::vector<uint8_t> data;
+	std::vector<uint8_t> parity;           // One fragment_size buffer per FEC group
+} seeknode_udp_assembly_t;
+
+// Reassembles frames from datagrams.
+//
+// Frames are assembled in a bounded jitter buffer of max_frames slots. A frame is delivered as soon as its
+// fragments are complete (rebuilding single losses per FEC group); frames older than the last delivered one are
+// late and discarded, and incomplete frames are lost once they are older than max_delay_ns or evicted by newer ones.
+// Frame ids are only ordered within a session: a packet of a new session (a restarted or reconnected sender, whose
+// frame ids start from 0 again) resets the jitter buffer, and stray packets of the session it replaced are late.
+typedef struct seeknode_udp_receiver_t
+{
+	// Options
+	size_t max_frames;
+	int64_t max_delay_ns;
+
+	int fd;
+	bool has_session;
+	uint32_t session_id;
+	uint32_t previous_session_id;
+	bool has_delivered;
+	uint32_t last_frame_id;
+	uint64_t num_abandoned;                // Assemblies given up since the last delivery
+	std::vector<seeknode_udp_assembly_t> assemblies;
+	std::vector<uint8_t> buffers;          // recvmmsg batch
+	size_t buffer_size;
+	std::vector<struct iovec> iovecs;      // Allocated on open, like the buffers they point to
+	std::vector<struct mmsghdr> messages;
+
+	// Statistics.
+	uint64_t num_packets;
+	uint64_t num_invalid;                  // Malformed or foreign datagrams
+	uint64_t num_sessions;                 // Sender sessions followed, including the first
+	uint64_t num_frames;                   // Frames delivered
+	uint64_t num_recovered;                // Frames delivered thanks to FEC
+	uint64_t num_lost;                     // Frames skipped, expired or evicted
+	uint64_t num_late;                     // Data packets of frames already delivered or given up
+	uint64_t num_fragments_expected;       // Data fragments of the delivered and lost frames
+	uint64_t num_fragments_received;
+	double total_latency_ms;               // Send to delivery, on the wall clocks of both hosts
+	double max_latency_ms;
+	double total_assembly_ms;              // First fragment to delivery
+} seeknode_udp_receiver_t;
+
+// Initializes a closed sender with the default options.
+void seeknode_udp_sender_init(seeknode_udp_sender_t* sender);
+
+// Opens a socket connected to host:port and starts a new session.
+bool seeknode_udp_sender_open(seeknode_udp_sender_t* sender, const std::string& host, uint16_t port);
+
+// Fragments and sends a frame of size bytes (packed rows); the packets reference the data, no copy is made.
+// Returns false if the frame is too large for the packet fields.
+bool seeknode_udp_sender_send(seeknode_udp_sender_t* sender, const seeknode_udp_frame_info_t* info, const void* data, size_t size);
+
+// Closes the socket.
+void seeknode_udp_sender_close(seeknode_udp_sender_t* sender);
+
+// Initializes a closed receiver with the default options.
+void seeknode_udp_receiver_init(seeknode_udp_receiver_t* receiver);
+
+// Binds a socket on port (all interfaces) and allocates the jitter buffer.
+bool seeknode_udp_receiver_open(seeknode_udp_receiver_t* receiver, uint16_t port);
+
+// Receives datagrams for up to timeout_ns until a frame completes.
+// Returns true with the frame filled in, false on timeout.
+bool seeknode_udp_receiver_receive(seeknode_udp_receiver_t* receiver, seeknode_udp_frame_t* frame, int64_t timeout_ns);
+
+// Closes the socket.
+void seeknode_udp_receiver_close(seeknode_udp_receiver_t* receiver);
+
+#endif /* __SEEKNODE_UDP_H__ */
@@ -0,0 +1,89 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_UNDISTORT_H__
+#define __SEEKNODE_UNDISTORT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Number of sub-pixel positions per axis of the remap table (5 bits of fraction).
+#define SEEKNODE_UNDISTORT_INTER_BITS 5
+#define SEEKNODE_UNDISTORT_INTER_SIZE (1 << SEEKNODE_UNDISTORT_INTER_BITS)
+
+// Pinhole camera with radial-tangential (plumb bob) distortion, as produced by camera_calibration.
+typedef struct seeknode_camera_model_t
+{
+	double fx;
+	double fy;
+	double cx;
+	double cy;
+	double k1;
+	double k2;
+	double p1;
+	double p2;
+	double k3;
+} seeknode_camera_model_t;
+
+// Rectifies frames with a remap table computed once per calibration and frame geometry.
+//
+// Each output pixel stores the integer source coordinates of its top-left neighbour and an index into a small table
+// of bilinear weights quantized to 1/32 pixel, so the frame path is a gather and a weighted sum with no distortion
+// model evaluation. Output pixels that map outside the source frame are NaN.
+typedef struct seeknode_undistort_t
+{
+	// Calibration the table was built for.
+	seeknode_camera_model_t model;
+
+	// Frame geometry (the output has the geometry of the input).
+	size_t width;
+	size_t height;
+
+	// Remap table: source x and y of each output pixel, and its weight index.
+	std::vector<uint16_t> map_xy;
+	std::vector<uint16_t> map_weight;
+
+	// Bilinear weights (w00, w01, w10, w11) for every sub-pixel position, plus one all-zero entry for invalid pixels.
+	std::vector<float> weights_f32;
+
+	// Added to float outputs: 0 for valid pixels and NaN for the invalid entry.
+	std::vector<float> bias_f32;
+} seeknode_undistort_t;
+
+// Initializes an empty rectifier.
+void seeknode_undistort_init(seeknode_undistort_t* undistort);
+
+// Returns true if the camera model holds a usable calibration.
+bool seeknode_undistort_model_is_valid(const seeknode_camera_model_t* model);
+
+// Builds the remap table for a calibration and frame geometry.
+// The table is only rebuilt when either changes.
+void seeknode_undistort_configure(seeknode_undistort_t* undistort, const seeknode_camera_model_t* model, size_t width, size_t height);
+
+// Rectifies a thermography frame.
+// Strides are expressed in bytes to accommodate SDK line padding.
+void seeknode_undistort_remap_f32(const seeknode_undistort_t* undistort, const float* src, size_t src_stride, float* dst, size_t dst_stride);
+
+#endif /* __SEEKNODE_UNDISTORT_H__ */
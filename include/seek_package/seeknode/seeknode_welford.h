@@ -0,0 +1,80 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_WELFORD_H__
+#define __SEEKNODE_WELFORD_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Per-pixel running mean and variance of thermography frames.
+//
+// Frames are first accumulated in float32 as sums of (x - pivot) and (x - pivot)^2, where the pivot is the running
+// mean, for up to batch_frames frames. Each batch is then folded into the float64 count/mean/M2 planes with the
+// parallel form of Welford's update (Chan et al.), so the per-frame cost is three float32 planes rather than
+// double precision division and two float64 planes.
+typedef struct seeknode_welford_t
+{
+	// Options
+	size_t batch_frames;   // Frames accumulated in float32 before they are folded into the float64 planes
+
+	// Frame geometry.
+	size_t width;
+	size_t height;
+
+	// Float64 planes: running mean and sum of squared deviations.
+	uint64_t count;
+	std::vector<double> mean;
+	std::vector<double> m2;
+
+	// Float32 batch planes.
+	size_t batch_count;
+	std::vector<float> pivot;
+	std::vector<float> sum;
+	std::vector<float> sum_squares;
+} seeknode_welford_t;
+
+// Initializes an empty accumulator with the default options.
+void seeknode_welford_init(seeknode_welford_t* welford);
+
+// Allocates the planes for a frame geometry.
+// The statistics are discarded when the geometry changes.
+void seeknode_welford_configure(seeknode_welford_t* welford, size_t width, size_t height);
+
+// Discards the statistics (e.g. at the start of a new window).
+void seeknode_welford_reset(seeknode_welford_t* welford);
+
+// Accumulates a thermography frame.
+// The stride is expressed in bytes to accommodate SDK line padding.
+void seeknode_welford_add(seeknode_welford_t* welford, const float* pixels, size_t stride);
+
+// Returns the number of accumulated frames.
+uint64_t seeknode_welford_get_count(const seeknode_welford_t* welford);
+
+// Writes the per-pixel mean and standard deviation (sample, n - 1) to two planes of width * height values.
+// Pending frames are folded in first.
+void seeknode_welford_snapshot(seeknode_welford_t* welford, float* mean, float* stddev);
+
+#endif /* __SEEKNODE_WELFORD_H__ */
@@ -0,0 +1,86 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_WINDOW_H__
+#define __SEEKNODE_WINDOW_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Controls the thermography window of a camera from the sensor rectangles the frame consumers need.
+//
+// Before every update the consumers add their rectangles; the window is their union grown by a margin, aligned and
+// clipped to the sensor. It is the full sensor when nothing is added or when a consumer needs the whole frame.
+// The window grows (or moves) as soon as a rectangle falls outside of it, but only shrinks once the area saved is
+// worth a reconfiguration, so rectangles jittering by a pixel do not reconfigure the SDK on every frame.
+typedef struct seeknode_window_t
+{
+	// Options
+	int margin;                // Pixels added around the union on every side
+	int alignment;             // Granularity of the window origin and size
+	float shrink_ratio;        // The window only shrinks to an area below this fraction of the current one
+
+	// Sensor geometry.
+	size_t sensor_width;
+	size_t sensor_height;
+
+	// Union of the rectangles added since the last update (empty while right <= left).
+	long left;
+	long top;
+	long right;
+	long bottom;
+	bool is_full_requested;
+
+	// Current window in sensor coordinates.
+	size_t x;
+	size_t y;
+	size_t width;
+	size_t height;
+
+	// Statistics.
+	uint64_t num_changes;
+} seeknode_window_t;
+
+// Initializes a controller with the default options.
+void seeknode_window_init(seeknode_window_t* window);
+
+// Sets the sensor geometry; the window is reset to the full sensor if it changed.
+void seeknode_window_configure(seeknode_window_t* window, size_t sensor_width, size_t sensor_height);
+
+// Starts collecting the rectangles of the next update.
+void seeknode_window_begin(seeknode_window_t* window);
+
+// Adds a rectangle (sensor coordinates) to the union.
+void seeknode_window_add(seeknode_window_t* window, long x, long y, long width, long height);
+
+// Requests the full sensor for the next update.
+void seeknode_window_add_full(seeknode_window_t* window);
+
+// Computes the window from the collected rectangles.
+// Returns true if it changed; the new window must then be applied to the camera.
+bool seeknode_window_update(seeknode_window_t* window);
+
+// Returns true if the window covers the whole sensor.
+bool seeknode_window_is_full(const seeknode_window_t* window);
+
+#endif /* __SEEKNODE_WINDOW_H__ */
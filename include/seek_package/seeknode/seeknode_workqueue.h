@@ -0,0 +1,78 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __SEEKNODE_WORKQUEUE_H__
+#define __SEEKNODE_WORKQUEUE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Task queued on a work queue.
+typedef struct seeknode_work_t
+{
+	const void* key;
+	std::chrono::steady_clock::time_point not_before;
+	std::function<void()> function;
+} seeknode_work_t;
+
+// Runs tasks on a small pool of threads.
+// Tasks sharing a key (e.g. a camera) run one at a time in submission order; tasks with different keys run in
+// parallel. A key can be cancelled and waited for, so a caller can make sure no task of it is pending or running.
+// A task can be delayed; it waits in the queue rather than on a worker, so a cancel drops it without waiting.
+typedef struct seeknode_workqueue_t
+{
+	std::mutex mutex;
+	std::condition_variable work_available;
+	std::condition_variable work_done;
+	std::deque<seeknode_work_t> pending;
+	std::vector<const void*> running;
+	std::vector<std::thread> threads;
+	bool is_stopping;
+} seeknode_workqueue_t;
+
+// Starts the worker threads.
+void seeknode_workqueue_start(seeknode_workqueue_t* queue, size_t num_threads);
+
+// Queues a task.
+void seeknode_workqueue_submit(seeknode_workqueue_t* queue, const void* key, std::function<void()> function);
+
+// Queues a task that does not start before a delay has elapsed.
+// Later tasks of the same key still run after it.
+void seeknode_workqueue_submit_delayed(seeknode_workqueue_t* queue, const void* key, int64_t delay_ms, std::function<void()> function);
+
+// Drops the pending tasks of a key and waits for its running task, if any.
+// Returns the number of tasks dropped.
+size_t seeknode_workqueue_cancel(seeknode_workqueue_t* queue, const void* key);
+
+// Drops the pending tasks, waits for the running ones and stops the worker threads.
+void seeknode_workqueue_stop(seeknode_workqueue_t* queue);
+
+#endif /* __SEEKNODE_WORKQUEUE_H__ */
@@ -22,15 +22,22 @@ import cv2
 from cv_bridge import CvBridge, CvBridgeError
 from sensor_msgs.msg import Image  # Import the ROS Image message type
 
-from seekcamera import (
-    SeekCameraIOType,
-    SeekCameraColorPalette,
-    SeekCameraManager,
-    SeekCameraManagerEvent,
-    SeekCameraFrameFormat,
-    SeekCamera,
-    SeekFrame,
-)
+# The seeknode module (built with this package) captures in native threads and hands
+# frames over without copies; seekcamera-python is the fallback.
+try:
+    import seeknode
+except ImportError:
+    seeknode = None
+
+    from seekcamera import (
+        SeekCameraIOType,
+        SeekCameraColorPalette,
+        SeekCameraManager,
+        SeekCameraManagerEvent,
+        SeekCameraFrameFormat,
+        SeekCamera,
+        SeekFrame,
+    )
 
 
 class Renderer:
@@ -124,11 +131,29 @@ def on_event(camera, event_type, event_status, renderer):
         return
 
 
+def run_native(image_publisher, bridge):
+    """Publishes frames read from the seeknode module."""
+    with seeknode.Capture(format="color_argb8888", color_palette="black_hot") as capture:
+        while not rospy.is_shutdown():
+            # Waits a maximum of 150ms without holding the GIL; frames that arrive
+            # while publishing are kept in the ring instead of being dropped.
+            frame = capture.read(150.0 / 1000.0)
+            if frame is None:
+                continue
+            img = cv2.cvtColor(frame.data, cv2.COLOR_BGRA2BGR)
+            image_msg = bridge.cv2_to_imgmsg(img, encoding="bgr8")
+            image_publisher.publish(image_msg)
+
+
 def main():
     rospy.init_node('thermal_camera_publisher')
     image_publisher = rospy.Publisher('/thermal_camera/image', Image, queue_size=10)
     bridge = CvBridge()
 
+    if seeknode is not None:
+        run_native(image_publisher, bridge)
+        return
+
     # Create a context structure responsible for managing all connected USB cameras.
     # Cameras with other IO types can be managed by using a bitwise or of the
     # SeekCameraIOType enum cases.
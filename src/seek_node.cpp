@@ -30,10 +30,23 @@ SOFTWARE.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include <signal.h>
+#include <errno.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
 #include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #ifdef _WIN32
 #	include <windows.h>
@@ -42,11 +55,47 @@ SOFTWARE.
 
 #if defined(__linux__) || defined(__APPLE__)
 #	include <unistd.h>
+#	include <sys/stat.h>
 #	include <sys/time.h>
 #endif
 
+#include <ros/ros.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/RegionOfInterest.h>
+#include <sensor_msgs/TimeReference.h>
+#include <std_msgs/Bool.h>
+#include <std_srvs/Trigger.h>
+#include <seek_package/AlarmEvent.h>
+#include <seek_package/Blobs.h>
+#include <seek_package/FrameDrop.h>
+#include <seek_package/RoiStats.h>
+
 #include "seekcamera/seekcamera.h"
 #include "seekcamera/seekcamera_manager.h"
+#include "seeknode/seeknode_alarm.h"
+#include "seeknode/seeknode_alloc.h"
+#include "seeknode/seeknode_badpixel.h"
+#include "seeknode/seeknode_blob.h"
+#include "seeknode/seeknode_clock.h"
+#include "seeknode/seeknode_composite.h"
+#include "seeknode/seeknode_convert.h"
+#include "seeknode/seeknode_denoise.h"
+#include "seeknode/seeknode_dropmon.h"
+#include "seeknode/seeknode_framering.h"
+#include "seeknode/seeknode_gate.h"
+#include "seeknode/seeknode_metrics.h"
+#include "seeknode/seeknode_nonuniformity.h"
+#include "seeknode/seeknode_roi.h"
+#include "seeknode/seeknode_settings.h"
+#include "seeknode/seeknode_shm.h"
+#include "seeknode/seeknode_shutter.h"
+#include "seeknode/seeknode_trace.h"
+#include "seeknode/seeknode_udp.h"
+#include "seeknode/seeknode_undistort.h"
+#include "seeknode/seeknode_welford.h"
+#include "seeknode/seeknode_window.h"
+#include "seeknode/seeknode_workqueue.h"
 
 // Options
 #define NUM_MAX_DEVICES 15
@@ -55,18 +104,282 @@ SOFTWARE.
 #define USB 0x01
 #define SPI 0x02
 
+// Structure holding the processing time of a frame stage between two reports.
+typedef struct stage_timing_t
+{
+	const char* name;
+	uint64_t count;
+	int64_t total_ns;
+	int64_t max_ns;
+	seeknode_metric_t* seconds;    // Total, exported
+} stage_timing_t;
+
+// Enumerated type representing how the bad pixel map of a camera is obtained.
+typedef enum bad_pixels_mode_t
+{
+	BAD_PIXELS_MODE_OFF = 0,
+	BAD_PIXELS_MODE_LOAD,      // Use the saved map; frames are left uncorrected without one
+	BAD_PIXELS_MODE_LEARN,     // Use the saved map; learn and save one if there is none
+	BAD_PIXELS_MODE_RELEARN,   // Always learn and save a new map
+} bad_pixels_mode_t;
+
+// Jobs the frame callback hands to the background worker of its context.
+typedef enum worker_job_t
+{
+	WORKER_JOB_EXPORT_STATISTICS = 0x01,   // Write the statistics snapshot to a CSV file
+	WORKER_JOB_STORE_FSC = 0x02,           // Store a flat scene correction
+} worker_job_t;
+
+// Structure holding the exported metrics of a camera.
+// The handles are registered with the camera cache entry, so counters keep increasing across reconnects. The
+// previous values are only used by the metrics timer.
+typedef struct camera_metrics_t
+{
+	seeknode_metric_t* frames;
+	seeknode_metric_t* cpu_seconds;
+	seeknode_metric_t* restarts;
+	seeknode_metric_t* connected;
+	seeknode_metric_t* fps;
+	seeknode_metric_t* jitter;
+	seeknode_metric_t* dropped[SEEKNODE_DROP_STAGE_COUNT];
+	seeknode_metric_t* stalls;
+	seeknode_metric_t* udp_queue_depth;
+	seeknode_metric_t* udp_frames;
+	seeknode_metric_t* udp_bytes;
+	seeknode_metric_t* recorded_frames;
+	seeknode_metric_t* recorded_bytes;
+	uint64_t previous_frames;
+	double previous_dropped;
+	int64_t previous_ns;
+} camera_metrics_t;
+
+// Structure holding what is known about a camera, cached by chip id across session restarts and reconnects.
+// An entry is only accessed by the bring-up task or frame callback of its camera, one at a time, except for the
+// device info, which the metrics timer reads under g_camera_cache_mutex and is therefore written under it, and the
+// metrics (see camera_metrics_t).
+typedef struct camera_cache_t
+{
+	bool has_device_info;
+	seekcamera_serial_number_t serial_number;
+	seekcamera_core_part_number_t core_part_number;
+	seekcamera_firmware_version_t firmware_version;
+	seekcamera_io_type_t io_type;
+	bool has_defaults;
+	seeknode_settings_t defaults;    // As reported by the core on its first capture session
+	seeknode_settings_t applied;     // Configuration the node applies on every capture session
+	bool has_streamed;
+	camera_metrics_t metrics;
+} camera_cache_t;
+
+// Structure holding a crop requested by a subscriber (sensor coordinates) and when it was last received.
+typedef struct crop_request_t
+{
+	int x;
+	int y;
+	int width;                 // A zero width or height requests the full frame
+	int height;
+	int64_t received_ns;
+} crop_request_t;
+
 // Structure holding the context for a Seek camera and additional application level metadata.
 typedef struct samplectx_t
 {
-	bool is_free;
-	bool is_live;
+	bool is_free;                      // Guarded by g_ctx_pool_mutex, as is camera
+	std::atomic<bool> is_live;         // Set once the context is complete; the frame callback drops frames until then
 	FILE* log;
 	seekcamera_t* camera;
+	camera_cache_t* cache;
+	ros::Publisher image_pub;
+	const seeknode_converter_t* image_converter;   // Selected on connect
+	ros::Publisher time_reference_pub;
+	seeknode_clock_t clock;
+	int64_t last_report_ns;
+	seeknode_roi_engine_t roi;
+	ros::Publisher roi_pub;
+	stage_timing_t roi_timing;
+	seeknode_blob_detector_t blobs;
+	ros::Publisher blobs_pub;
+	stage_timing_t blobs_timing;
+	bool is_gated;
+	seeknode_gate_t gate;
+	stage_timing_t gate_timing;
+	seeknode_denoise_t denoise;
+	stage_timing_t denoise_timing;
+	bad_pixels_mode_t bad_pixels_mode;
+	bool is_bad_pixels_configured;
+	seeknode_badpixel_t bad_pixels;
+	stage_timing_t bad_pixels_timing;
+	seeknode_camera_model_t calibration;
+	seeknode_undistort_t undistort;
+	ros::Publisher rect_pub;
+	stage_timing_t rect_timing;
+	uint64_t composite_generation;
+	stage_timing_t composite_timing;
+	seeknode_welford_t statistics;
+	uint64_t statistics_frame_count;
+	uint64_t statistics_window_start_ns;
+	std::atomic<bool> is_statistics_export_requested;
+	std::atomic<bool> is_statistics_exporting;     // The worker owns the snapshot below
+	std::vector<float> statistics_snapshot;        // Mean and standard deviation planes
+	size_t statistics_snapshot_width;
+	size_t statistics_snapshot_height;
+	uint64_t statistics_snapshot_count;
+	uint64_t statistics_snapshot_timestamp_ns;
+	stage_timing_t statistics_timing;
+	seeknode_nonuniformity_t nonuniformity;
+	int64_t connect_ns;
+	int64_t last_fsc_ns;
+	std::atomic<bool> is_fsc_running;
+	// Background worker of the frame callback. It is started with the first connect of the slot and kept until the
+	// node exits, so the frame callback only raises a job and never creates a thread or writes a file.
+	std::thread worker_thread;
+	std::mutex worker_mutex;
+	std::condition_variable worker_cv;
+	uint32_t worker_jobs;              // worker_job_t bits; guarded by worker_mutex, as are the two flags below
+	bool is_worker_busy;
+	bool is_worker_stopping;
+	stage_timing_t nonuniformity_timing;
+	seeknode_alarm_engine_t alarms;
+	ros::Publisher alarms_pub;
+	int64_t record_until_ns;
+	stage_timing_t alarms_timing;
+	bool is_shutter_scheduled;
+	seeknode_shutter_t shutter;
+	bool is_windowed;
+	seeknode_window_t window;
+	seeknode_window_t previous_window;
+	bool is_window_change_pending;     // No frame attributed to the previous window since it changed
+	size_t frame_origin_x;             // Sensor origin of the last processed frame
+	size_t frame_origin_y;
+	std::mutex crop_mutex;
+	std::vector<crop_request_t> crop_requests;
+	ros::Subscriber crop_sub;
+	ros::Publisher window_pub;
+	uint64_t num_frames;
+	int64_t cpu_report_ns;
+	uint64_t cpu_report_frames;
+	int64_t cpu_metrics_ns;
+	std::atomic<int64_t> session_start_ns;
+	bool is_restart;
+	uint64_t num_restarts;
+	int64_t max_first_frame_ns;
+	bool is_shm_enabled;
+	bool is_shm_failed;                // Creating the segment failed; retried on the next connect
+	seeknode_shm_writer_t shm;
+	stage_timing_t shm_timing;
+	bool is_udp_enabled;
+	seeknode_udp_format_t udp_format;
+	const seeknode_converter_t* udp_converter;
+	seeknode_frame_ring_t udp_ring;
+	seeknode_udp_sender_t udp;
+	std::thread udp_thread;
+	stage_timing_t udp_timing;
+	stage_timing_t publish_timing;
+	stage_timing_t record_timing;
+	seeknode_dropmon_t drops;
+	ros::Publisher drops_pub;
+
+	// Messages reused by every frame so their buffers are only allocated while the camera warms up.
+	std_msgs::Header frame_header;
+	sensor_msgs::Image image_message;
+	sensor_msgs::Image rect_message;
+	sensor_msgs::TimeReference time_reference_message;
+	seek_package::RoiStats roi_message;
+	seek_package::Blobs blobs_message;
+	seek_package::AlarmEvent alarm_message;
 } samplectx_t;
 
 // Define the global variables.
 volatile bool g_keep_running = true;
-static samplectx_t g_ctx_pool[NUM_MAX_DEVICES] = { 0 };
+static samplectx_t g_ctx_pool[NUM_MAX_DEVICES];
+static ros::NodeHandle* g_node = NULL;
+static std::string g_frame_id_prefix = "seek_";
+static seeknode_clock_t g_clock_options;
+static seeknode_blob_detector_t g_blob_options;
+static bool g_gate_enabled = false;
+static seeknode_gate_t g_gate_options;
+static double g_report_period = 10.0;
+static std::string g_bad_pixels_directory;
+
+// Monitoring composite shared by every camera; tiles are indexed by context pool slot.
+// Cameras write their tiles into the image under the mutex. The publisher copies it to a second message under the
+// mutex and serializes that copy without holding it, so frame threads never wait on a publish.
+// Each camera writes its tile at most once per published generation; the generation is checked before locking.
+static bool g_composite_enabled = false;
+static seeknode_composite_t g_composite;
+static float g_composite_min = NAN;
+static float g_composite_max = NAN;
+static std::mutex g_composite_mutex;
+static sensor_msgs::Image g_composite_image;
+static sensor_msgs::Image g_composite_message;
+static std::atomic<uint64_t> g_composite_generation(0);
+static ros::Publisher g_composite_pub;
+
+// Per-pixel long-term statistics options.
+static bool g_statistics_enabled = false;
+static int g_statistics_frame_step = 4;
+static int g_statistics_batch_frames = 32;
+static double g_statistics_window = 0.0;
+
+// Automatic flat scene correction options.
+static bool g_fsc_auto = false;
+static double g_fsc_threshold = 0.1;
+static double g_fsc_warmup = 60.0;
+static double g_fsc_min_interval = 3600.0;
+static seeknode_nonuniformity_t g_nonuniformity_options;
+
+// Recording options: every frame is logged, or only while a recording alarm is active (and for a while after).
+static bool g_record_on_alarm = false;
+static double g_record_post_alarm = 5.0;
+
+// Shutter scheduling options and the external busy signal (written by the subscriber, read by the frame callbacks).
+static bool g_shutter_scheduled = false;
+static seeknode_shutter_t g_shutter_options;
+static double g_busy_timeout = 5.0;
+static std::atomic<bool> g_is_busy(false);
+static std::atomic<int64_t> g_busy_ns(0);
+
+// Camera bring-up: connects and errors are handled on a pool of threads (one task per camera at a time) so the
+// cameras of a rack start in parallel instead of one after another on the SDK event thread.
+// The context pool is shared by the bring-up threads; the camera cache entries are never removed.
+static seeknode_workqueue_t g_bringup;
+static std::mutex g_ctx_pool_mutex;
+static std::mutex g_camera_cache_mutex;
+static std::map<std::string, camera_cache_t> g_camera_cache;
+static int64_t g_start_ns = 0;
+static int g_expected_cameras = 0;
+static std::atomic<int> g_num_streaming(0);
+
+// Thermography window options: the window of each camera follows its regions, alarm rules and crop requests.
+static bool g_window_auto = false;
+static seeknode_window_t g_window_options;
+static double g_crop_request_timeout = 5.0;
+
+// Shared memory transport for local consumers that are not ROS nodes.
+static bool g_shm_enabled = false;
+static std::string g_shm_prefix = "/seeknode_";
+static int g_shm_slots = 4;
+
+// UDP streaming for remote operators; camera slot i sends to g_udp_port + i.
+static bool g_udp_enabled = false;
+static std::string g_udp_host = "127.0.0.1";
+static int g_udp_port = 5600;
+static seeknode_udp_format_t g_udp_format = SEEKNODE_UDP_FORMAT_MONO8;
+static seeknode_udp_sender_t g_udp_options;
+static int g_udp_queue_depth = 2;
+
+// Frame loss and stall monitor.
+static double g_drops_stall_timeout = 1.0;
+
+// Metrics exported on /diagnostics and to a Prometheus text file; per camera metrics are labeled by chip id.
+static seeknode_metrics_t g_metrics;
+static ros::Publisher g_diagnostics_pub;
+static std::string g_metrics_textfile;
+
+// Allocation tracking (builds with SEEKNODE_ALLOC_TRACKING): the frame threads of a camera are checked once it has
+// been connected for the warmup.
+static int64_t g_alloc_warmup_ns = 30000000000LL;
+static seeknode_metric_t* g_allocations_metric = NULL;
 
 // Signal handler function.
 static void signal_callback(int signum)
@@ -87,47 +400,1435 @@ void print_usage()
 	fprintf(stdout, "\t   : Required - No\n");
 }
 
+// Resets the timing of a stage, exported as seek_stage_seconds_total.
+static void stage_timing_init(stage_timing_t* timing, const char* cid, const char* stage)
+{
+	*timing = stage_timing_t();
+	timing->name = stage;
+	timing->seconds = seeknode_metrics_counter(&g_metrics, "seek_stage_seconds_total", "Frame processing time by stage.", { { "camera", cid }, { "stage", stage } }, 1.0e-9);
+}
+
+// Accumulates the duration of a stage started at start_ns (monotonic clock) and traces it.
+static void stage_timing_add(stage_timing_t* timing, int64_t start_ns)
+{
+	const int64_t end_ns = seeknode_clock_monotonic_ns();
+	const int64_t elapsed_ns = end_ns - start_ns;
+	SEEKNODE_TRACE_COMPLETE(timing->name, start_ns, end_ns);
+	seeknode_metric_add(timing->seconds, (uint64_t)elapsed_ns);
+	++timing->count;
+	timing->total_ns += elapsed_ns;
+	timing->max_ns = elapsed_ns > timing->max_ns ? elapsed_ns : timing->max_ns;
+}
+
+// Prints the average and worst duration of a stage and starts a new reporting window.
+static void stage_timing_report(stage_timing_t* timing, const char* cid, const char* stage)
+{
+	if(timing->count > 0)
+	{
+		fprintf(stdout, "stage timing: %s (%s: avg %.3f ms, max %.3f ms, frames %llu)\n",
+			cid,
+			stage,
+			timing->total_ns * 1.0e-6 / timing->count,
+			timing->max_ns * 1.0e-6,
+			(unsigned long long)timing->count);
+	}
+	timing->count = 0;
+	timing->total_ns = 0;
+	timing->max_ns = 0;
+}
+
+// Publishes a message from a frame thread.
+// roscpp serializes every message into a newly allocated buffer; that allocation is left out of the tracking.
+template<typename M>
+static void publish_message(const ros::Publisher& publisher, const M& message)
+{
+	seeknode_alloc_pause_t pause;
+	publisher.publish(message);
+}
+
+// Periodically prints the per camera estimates and stage timings.
+static void report_camera(samplectx_t* ctx, const char* cid, int64_t now_ns)
+{
+	if(now_ns - ctx->last_report_ns < (int64_t)(g_report_period * 1.0e9))
+	{
+		return;
+	}
+	ctx->last_report_ns = now_ns;
+
+	// CPU time of the frame thread, which includes the SDK processing that produced the frames.
+	const int64_t cpu_ns = seeknode_clock_thread_cpu_ns();
+	if(ctx->cpu_report_frames > 0 && ctx->num_frames > ctx->cpu_report_frames)
+	{
+		fprintf(stdout, "frame cpu: %s (%.3f ms per frame, window: %zux%zu+%zu+%zu, changes: %llu)\n",
+			cid,
+			(cpu_ns - ctx->cpu_report_ns) * 1.0e-6 / (ctx->num_frames - ctx->cpu_report_frames),
+			ctx->window.width,
+			ctx->window.height,
+			ctx->window.x,
+			ctx->window.y,
+			(unsigned long long)ctx->window.num_changes);
+	}
+	ctx->cpu_report_ns = cpu_ns;
+	ctx->cpu_report_frames = ctx->num_frames;
+
+	if(seeknode_clock_is_locked(&ctx->clock))
+	{
+		fprintf(stdout, "clock estimate: %s (drift: %.2f ppm, jitter: %.3f ms, excess delay: %.3f ms, outliers: %zu, resets: %zu)\n",
+			cid,
+			seeknode_clock_get_drift_ppm(&ctx->clock),
+			seeknode_clock_get_jitter_ns(&ctx->clock) * 1.0e-6,
+			seeknode_clock_get_excess_delay_ns(&ctx->clock) * 1.0e-6,
+			ctx->clock.num_outliers,
+			ctx->clock.num_resets);
+	}
+
+	if(ctx->shutter.num_blackouts > 0 || ctx->shutter.num_shutters > 0)
+	{
+		fprintf(stdout, "shutter: %s (scheduled: %llu, last: %s, blackouts: %llu, scheduled blackouts: %llu, avg: %.1f ms, max: %.1f ms)\n",
+			cid,
+			(unsigned long long)ctx->shutter.num_shutters,
+			seeknode_shutter_reason_get_str(ctx->shutter.last_reason),
+			(unsigned long long)ctx->shutter.num_blackouts,
+			(unsigned long long)ctx->shutter.num_scheduled_blackouts,
+			ctx->shutter.num_blackouts > 0 ? ctx->shutter.total_blackout_ns * 1.0e-6 / ctx->shutter.num_blackouts : 0.0,
+			ctx->shutter.max_blackout_ns * 1.0e-6);
+	}
+
+	const seeknode_dropmon_t* drops = &ctx->drops;
+	fprintf(stdout, "frame drops: %s (sdk: %llu, ring: %llu, writer: %llu, publish: %llu, gaps: %llu, max gap: %u, stalls: %llu, period: %.2f ms, jitter: %.3f ms, max interval: %.1f ms)\n",
+		cid,
+		(unsigned long long)drops->num_dropped[SEEKNODE_DROP_STAGE_SDK].load(),
+		(unsigned long long)drops->num_dropped[SEEKNODE_DROP_STAGE_RING].load(),
+		(unsigned long long)drops->num_dropped[SEEKNODE_DROP_STAGE_WRITER].load(),
+		(unsigned long long)drops->num_dropped[SEEKNODE_DROP_STAGE_PUBLISH].load(),
+		(unsigned long long)drops->num_gaps,
+		drops->max_gap,
+		(unsigned long long)drops->num_stalls.load(),
+		drops->period_ns * 1.0e-6,
+		seeknode_dropmon_get_jitter_ns(drops) * 1.0e-6,
+		drops->max_interval_ns * 1.0e-6);
+
+	if(ctx->is_gated)
+	{
+		const uint64_t total_bytes = ctx->gate.bytes_published + ctx->gate.bytes_suppressed;
+		fprintf(stdout, "scene gate: %s (published: %llu, suppressed: %llu, saved: %.1f MB / %.1f%%)\n",
+			cid,
+			(unsigned long long)ctx->gate.num_published,
+			(unsigned long long)ctx->gate.num_suppressed,
+			ctx->gate.bytes_suppressed * 1.0e-6,
+			total_bytes > 0 ? 100.0 * ctx->gate.bytes_suppressed / total_bytes : 0.0);
+	}
+
+	if(!isnan(ctx->nonuniformity.estimate))
+	{
+		fprintf(stdout, "non-uniformity: %s (%.3f degrees, threshold: %.3f)\n", cid, ctx->nonuniformity.estimate, g_fsc_threshold);
+	}
+
+	stage_timing_report(&ctx->bad_pixels_timing, cid, "bad_pixels");
+	stage_timing_report(&ctx->denoise_timing, cid, "denoise");
+	stage_timing_report(&ctx->gate_timing, cid, "gate");
+	stage_timing_report(&ctx->roi_timing, cid, "roi");
+	stage_timing_report(&ctx->blobs_timing, cid, "blobs");
+	stage_timing_report(&ctx->rect_timing, cid, "rectify");
+	stage_timing_report(&ctx->composite_timing, cid, "composite");
+	stage_timing_report(&ctx->statistics_timing, cid, "statistics");
+	stage_timing_report(&ctx->nonuniformity_timing, cid, "nonuniformity");
+	stage_timing_report(&ctx->alarms_timing, cid, "alarms");
+	stage_timing_report(&ctx->shm_timing, cid, "shm");
+	stage_timing_report(&ctx->udp_timing, cid, "udp");
+	stage_timing_report(&ctx->publish_timing, cid, "publish");
+	stage_timing_report(&ctx->record_timing, cid, "record");
+}
+
+// Gets the cache entry of a camera, registering its metrics on first use.
+static camera_cache_t* get_camera_cache(const char* cid)
+{
+	std::lock_guard<std::mutex> lock(g_camera_cache_mutex);
+	camera_cache_t* cache = &g_camera_cache[cid];
+	camera_metrics_t* metrics = &cache->metrics;
+	if(metrics->frames != NULL)
+	{
+		return cache;
+	}
+
+	const seeknode_metric_labels_t labels = { { "camera", cid } };
+	metrics->frames = seeknode_metrics_counter(&g_metrics, "seek_frames_total", "Frames received from the camera.", labels);
+	metrics->cpu_seconds = seeknode_metrics_counter(&g_metrics, "seek_frame_thread_cpu_seconds_total", "CPU time of the frame thread, including SDK processing.", labels, 1.0e-9);
+	metrics->restarts = seeknode_metrics_counter(&g_metrics, "seek_capture_restarts_total", "Capture session restarts after errors.", labels);
+	metrics->connected = seeknode_metrics_gauge(&g_metrics, "seek_camera_connected", "Whether the camera is connected and streaming.", labels);
+	metrics->fps = seeknode_metrics_gauge(&g_metrics, "seek_frames_per_second", "Frame rate over the last metrics period.", labels);
+	metrics->jitter = seeknode_metrics_gauge(&g_metrics, "seek_frame_jitter_seconds", "Frame arrival jitter.", labels);
+	for(int stage = 0; stage < SEEKNODE_DROP_STAGE_COUNT; ++stage)
+	{
+		metrics->dropped[stage] = seeknode_metrics_counter(
+			&g_metrics,
+			"seek_frames_dropped_total",
+			"Frames lost, by stage.",
+			{ { "camera", cid }, { "stage", seeknode_drop_stage_get_str((seeknode_drop_stage_t)stage) } });
+	}
+	metrics->stalls = seeknode_metrics_counter(&g_metrics, "seek_stream_stalls_total", "Stream stalls.", labels);
+	metrics->udp_queue_depth = seeknode_metrics_gauge(&g_metrics, "seek_udp_queue_depth", "Frames waiting for the UDP sender.", labels);
+	metrics->udp_frames = seeknode_metrics_counter(&g_metrics, "seek_udp_frames_total", "Frames sent over UDP.", labels);
+	metrics->udp_bytes = seeknode_metrics_counter(&g_metrics, "seek_udp_bytes_total", "Bytes sent over UDP, headers and parity included.", labels);
+	metrics->recorded_frames = seeknode_metrics_counter(&g_metrics, "seek_recorded_frames_total", "Frames written to the thermography log.", labels);
+	metrics->recorded_bytes = seeknode_metrics_counter(&g_metrics, "seek_recorded_bytes_total", "Bytes written to the thermography log.", labels);
+	metrics->previous_frames = 0;
+	metrics->previous_dropped = 0.0;
+	metrics->previous_ns = seeknode_clock_monotonic_ns();
+	return cache;
+}
+
+// Counts an SDK error of a camera.
+static void count_sdk_error(const char* cid, seekcamera_error_t status)
+{
+	seeknode_metric_t* metric = seeknode_metrics_counter(
+		&g_metrics,
+		"seek_sdk_errors_total",
+		"Errors reported by the camera SDK.",
+		{ { "camera", cid }, { "error", seekcamera_error_get_str(status) } });
+	seeknode_metric_add(metric, 1);
+}
+
+// Gets a camera parameter.
+// Per camera values (~<chipid>/<name>) take precedence over the shared ones (~<name>).
+template<typename T>
+static void get_camera_param(const char* cid, const std::string& name, T* value)
+{
+	if(!g_node->getParam(std::string(cid) + "/" + name, *value))
+	{
+		g_node->getParam(name, *value);
+	}
+}
+
+// Loads the temporal filter options of a camera.
+static void load_denoise(const char* cid, seeknode_denoise_t* denoise)
+{
+	seeknode_denoise_init(denoise);
+
+	std::string mode = "off";
+	double alpha = denoise->alpha;
+	double motion_threshold = denoise->motion_threshold;
+	get_camera_param(cid, "denoise/mode", &mode);
+	get_camera_param(cid, "denoise/alpha", &alpha);
+	get_camera_param(cid, "denoise/motion_threshold", &motion_threshold);
+
+	if(!seeknode_denoise_mode_from_str(mode.c_str(), &denoise->mode))
+	{
+		fprintf(stderr, "invalid denoise mode: %s (%s)\n", cid, mode.c_str());
+		denoise->mode = SEEKNODE_DENOISE_MODE_OFF;
+	}
+	if(alpha > 0.0 && alpha <= 1.0)
+	{
+		denoise->alpha = (float)alpha;
+	}
+	else
+	{
+		fprintf(stderr, "invalid denoise alpha: %s (%f, using %.2f)\n", cid, alpha, denoise->alpha);
+	}
+	if(motion_threshold > 0.0)
+	{
+		denoise->motion_threshold = (float)motion_threshold;
+	}
+	else
+	{
+		fprintf(stderr, "invalid denoise motion threshold: %s (%f, using %.2f)\n", cid, motion_threshold, denoise->motion_threshold);
+	}
+}
+
+// Loads the bad pixel options of a camera.
+static void load_bad_pixels(const char* cid, samplectx_t* ctx)
+{
+	seeknode_badpixel_init(&ctx->bad_pixels);
+	ctx->is_bad_pixels_configured = false;
+
+	std::string mode = "off";
+	int learn_frames = (int)ctx->bad_pixels.learn_frames;
+	get_camera_param(cid, "bad_pixels/mode", &mode);
+	get_camera_param(cid, "bad_pixels/learn_frames", &learn_frames);
+	ctx->bad_pixels.learn_frames = (size_t)std::max(learn_frames, 2);
+
+	if(mode == "off")
+	{
+		ctx->bad_pixels_mode = BAD_PIXELS_MODE_OFF;
+	}
+	else if(mode == "load")
+	{
+		ctx->bad_pixels_mode = BAD_PIXELS_MODE_LOAD;
+	}
+	else if(mode == "learn")
+	{
+		ctx->bad_pixels_mode = BAD_PIXELS_MODE_LEARN;
+	}
+	else if(mode == "relearn")
+	{
+		ctx->bad_pixels_mode = BAD_PIXELS_MODE_RELEARN;
+	}
+	else
+	{
+		fprintf(stderr, "invalid bad pixel mode: %s (%s)\n", cid, mode.c_str());
+		ctx->bad_pixels_mode = BAD_PIXELS_MODE_OFF;
+	}
+}
+
+// Loads the lens calibration of a camera (~<chipid>/calibration/...).
+// Rectification is disabled unless the focal lengths are given.
+static void load_calibration(const char* cid, seeknode_camera_model_t* model)
+{
+	memset(model, 0, sizeof(*model));
+	get_camera_param(cid, "calibration/fx", &model->fx);
+	get_camera_param(cid, "calibration/fy", &model->fy);
+	get_camera_param(cid, "calibration/cx", &model->cx);
+	get_camera_param(cid, "calibration/cy", &model->cy);
+	get_camera_param(cid, "calibration/k1", &model->k1);
+	get_camera_param(cid, "calibration/k2", &model->k2);
+	get_camera_param(cid, "calibration/p1", &model->p1);
+	get_camera_param(cid, "calibration/p2", &model->p2);
+	get_camera_param(cid, "calibration/k3", &model->k3);
+}
+
+// Loads the camera settings of a camera on top of its core defaults.
+// Settings without a parameter keep the core default and are therefore never applied.
+static void load_settings(const char* cid, seeknode_settings_t* settings)
+{
+	double scene_emissivity = settings->scene_emissivity;
+	double thermography_offset = settings->thermography_offset;
+	bool gradient_correction = settings->gradient_correction == SEEKCAMERA_FILTER_STATE_ENABLED;
+	bool flat_scene_correction = settings->flat_scene_correction == SEEKCAMERA_FILTER_STATE_ENABLED;
+	get_camera_param(cid, "settings/scene_emissivity", &scene_emissivity);
+	get_camera_param(cid, "settings/thermography_offset", &thermography_offset);
+	get_camera_param(cid, "settings/gradient_correction", &gradient_correction);
+	get_camera_param(cid, "settings/flat_scene_correction", &flat_scene_correction);
+
+	settings->scene_emissivity = (float)scene_emissivity;
+	settings->thermography_offset = (float)thermography_offset;
+	settings->gradient_correction = gradient_correction ? SEEKCAMERA_FILTER_STATE_ENABLED : SEEKCAMERA_FILTER_STATE_DISABLED;
+	settings->flat_scene_correction = flat_scene_correction ? SEEKCAMERA_FILTER_STATE_ENABLED : SEEKCAMERA_FILTER_STATE_DISABLED;
+	if(g_shutter_scheduled)
+	{
+		settings->shutter_mode = SEEKCAMERA_SHUTTER_MODE_MANUAL;
+	}
+}
+
+// Gets the path of the bad pixel map of a camera.
+static std::string get_bad_pixels_path(const char* cid)
+{
+	return g_bad_pixels_directory + "/badpixels-" + cid + ".bin";
+}
+
+// Creates a directory and its parents.
+static void make_directories(const std::string& path)
+{
+#if defined(__linux__) || defined(__APPLE__)
+	for(size_t i = 1; i <= path.size(); ++i)
+	{
+		if(i == path.size() || path[i] == '/')
+		{
+			mkdir(path.substr(0, i).c_str(), 0755);
+		}
+	}
+#else
+	(void)path;
+#endif
+}
+
+// Converts a numeric XML-RPC value to a double.
+// Parameters written as integers in YAML arrive as integers.
+static bool xmlrpc_to_double(XmlRpc::XmlRpcValue& value, double* out)
+{
+	if(value.getType() == XmlRpc::XmlRpcValue::TypeDouble)
+	{
+		*out = (double)value;
+		return true;
+	}
+	if(value.getType() == XmlRpc::XmlRpcValue::TypeInt)
+	{
+		*out = (int)value;
+		return true;
+	}
+	return false;
+}
+
+// Loads the regions of interest of a camera into its ROI engine.
+// Per camera regions (~<chipid>/rois) take precedence over the shared ones (~rois).
+// Each region is a struct with a name, either rect: [x, y, w, h] or polygon: [x0, y0, x1, y1, ...], and an optional threshold.
+static void load_rois(const char* cid, seeknode_roi_engine_t* engine)
+{
+	seeknode_roi_engine_init(engine);
+
+	XmlRpc::XmlRpcValue rois;
+	if(!g_node->getParam(std::string(cid) + "/rois", rois) && !g_node->getParam("rois", rois))
+	{
+		return;
+	}
+
+	if(rois.getType() != XmlRpc::XmlRpcValue::TypeArray)
+	{
+		fprintf(stderr, "invalid rois parameter: %s (expected a list)\n", cid);
+		return;
+	}
+
+	for(int i = 0; i < rois.size(); ++i)
+	{
+		XmlRpc::XmlRpcValue& roi = rois[i];
+		if(roi.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+		{
+			fprintf(stderr, "invalid roi %d: %s (expected a struct)\n", i, cid);
+			continue;
+		}
+
+		std::string name = "roi" + std::to_string(i);
+		if(roi.hasMember("name") && roi["name"].getType() == XmlRpc::XmlRpcValue::TypeString)
+		{
+			name = (std::string)roi["name"];
+		}
+
+		double threshold = NAN;
+		if(roi.hasMember("threshold") && !xmlrpc_to_double(roi["threshold"], &threshold))
+		{
+			fprintf(stderr, "invalid roi threshold: %s (%s)\n", cid, name.c_str());
+			continue;
+		}
+
+		const char* key = roi.hasMember("rect") ? "rect" : "polygon";
+		if(!roi.hasMember(key) || roi[key].getType() != XmlRpc::XmlRpcValue::TypeArray)
+		{
+			fprintf(stderr, "invalid roi geometry: %s (%s)\n", cid, name.c_str());
+			continue;
+		}
+
+		std::vector<float> values;
+		bool is_valid = true;
+		for(int j = 0; j < roi[key].size() && is_valid; ++j)
+		{
+			double value = 0.0;
+			is_valid = xmlrpc_to_double(roi[key][j], &value);
+			values.push_back((float)value);
+		}
+
+		if(is_valid && strcmp(key, "rect") == 0 && values.size() == 4)
+		{
+			seeknode_roi_engine_add_rect(engine, name, (int)values[0], (int)values[1], (int)values[2], (int)values[3], (float)threshold);
+		}
+		else if(is_valid && strcmp(key, "polygon") == 0 && values.size() >= 6 && values.size() % 2 == 0)
+		{
+			seeknode_roi_engine_add_polygon(engine, name, values, (float)threshold);
+		}
+		else
+		{
+			fprintf(stderr, "invalid roi geometry: %s (%s)\n", cid, name.c_str());
+		}
+	}
+
+	fprintf(stdout, "loaded regions of interest: %s (count: %zu)\n", cid, engine->rois.size());
+}
+
+// Loads the alarm rules of a camera into its alarm engine.
+// Per camera rules (~<chipid>/alarms) take precedence over the shared ones (~alarms).
+// Each rule is a struct with a name, a type (above, below or rise), a threshold, an optional rect: [x, y, w, h]
+// (default: whole frame), hysteresis, window (seconds, rise only) and record flag.
+static void load_alarms(const char* cid, seeknode_alarm_engine_t* engine)
+{
+	seeknode_alarm_engine_init(engine);
+
+	XmlRpc::XmlRpcValue alarms;
+	if(!g_node->getParam(std::string(cid) + "/alarms", alarms) && !g_node->getParam("alarms", alarms))
+	{
+		return;
+	}
+
+	if(alarms.getType() != XmlRpc::XmlRpcValue::TypeArray)
+	{
+		fprintf(stderr, "invalid alarms parameter: %s (expected a list)\n", cid);
+		return;
+	}
+
+	for(int i = 0; i < alarms.size(); ++i)
+	{
+		XmlRpc::XmlRpcValue& alarm = alarms[i];
+		if(alarm.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+		{
+			fprintf(stderr, "invalid alarm %d: %s (expected a struct)\n", i, cid);
+			continue;
+		}
+
+		seeknode_alarm_rule_t rule;
+		rule.name = "alarm" + std::to_string(i);
+		rule.type = SEEKNODE_ALARM_TYPE_ABOVE;
+		rule.x = 0;
+		rule.y = 0;
+		rule.width = 0;
+		rule.height = 0;
+		rule.is_recording = true;
+		if(alarm.hasMember("name") && alarm["name"].getType() == XmlRpc::XmlRpcValue::TypeString)
+		{
+			rule.name = (std::string)alarm["name"];
+		}
+
+		if(!alarm.hasMember("type") || alarm["type"].getType() != XmlRpc::XmlRpcValue::TypeString
+			|| !seeknode_alarm_type_from_str(((std::string)alarm["type"]).c_str(), &rule.type))
+		{
+			fprintf(stderr, "invalid alarm type: %s (%s)\n", cid, rule.name.c_str());
+			continue;
+		}
+
+		double threshold = NAN;
+		double hysteresis = 0.5;
+		double window = 10.0;
+		bool is_valid = alarm.hasMember("threshold") && xmlrpc_to_double(alarm["threshold"], &threshold);
+		is_valid = is_valid && (!alarm.hasMember("hysteresis") || xmlrpc_to_double(alarm["hysteresis"], &hysteresis));
+		is_valid = is_valid && (!alarm.hasMember("window") || xmlrpc_to_double(alarm["window"], &window));
+		if(!is_valid)
+		{
+			fprintf(stderr, "invalid alarm threshold: %s (%s)\n", cid, rule.name.c_str());
+			continue;
+		}
+		rule.threshold = (float)threshold;
+		rule.hysteresis = (float)hysteresis;
+		rule.window_ns = (int64_t)(window * 1.0e9);
+
+		if(alarm.hasMember("record") && alarm["record"].getType() == XmlRpc::XmlRpcValue::TypeBoolean)
+		{
+			rule.is_recording = (bool)alarm["record"];
+		}
+
+		if(alarm.hasMember("rect"))
+		{
+			XmlRpc::XmlRpcValue& rect = alarm["rect"];
+			double values[4] = { 0.0 };
+			is_valid = rect.getType() == XmlRpc::XmlRpcValue::TypeArray && rect.size() == 4;
+			for(int j = 0; j < 4 && is_valid; ++j)
+			{
+				is_valid = xmlrpc_to_double(rect[j], &values[j]);
+			}
+			if(!is_valid || values[2] <= 0.0 || values[3] <= 0.0)
+			{
+				fprintf(stderr, "invalid alarm geometry: %s (%s)\n", cid, rule.name.c_str());
+				continue;
+			}
+			rule.x = (int)values[0];
+			rule.y = (int)values[1];
+			rule.width = (int)values[2];
+			rule.height = (int)values[3];
+		}
+
+		seeknode_alarm_engine_add_rule(engine, &rule);
+	}
+
+	fprintf(stdout, "loaded alarms: %s (count: %zu)\n", cid, engine->rules.size());
+}
+
+// Writes the statistics snapshot of a camera to a CSV file.
+// The layout follows the thermography log: a header line padded to the frame width followed by one line per row,
+// once for the mean plane and once for the standard deviation plane.
+// Runs on the background worker; the snapshot is not touched by the frame callback until is_statistics_exporting clears.
+static void export_statistics(samplectx_t* ctx)
+{
+	seekcamera_chipid_t cid;
+	seekcamera_get_chipid(ctx->camera, &cid);
+
+	const size_t width = ctx->statistics_snapshot_width;
+	const size_t height = ctx->statistics_snapshot_height;
+	const uint64_t count = ctx->statistics_snapshot_count;
+	const std::vector<float>& planes = ctx->statistics_snapshot;
+
+	char filename[MAX_FILENAME_LENGTH];
+	snprintf(filename, MAX_FILENAME_LENGTH, "statistics-%s-%llu.csv", cid, (unsigned long long)(ctx->statistics_snapshot_timestamp_ns / 1000000000ULL));
+	FILE* file = fopen(filename, "w");
+	if(file == NULL)
+	{
+		fprintf(stderr, "failed to open statistics file: %s (%s)\n", cid, filename);
+		ctx->is_statistics_exporting = false;
+		return;
+	}
+
+	const char* plane_names[2] = { "mean", "stddev" };
+	for(size_t plane = 0; plane < 2; ++plane)
+	{
+		size_t column = 0;
+		fprintf(file, "chipid=%s,", cid);
+		++column;
+		fprintf(file, "plane=%s,", plane_names[plane]);
+		++column;
+		fprintf(file, "frames=%llu,", (unsigned long long)count);
+		++column;
+		fprintf(file, "frame_step=%d,", g_statistics_frame_step);
+		++column;
+		fprintf(file, "timestamp_utc_ns=%zu,", (size_t)ctx->statistics_snapshot_timestamp_ns);
+		++column;
+		for(; column < width; ++column)
+		{
+			fprintf(file, "blank,");
+		}
+		fputc('\n', file);
+
+		const float* values = planes.data() + plane * width * height;
+		for(size_t y = 0; y < height; ++y)
+		{
+			for(size_t x = 0; x < width; ++x)
+			{
+				fprintf(file, "%.4f,", values[y * width + x]);
+			}
+			fputc('\n', file);
+		}
+	}
+	fclose(file);
+	ctx->is_statistics_exporting = false;
+
+	fprintf(stdout, "exported pixel statistics: %s (%s, frames: %llu)\n", cid, filename, (unsigned long long)count);
+}
+
+// Handles flat scene correction store progress updates.
+static void handle_fsc_store_progress_update(size_t progress, void* user_data)
+{
+	samplectx_t* ctx = (samplectx_t*)user_data;
+
+	seekcamera_chipid_t cid;
+	seekcamera_get_chipid(ctx->camera, &cid);
+	fprintf(stdout, "flat scene correction store: %s (%zu %% complete)\n", cid, progress);
+}
+
+// Stores a flat scene correction.
+// Runs on the background worker: the store takes seconds and the frame callbacks of this and other cameras must keep running.
+static void store_fsc(samplectx_t* ctx)
+{
+	seekcamera_chipid_t cid;
+	seekcamera_get_chipid(ctx->camera, &cid);
+
+	const seekcamera_error_t status = seekcamera_store_flat_scene_correction(
+		ctx->camera,
+		SEEKCAMERA_FLAT_SCENE_CORRECTION_ID_0,
+		handle_fsc_store_progress_update,
+		ctx);
+
+	if(status == SEEKCAMERA_SUCCESS)
+	{
+		fprintf(stdout, "stored flat scene correction: %s\n", cid);
+	}
+	else
+	{
+		fprintf(stderr, "failed to store flat scene correction: %s (%s)\n", cid, seekcamera_error_get_str(status));
+	}
+
+	ctx->last_fsc_ns = seeknode_clock_monotonic_ns();
+	ctx->is_fsc_running = false;
+}
+
+// Runs the background jobs of a context until the node exits.
+static void background_worker_thread(samplectx_t* ctx)
+{
+	std::unique_lock<std::mutex> lock(ctx->worker_mutex);
+	while(true)
+	{
+		ctx->worker_cv.wait(lock, [ctx]() { return ctx->worker_jobs != 0 || ctx->is_worker_stopping; });
+		if(ctx->worker_jobs == 0)
+		{
+			break;
+		}
+
+		const uint32_t jobs = ctx->worker_jobs;
+		ctx->worker_jobs = 0;
+		ctx->is_worker_busy = true;
+		lock.unlock();
+
+		if(jobs & WORKER_JOB_EXPORT_STATISTICS)
+		{
+			export_statistics(ctx);
+		}
+		if(jobs & WORKER_JOB_STORE_FSC)
+		{
+			store_fsc(ctx);
+		}
+
+		lock.lock();
+		ctx->is_worker_busy = false;
+		ctx->worker_cv.notify_all();
+	}
+}
+
+// Hands a job to the background worker of a context.
+static void post_worker_job(samplectx_t* ctx, worker_job_t job)
+{
+	std::lock_guard<std::mutex> lock(ctx->worker_mutex);
+	ctx->worker_jobs |= (uint32_t)job;
+	ctx->worker_cv.notify_all();
+}
+
+// Waits until the background worker of a context has no pending or running job (e.g. before the camera goes away).
+static void wait_for_worker(samplectx_t* ctx)
+{
+	std::unique_lock<std::mutex> lock(ctx->worker_mutex);
+	ctx->worker_cv.wait(lock, [ctx]() { return ctx->worker_jobs == 0 && !ctx->is_worker_busy; });
+}
+
+// Records a crop request for the thermography window of a camera.
+// Requests expire unless they are republished; a zero width or height requests the full frame.
+static void crop_callback(samplectx_t* ctx, const sensor_msgs::RegionOfInterestConstPtr& message)
+{
+	crop_request_t request;
+	request.x = (int)message->x_offset;
+	request.y = (int)message->y_offset;
+	request.width = (int)message->width;
+	request.height = (int)message->height;
+	request.received_ns = seeknode_clock_monotonic_ns();
+
+	std::lock_guard<std::mutex> lock(ctx->crop_mutex);
+	for(crop_request_t& pending : ctx->crop_requests)
+	{
+		if(pending.x == request.x && pending.y == request.y && pending.width == request.width && pending.height == request.height)
+		{
+			pending.received_ns = request.received_ns;
+			return;
+		}
+	}
+	ctx->crop_requests.push_back(request);
+}
+
+// Sets the thermography window of a camera to the union of what its consumers need.
+// Stages that keep per-pixel state over the whole sensor, or search all of it, hold the window at the full sensor.
+// The new window applies to later frames; the SDK keeps its capture session running.
+static void update_window(samplectx_t* ctx, const char* cid, int64_t now_ns)
+{
+	seeknode_window_t* window = &ctx->window;
+	seeknode_window_begin(window);
+
+	const bool is_learning_bad_pixels = ctx->bad_pixels_mode != BAD_PIXELS_MODE_OFF &&
+		(!ctx->is_bad_pixels_configured || seeknode_badpixel_is_learning(&ctx->bad_pixels));
+	if(!isnan(ctx->blobs.threshold) || g_composite_enabled || g_statistics_enabled || g_fsc_auto || is_learning_bad_pixels)
+	{
+		seeknode_window_add_full(window);
+	}
+
+	for(const seeknode_roi_t& roi : ctx->roi.rois)
+	{
+		if(!roi.is_polygon)
+		{
+			seeknode_window_add(window, roi.x, roi.y, roi.w, roi.h);
+			continue;
+		}
+
+		float min_x = INFINITY;
+		float min_y = INFINITY;
+		float max_x = -INFINITY;
+		float max_y = -INFINITY;
+		for(size_t i = 0; i + 1 < roi.vertices.size(); i += 2)
+		{
+			min_x = std::min(min_x, roi.vertices[i]);
+			max_x = std::max(max_x, roi.vertices[i]);
+			min_y = std::min(min_y, roi.vertices[i + 1]);
+			max_y = std::max(max_y, roi.vertices[i + 1]);
+		}
+		if(min_x <= max_x && min_y <= max_y)
+		{
+			const long x = (long)floorf(min_x);
+			const long y = (long)floorf(min_y);
+			seeknode_window_add(window, x, y, (long)ceilf(max_x) - x, (long)ceilf(max_y) - y);
+		}
+	}
+
+	for(const seeknode_alarm_rule_t& rule : ctx->alarms.rules)
+	{
+		if(rule.width > 0 && rule.height > 0)
+		{
+			seeknode_window_add(window, rule.x, rule.y, rule.width, rule.height);
+		}
+		else
+		{
+			seeknode_window_add_full(window);
+		}
+	}
+
+	{
+		const int64_t timeout_ns = (int64_t)(g_crop_request_timeout * 1.0e9);
+		std::lock_guard<std::mutex> lock(ctx->crop_mutex);
+		ctx->crop_requests.erase(
+			std::remove_if(
+				ctx->crop_requests.begin(),
+				ctx->crop_requests.end(),
+				[&](const crop_request_t& request) { return now_ns - request.received_ns > timeout_ns; }),
+			ctx->crop_requests.end());
+		for(const crop_request_t& request : ctx->crop_requests)
+		{
+			if(request.width > 0 && request.height > 0)
+			{
+				seeknode_window_add(window, request.x, request.y, request.width, request.height);
+			}
+			else
+			{
+				seeknode_window_add_full(window);
+			}
+		}
+	}
+
+	const seeknode_window_t previous = *window;
+	if(!seeknode_window_update(window))
+	{
+		return;
+	}
+
+	const seekcamera_error_t status = seekcamera_set_thermography_window(ctx->camera, window->x, window->y, window->width, window->height);
+	ctx->previous_window = previous;
+	ctx->is_window_change_pending = true;
+	if(status != SEEKCAMERA_SUCCESS)
+	{
+		// Give up on windowing this camera and make sure it computes the full sensor.
+		fprintf(stderr, "failed to set thermography window: %s (%s)\n", cid, seekcamera_error_get_str(status));
+		ctx->is_windowed = false;
+		window->x = 0;
+		window->y = 0;
+		window->width = window->sensor_width;
+		window->height = window->sensor_height;
+		seekcamera_set_thermography_window(ctx->camera, 0, 0, window->sensor_width, window->sensor_height);
+	}
+	else
+	{
+		fprintf(stdout, "set thermography window: %s (%zux%zu+%zu+%zu)\n", cid, window->width, window->height, window->x, window->y);
+	}
+
+	sensor_msgs::RegionOfInterest message;
+	message.x_offset = (uint32_t)window->x;
+	message.y_offset = (uint32_t)window->y;
+	message.width = (uint32_t)window->width;
+	message.height = (uint32_t)window->height;
+	message.do_rectify = false;
+	publish_message(ctx->window_pub, message);
+}
+
 // Callback function for a particular Seek camera.
 // This function fires whenever a frame is available.
 void frame_available_callback(seekcamera_t* camera, seekcamera_frame_t* camera_frame, void* user_data)
 {
 	samplectx_t* ctx = (samplectx_t*)user_data;
+	SEEKNODE_TRACE_SCOPE("frame");
+
+	// Once the camera is warm, the frame path is expected not to allocate (checked in allocation tracking builds).
+	seeknode_alloc_track_thread(seeknode_clock_monotonic_ns() - ctx->connect_ns >= g_alloc_warmup_ns);
 
 	if(!ctx->is_live)
 	{
 		fprintf(stderr, "unable to continue: camera is not live\n");
+		seeknode_dropmon_add_drops(&ctx->drops, SEEKNODE_DROP_STAGE_PUBLISH, 1);
 		return;
 	}
 
 	if(ctx->log == NULL)
 	{
 		fprintf(stderr, "unable to continue: log handle is invalid\n");
+		seeknode_dropmon_add_drops(&ctx->drops, SEEKNODE_DROP_STAGE_PUBLISH, 1);
 		return;
 	}
 
 	seekcamera_chipid_t cid;
 	seekcamera_get_chipid(camera, &cid);
+	SEEKNODE_TRACE_CAMERA(cid);
 
 	seekframe_t* frame = NULL;
-	const seekcamera_error_t status = seekcamera_frame_get_frame_by_format(
-		camera_frame,
-		SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT,
-		&frame);
+	seekcamera_error_t status = SEEKCAMERA_SUCCESS;
+	{
+		SEEKNODE_TRACE_SCOPE("get_frame");
+		status = seekcamera_frame_get_frame_by_format(
+			camera_frame,
+			SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT,
+			&frame);
+	}
 
 	if(status != SEEKCAMERA_SUCCESS)
 	{
 		fprintf(stderr, "failed to get thermal frame: %s (%s)", cid, seekcamera_error_get_str(status));
+		count_sdk_error(cid, status);
+		seeknode_dropmon_add_drops(&ctx->drops, SEEKNODE_DROP_STAGE_PUBLISH, 1);
+		return;
+	}
+
+	const size_t frame_width = seekframe_get_width(frame);
+	const size_t frame_height = seekframe_get_height(frame);
+
+	fprintf(stdout, "frame available: %s (size: %zux%zu)\n", cid, frame_width, frame_height);
+
+	seekcamera_frame_header_t* header = (seekcamera_frame_header_t*)seekframe_get_header(frame);
+
+	// Locate the frame on the sensor; the first frame is always full size.
+	// Depending on the SDK, a windowed frame is either cropped to the window or full size with only the window
+	// computed, in which case every stage works on a view of the window. Frames in flight when the window changes
+	// still have the previous one; when both windows have the same size, the size cannot tell them apart, so the first
+	// frame after a change is attributed to the previous window.
+	if(ctx->window.sensor_width == 0)
+	{
+		seeknode_window_configure(&ctx->window, frame_width, frame_height);
+		ctx->previous_window = ctx->window;
+	}
+	const seeknode_window_t* current = &ctx->window;
+	const seeknode_window_t* previous = &ctx->previous_window;
+	float* pixels = (float*)seekframe_get_data(frame);
+	const size_t stride = seekframe_get_line_stride(frame);
+	size_t origin_x = 0;
+	size_t origin_y = 0;
+	size_t width = frame_width;
+	size_t height = frame_height;
+	const bool is_previous_size = frame_width == previous->width && frame_height == previous->height;
+	if(ctx->is_window_change_pending && is_previous_size)
+	{
+		origin_x = previous->x;
+		origin_y = previous->y;
+		ctx->is_window_change_pending = false;
+	}
+	else if(frame_width == current->width && frame_height == current->height)
+	{
+		origin_x = current->x;
+		origin_y = current->y;
+		ctx->is_window_change_pending = false;
+	}
+	else if(frame_width == current->sensor_width && frame_height == current->sensor_height)
+	{
+		origin_x = current->x;
+		origin_y = current->y;
+		width = current->width;
+		height = current->height;
+		pixels = (float*)((uint8_t*)pixels + origin_y * stride) + origin_x;
+		ctx->is_window_change_pending = false;
+	}
+	else if(is_previous_size)
+	{
+		origin_x = previous->x;
+		origin_y = previous->y;
+	}
+
+	// Temporal state is per pixel of the window; a window that moves without changing size invalidates it as well.
+	if(origin_x != ctx->frame_origin_x || origin_y != ctx->frame_origin_y)
+	{
+		seeknode_denoise_reset(&ctx->denoise);
+		seeknode_gate_reset(&ctx->gate);
+		ctx->frame_origin_x = origin_x;
+		ctx->frame_origin_y = origin_y;
+	}
+	++ctx->num_frames;
+	if(ctx->num_frames == 1)
+	{
+		SEEKNODE_TRACE_THREAD_NAME(std::string("frames ") + cid);
+	}
+
+	// CPU time of the frame thread since the previous frame.
+	camera_metrics_t* metrics = &ctx->cache->metrics;
+	const int64_t cpu_ns = seeknode_clock_thread_cpu_ns();
+	if(ctx->cpu_metrics_ns > 0)
+	{
+		seeknode_metric_add(metrics->cpu_seconds, (uint64_t)std::max(cpu_ns - ctx->cpu_metrics_ns, (int64_t)0));
+	}
+	ctx->cpu_metrics_ns = cpu_ns;
+	seeknode_metric_add(metrics->frames, 1);
+
+	// Relate the camera timestamp to the host clock.
+	// Arrival times are sampled on the monotonic clock so NTP steps do not disturb the fit.
+	// Published stamps are the ROS time at arrival minus the estimated age of the frame.
+	const int64_t arrival_ns = seeknode_clock_monotonic_ns();
+	const ros::Time arrival_stamp = ros::Time::now();
+	seeknode_clock_update(&ctx->clock, header->timestamp_utc_ns, arrival_ns);
+
+	// Track the frame sequence; alerts are raised by the watchdog timer.
+	int64_t stall_ns = 0;
+	const uint32_t num_missing = seeknode_dropmon_frame(&ctx->drops, header->fpa_frame_count, arrival_ns, &stall_ns);
+	if(num_missing > 0)
+	{
+		fprintf(stdout, "frame gap: %s (missing: %u, fpa frame count: %u)\n", cid, num_missing, header->fpa_frame_count);
+	}
+	if(stall_ns > 0)
+	{
+		fprintf(stdout, "stream resumed: %s (stalled for %.1f ms)\n", cid, stall_ns * 1.0e-6);
+	}
+	seeknode_metric_set(metrics->jitter, seeknode_dropmon_get_jitter_ns(&ctx->drops) * 1.0e-9);
+
+	ros::Time stamp = arrival_stamp;
+	if(seeknode_clock_is_locked(&ctx->clock))
+	{
+		const int64_t age_ns = arrival_ns - seeknode_clock_to_host_ns(&ctx->clock, header->timestamp_utc_ns);
+		stamp = arrival_stamp - ros::Duration(age_ns * 1.0e-9);
+	}
+
+	// Report the time to first frame of a new capture session (connect or restart).
+	const int64_t session_start_ns = ctx->session_start_ns.exchange(0);
+	if(session_start_ns > 0)
+	{
+		const int64_t first_frame_ns = arrival_ns - session_start_ns;
+		ctx->max_first_frame_ns = std::max(ctx->max_first_frame_ns, first_frame_ns);
+		fprintf(stdout, "first frame: %s (%s, %.1f ms, restarts: %llu, max: %.1f ms)\n",
+			cid,
+			ctx->is_restart ? "restart" : "connect",
+			first_frame_ns * 1.0e-6,
+			(unsigned long long)ctx->num_restarts,
+			ctx->max_first_frame_ns * 1.0e-6);
+	}
+
+	// Measure the start-up: time from start until each camera, and then all the expected ones, stream.
+	if(!ctx->cache->has_streamed)
+	{
+		ctx->cache->has_streamed = true;
+		const int num_streaming = ++g_num_streaming;
+		const double elapsed_ms = (arrival_ns - g_start_ns) * 1.0e-6;
+		fprintf(stdout, "streaming: %s (cameras: %d, %.1f ms since start)\n", cid, num_streaming, elapsed_ms);
+		if(num_streaming == g_expected_cameras)
+		{
+			fprintf(stdout, "all cameras streaming: %d (%.1f ms since start)\n", num_streaming, elapsed_ms);
+		}
+	}
+
+	// Measure blackouts (shutter or dropouts) from frame arrival gaps.
+	const int64_t blackout_ns = seeknode_shutter_frame(&ctx->shutter, arrival_ns);
+	if(blackout_ns > 0)
+	{
+		fprintf(stdout, "frame blackout: %s (%.1f ms)\n", cid, blackout_ns * 1.0e-6);
+	}
+
+	// Trigger the shutter at a moment the platform is not busy.
+	// A busy signal that is not refreshed within the timeout is ignored so a dead publisher cannot block shutters.
+	if(ctx->is_shutter_scheduled)
+	{
+		const bool is_busy = g_is_busy && arrival_ns - g_busy_ns < (int64_t)(g_busy_timeout * 1.0e9);
+		if(seeknode_shutter_update(&ctx->shutter, arrival_ns, header->environment_temperature, header->fpa_diode_count, is_busy))
+		{
+			const seekcamera_error_t shutter_status = seekcamera_shutter_trigger(camera);
+			if(shutter_status == SEEKCAMERA_SUCCESS)
+			{
+				fprintf(stdout, "triggered shutter: %s (%s)\n", cid, seeknode_shutter_reason_get_str(ctx->shutter.last_reason));
+			}
+			else
+			{
+				fprintf(stderr, "failed to trigger shutter: %s (%s)\n", cid, seekcamera_error_get_str(shutter_status));
+			}
+		}
+	}
+
+	// Follow the regions and crop requests with the thermography window.
+	if(ctx->is_windowed)
+	{
+		update_window(ctx, cid, arrival_ns);
+	}
+
+	// Accumulate per-pixel statistics of the raw thermography, before host processing alters the temporal variance.
+	// Only every frame_step-th frame is accumulated; consecutive frames add little information about slow drift.
+	if(g_statistics_enabled)
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		if(ctx->statistics_frame_count++ % (uint64_t)g_statistics_frame_step == 0)
+		{
+			seeknode_welford_configure(&ctx->statistics, width, height);
+			if(!ctx->is_statistics_exporting)
+			{
+				ctx->statistics_snapshot.resize(width * height * 2);
+			}
+			seeknode_welford_add(&ctx->statistics, pixels, stride);
+		}
+
+		// Export on request, and at the end of every window before starting the next one.
+		// The planes are snapshotted here and written by the background worker. While it is still writing the previous
+		// export, the request and the end of the window are kept for a later frame.
+		const bool is_window_complete = g_statistics_window > 0.0 && arrival_ns - (int64_t)ctx->statistics_window_start_ns >= (int64_t)(g_statistics_window * 1.0e9);
+		if((ctx->is_statistics_export_requested || is_window_complete) && !ctx->is_statistics_exporting)
+		{
+			ctx->is_statistics_export_requested = false;
+			const uint64_t count = seeknode_welford_get_count(&ctx->statistics);
+			if(count >= 2)
+			{
+				const size_t num_pixels = ctx->statistics.width * ctx->statistics.height;
+				ctx->statistics_snapshot.resize(num_pixels * 2);
+				seeknode_welford_snapshot(&ctx->statistics, ctx->statistics_snapshot.data(), ctx->statistics_snapshot.data() + num_pixels);
+				ctx->statistics_snapshot_width = ctx->statistics.width;
+				ctx->statistics_snapshot_height = ctx->statistics.height;
+				ctx->statistics_snapshot_count = count;
+				ctx->statistics_snapshot_timestamp_ns = header->timestamp_utc_ns;
+				ctx->is_statistics_exporting = true;
+				post_worker_job(ctx, WORKER_JOB_EXPORT_STATISTICS);
+			}
+			if(is_window_complete)
+			{
+				seeknode_welford_reset(&ctx->statistics);
+				ctx->statistics_window_start_ns = (uint64_t)arrival_ns;
+			}
+		}
+		stage_timing_add(&ctx->statistics_timing, start_ns);
+	}
+
+	// Replace the bad pixels in place before any other stage sees them.
+	// The map is loaded (or learning starts) on the first frame, once the frame geometry is known.
+	bool is_modified = false;
+	if(ctx->bad_pixels_mode != BAD_PIXELS_MODE_OFF)
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		seeknode_badpixel_t* bad_pixels = &ctx->bad_pixels;
+		if(!ctx->is_bad_pixels_configured)
+		{
+			const std::string path = get_bad_pixels_path(cid);
+			seeknode_badpixel_configure(bad_pixels, width, height);
+			if(ctx->bad_pixels_mode != BAD_PIXELS_MODE_RELEARN && seeknode_badpixel_load(bad_pixels, path.c_str()))
+			{
+				fprintf(stdout, "loaded bad pixel map: %s (%s, count: %zu)\n", cid, path.c_str(), bad_pixels->bad.size());
+			}
+			else if(ctx->bad_pixels_mode == BAD_PIXELS_MODE_LOAD)
+			{
+				fprintf(stderr, "failed to load bad pixel map: %s (%s)\n", cid, path.c_str());
+			}
+			else
+			{
+				fprintf(stdout, "learning bad pixel map: %s (frames: %zu)\n", cid, bad_pixels->learn_frames);
+				seeknode_badpixel_start_learning(bad_pixels);
+			}
+			ctx->is_bad_pixels_configured = true;
+		}
+
+		// Learning needs the full sensor; the window is held there until it completes.
+		const bool is_full_frame = width == bad_pixels->width && height == bad_pixels->height;
+		if(seeknode_badpixel_is_learning(bad_pixels))
+		{
+			if(is_full_frame && seeknode_badpixel_learn(bad_pixels, pixels, stride))
+			{
+				const std::string path = get_bad_pixels_path(cid);
+				make_directories(g_bad_pixels_directory);
+				if(seeknode_badpixel_save(bad_pixels, path.c_str()))
+				{
+					fprintf(stdout, "saved bad pixel map: %s (%s, count: %zu)\n", cid, path.c_str(), bad_pixels->bad.size());
+				}
+				else
+				{
+					fprintf(stderr, "failed to save bad pixel map: %s (%s)\n", cid, path.c_str());
+				}
+			}
+		}
+		else if(!bad_pixels->bad.empty())
+		{
+			seeknode_badpixel_apply_window(bad_pixels, pixels, stride, origin_x, origin_y, width, height);
+			is_modified = true;
+		}
+		stage_timing_add(&ctx->bad_pixels_timing, start_ns);
+	}
+
+	// Filter the thermography in place in the SDK frame buffer.
+	// Every later stage and output sees the filtered values without an extra copy.
+	if(ctx->denoise.mode != SEEKNODE_DENOISE_MODE_OFF)
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		seeknode_denoise_configure(&ctx->denoise, width, height);
+		seeknode_denoise_process(&ctx->denoise, pixels, stride);
+		stage_timing_add(&ctx->denoise_timing, start_ns);
+		is_modified = true;
+	}
+
+	// The header extrema were computed by the SDK on the raw frame; a stuck pixel would otherwise remain the maximum.
+	if(is_modified)
+	{
+		seeknode_badpixel_update_header(header, pixels, stride, origin_x, origin_y, width, height);
+	}
+
+	// Estimate the fixed pattern non-uniformity while the camera looks at a uniform scene.
+	// When it exceeds the threshold (after warm-up and not too often), a flat scene correction is stored in the background.
+	if(g_fsc_auto && !ctx->is_fsc_running)
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		seeknode_nonuniformity_configure(&ctx->nonuniformity, width, height);
+		const bool has_estimate = seeknode_nonuniformity_process(
+			&ctx->nonuniformity,
+			pixels,
+			stride,
+			header->thermography_min_value,
+			header->thermography_max_value);
+		stage_timing_add(&ctx->nonuniformity_timing, start_ns);
+
+		const bool is_warm = arrival_ns - ctx->connect_ns >= (int64_t)(g_fsc_warmup * 1.0e9);
+		const bool is_due = ctx->last_fsc_ns == 0 || arrival_ns - ctx->last_fsc_ns >= (int64_t)(g_fsc_min_interval * 1.0e9);
+		if(has_estimate && is_warm && is_due && ctx->nonuniformity.estimate > g_fsc_threshold)
+		{
+			fprintf(stdout, "storing flat scene correction: %s (non-uniformity: %.3f degrees)\n", cid, ctx->nonuniformity.estimate);
+			ctx->is_fsc_running = true;
+			post_worker_job(ctx, WORKER_JOB_STORE_FSC);
+			seeknode_nonuniformity_reset(&ctx->nonuniformity);
+		}
+	}
+
+	std_msgs::Header& frame_header = ctx->frame_header;
+	frame_header.stamp = stamp;
+
+	// Skip publishing frames that barely differ from the last published one.
+	// Only the image is gated; the derived messages are small and keep their full rate.
+	const size_t image_step = width * sizeof(float);
+	bool do_publish_image = true;
+	if(ctx->is_gated)
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		seeknode_gate_configure(&ctx->gate, width, height);
+		do_publish_image = seeknode_gate_process(
+			&ctx->gate,
+			pixels,
+			stride,
+			header->thermography_min_value,
+			header->thermography_max_value,
+			arrival_ns,
+			image_step * height);
+		stage_timing_add(&ctx->gate_timing, start_ns);
+	}
+
+	// Publish the thermography image.
+	// The converter drops the line padding the SDK frame (or the window view) may carry.
+	if(do_publish_image)
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		sensor_msgs::Image& image = ctx->image_message;
+		image.header = frame_header;
+		image.width = (uint32_t)width;
+		image.height = (uint32_t)height;
+		image.encoding = seeknode_encoding_get_str(ctx->image_converter->encoding);
+		image.is_bigendian = 0;
+		image.step = (uint32_t)(width * ctx->image_converter->dst_pixel_size);
+		image.data.resize(image.step * height);
+		ctx->image_converter->convert(pixels, stride, image.data.data(), image.step, width, height, 0.0f, 0.0f);
+		publish_message(ctx->image_pub, image);
+		stage_timing_add(&ctx->publish_timing, start_ns);
+	}
+
+	// Write every frame to the shared memory ring, gated or not; it never waits on the readers.
+	// The segment is sized for the full sensor on the first frame so window changes fit.
+	// If it cannot be created, the camera writes nothing until its next connect tries again.
+	if(ctx->is_shm_enabled && !ctx->is_shm_failed)
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		if(!seeknode_shm_writer_is_open(&ctx->shm))
+		{
+			const std::string name = g_shm_prefix + cid;
+			const size_t max_data_size = ctx->window.sensor_width * ctx->window.sensor_height * sizeof(float);
+			if(!seeknode_shm_writer_open(&ctx->shm, name, cid, (size_t)std::max(g_shm_slots, 2), max_data_size))
+			{
+				fprintf(stderr, "failed to create shared memory: %s (%s)\n", name.c_str(), strerror(errno));
+				ctx->is_shm_failed = true;
+			}
+		}
+		if(seeknode_shm_writer_is_open(&ctx->shm))
+		{
+			const bool is_written = seeknode_shm_writer_publish(
+				&ctx->shm,
+				header,
+				(int64_t)stamp.toNSec(),
+				SEEKNODE_SHM_FORMAT_THERMOGRAPHY_FLOAT,
+				pixels,
+				stride,
+				width,
+				height,
+				sizeof(float),
+				origin_x,
+				origin_y);
+			if(!is_written)
+			{
+				seeknode_dropmon_add_drops(&ctx->drops, SEEKNODE_DROP_STAGE_WRITER, 1);
+			}
+		}
+		stage_timing_add(&ctx->shm_timing, start_ns);
+	}
+
+	// Hand the frame to the UDP sender thread; when it falls behind, the ring drops the oldest frame.
+	if(ctx->is_udp_enabled)
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		const size_t pixel_size = ctx->udp_converter->dst_pixel_size;
+		if(ctx->num_frames == 1)
+		{
+			// Size every slot for the full sensor now rather than on its first use.
+			seeknode_frame_ring_reserve(&ctx->udp_ring, ctx->window.sensor_width * ctx->window.sensor_height * pixel_size);
+		}
+		seeknode_frame_slot_t* slot = seeknode_frame_ring_acquire(&ctx->udp_ring, width * height * pixel_size);
+		if(slot != NULL)
+		{
+			slot->header = *header;
+			slot->encoding = ctx->udp_converter->encoding;
+			slot->width = width;
+			slot->height = height;
+			slot->stride = width * pixel_size;
+			ctx->udp_converter->convert(
+				pixels,
+				stride,
+				slot->data.data(),
+				slot->stride,
+				width,
+				height,
+				header->thermography_min_value,
+				header->thermography_max_value);
+			seeknode_dropmon_add_drops(&ctx->drops, SEEKNODE_DROP_STAGE_RING, seeknode_frame_ring_publish(&ctx->udp_ring, slot));
+		}
+		else
+		{
+			seeknode_dropmon_add_drops(&ctx->drops, SEEKNODE_DROP_STAGE_RING, 1);
+		}
+		stage_timing_add(&ctx->udp_timing, start_ns);
+	}
+
+	// Publish the rectified thermography image.
+	// The remap writes straight into the message buffer; the table is built on the first frame.
+	// A windowed frame is rectified as a camera whose principal point is shifted by the window origin.
+	if(do_publish_image && seeknode_undistort_model_is_valid(&ctx->calibration))
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		seeknode_camera_model_t model = ctx->calibration;
+		model.cx -= (double)origin_x;
+		model.cy -= (double)origin_y;
+		seeknode_undistort_configure(&ctx->undistort, &model, width, height);
+
+		sensor_msgs::Image& image = ctx->rect_message;
+		image.header = frame_header;
+		image.width = (uint32_t)width;
+		image.height = (uint32_t)height;
+		image.encoding = "32FC1";
+		image.is_bigendian = 0;
+		image.step = (uint32_t)image_step;
+		image.data.resize(image.step * height);
+		seeknode_undistort_remap_f32(
+			&ctx->undistort,
+			pixels,
+			stride,
+			(float*)image.data.data(),
+			image.step);
+		publish_message(ctx->rect_pub, image);
+		stage_timing_add(&ctx->rect_timing, start_ns);
+	}
+
+	// Publish the camera time alongside the corrected host stamp.
+	sensor_msgs::TimeReference& time_reference = ctx->time_reference_message;
+	time_reference.header = frame_header;
+	time_reference.time_ref.fromNSec(header->timestamp_utc_ns);
+	time_reference.source = cid;
+	publish_message(ctx->time_reference_pub, time_reference);
+
+	// Evaluate the regions of interest.
+	if(!ctx->roi.rois.empty())
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		seeknode_roi_engine_configure_window(&ctx->roi, origin_x, origin_y, width, height);
+		seeknode_roi_engine_process(&ctx->roi, pixels, stride);
+		stage_timing_add(&ctx->roi_timing, start_ns);
+
+		seek_package::RoiStats& roi_stats = ctx->roi_message;
+		roi_stats.header = frame_header;
+		roi_stats.fpa_frame_count = header->fpa_frame_count;
+		const size_t num_rois = ctx->roi.stats.size();
+		roi_stats.mean.resize(num_rois);
+		roi_stats.stddev.resize(num_rois);
+		roi_stats.min.resize(num_rois);
+		roi_stats.max.resize(num_rois);
+		roi_stats.area.resize(num_rois);
+		roi_stats.area_above.resize(num_rois);
+		for(size_t i = 0; i < num_rois; ++i)
+		{
+			const auto& stats = ctx->roi.stats[i];
+			roi_stats.mean[i] = stats.mean;
+			roi_stats.stddev[i] = stats.stddev;
+			roi_stats.min[i] = stats.min;
+			roi_stats.max[i] = stats.max;
+			roi_stats.area[i] = stats.area;
+			roi_stats.area_above[i] = stats.area_above;
+		}
+		publish_message(ctx->roi_pub, roi_stats);
+	}
+
+	// Detect the hot spots.
+	if(!isnan(ctx->blobs.threshold))
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		seeknode_blob_detector_configure(&ctx->blobs, width, height);
+		seeknode_blob_detector_process(&ctx->blobs, pixels, stride);
+		stage_timing_add(&ctx->blobs_timing, start_ns);
+
+		seek_package::Blobs& blobs = ctx->blobs_message;
+		blobs.header = frame_header;
+		blobs.fpa_frame_count = header->fpa_frame_count;
+		blobs.threshold = ctx->blobs.threshold;
+		blobs.blobs.resize(ctx->blobs.blobs.size());
+		for(size_t i = 0; i < ctx->blobs.blobs.size(); ++i)
+		{
+			const seeknode_blob_t& src = ctx->blobs.blobs[i];
+			seek_package::Blob& dst = blobs.blobs[i];
+			dst.area = src.area;
+			dst.centroid_x = src.centroid_x;
+			dst.centroid_y = src.centroid_y;
+			dst.bbox_x = src.bbox_x;
+			dst.bbox_y = src.bbox_y;
+			dst.bbox_width = src.bbox_width;
+			dst.bbox_height = src.bbox_height;
+			dst.peak_x = src.peak_x;
+			dst.peak_y = src.peak_y;
+			dst.peak_value = src.peak_value;
+			dst.mean_value = src.mean_value;
+		}
+		publish_message(ctx->blobs_pub, blobs);
+	}
+
+	// Refresh the tile of this camera in the monitoring composite.
+	// The fixed range applies when both ends are set; otherwise each tile is stretched to its own min/max.
+	if(g_composite_enabled && ctx->composite_generation != g_composite_generation.load(std::memory_order_relaxed))
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		const bool is_fixed_range = !isnan(g_composite_min) && !isnan(g_composite_max);
+		std::lock_guard<std::mutex> lock(g_composite_mutex);
+		seeknode_composite_write_tile(
+			&g_composite,
+			g_composite_image.data.data(),
+			g_composite_image.step,
+			(size_t)(ctx - g_ctx_pool),
+			pixels,
+			width,
+			height,
+			stride,
+			is_fixed_range ? g_composite_min : header->thermography_min_value,
+			is_fixed_range ? g_composite_max : header->thermography_max_value);
+		ctx->composite_generation = g_composite_generation.load(std::memory_order_relaxed);
+		stage_timing_add(&ctx->composite_timing, start_ns);
+	}
+
+	// Evaluate the alarm rules.
+	// Rules are checked against the header extrema first; regions are only scanned when a rule may change state.
+	if(!ctx->alarms.rules.empty())
+	{
+		const int64_t start_ns = seeknode_clock_monotonic_ns();
+		seeknode_alarm_engine_configure_window(&ctx->alarms, origin_x, origin_y, width, height);
+		const bool has_events = seeknode_alarm_engine_process(
+			&ctx->alarms,
+			pixels,
+			stride,
+			header->thermography_min_value,
+			header->thermography_max_value,
+			(int64_t)header->timestamp_utc_ns);
+		stage_timing_add(&ctx->alarms_timing, start_ns);
+
+		for(size_t i = 0; has_events && i < ctx->alarms.events.size(); ++i)
+		{
+			const seeknode_alarm_event_t& event = ctx->alarms.events[i];
+			const seeknode_alarm_rule_t& rule = ctx->alarms.rules[event.rule];
+			seek_package::AlarmEvent& message = ctx->alarm_message;
+			message.header = frame_header;
+			message.timestamp_utc_ns = header->timestamp_utc_ns;
+			message.fpa_frame_count = header->fpa_frame_count;
+			message.rule = rule.name;
+			message.type = seeknode_alarm_type_get_str(rule.type);
+			message.active = event.is_active;
+			message.value = event.value;
+			message.threshold = rule.threshold;
+			message.x = (uint16_t)(event.x + origin_x);
+			message.y = (uint16_t)(event.y + origin_y);
+			publish_message(ctx->alarms_pub, message);
+
+			fprintf(stdout, "alarm %s: %s (%s, value: %.2f)\n", event.is_active ? "raised" : "cleared", cid, rule.name.c_str(), event.value);
+		}
+
+		if(seeknode_alarm_engine_is_recording(&ctx->alarms))
+		{
+			ctx->record_until_ns = arrival_ns + (int64_t)(g_record_post_alarm * 1.0e9);
+		}
+	}
+
+	report_camera(ctx, cid, arrival_ns);
+
+	// In alarm recording mode, frames are only logged while a recording alarm is active and shortly after.
+	if(g_record_on_alarm && arrival_ns > ctx->record_until_ns)
+	{
 		return;
 	}
 
-	const size_t width = seekframe_get_width(frame);
-	const size_t height = seekframe_get_height(frame);
-
-	fprintf(stdout, "frame available: %s (size: %zux%zu)\n", cid, width, height);
-
 	// Log each header value to the CSV file.
 	// See the documentation for a description of the header.
-	seekcamera_frame_header_t* header = (seekcamera_frame_header_t*)seekframe_get_header(frame);
+	const int64_t record_start_ns = seeknode_clock_monotonic_ns();
+	const long log_start = ftell(ctx->log);
 
 	size_t count = 0;
 
@@ -225,14 +1926,206 @@ void frame_available_callback(seekcamera_t* camera, seekcamera_frame_t* camera_f
 	// See the documentation for a description of the frame layout.
 	for(size_t y = 0; y < height; ++y)
 	{
-		float* pixels = (float*)seekframe_get_row(frame, y);
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride);
 		for(size_t x = 0; x < width; ++x)
 		{
-			const float temperature_degrees_c = pixels[x];
+			const float temperature_degrees_c = row[x];
 			fprintf(ctx->log, "%.1f,", temperature_degrees_c);
 		}
 		fputc('\n', ctx->log);
 	}
+
+	const long log_end = ftell(ctx->log);
+	seeknode_metric_add(metrics->recorded_frames, 1);
+	if(log_start >= 0 && log_end > log_start)
+	{
+		seeknode_metric_add(metrics->recorded_bytes, (uint64_t)(log_end - log_start));
+	}
+	stage_timing_add(&ctx->record_timing, record_start_ns);
+}
+
+// Sends the frames queued by the frame callback until the ring is closed.
+static void udp_sender_thread(samplectx_t* ctx, std::string cid)
+{
+	camera_metrics_t* metrics = &ctx->cache->metrics;
+	int64_t report_ns = seeknode_clock_monotonic_ns();
+	SEEKNODE_TRACE_THREAD_NAME("udp " + cid);
+	SEEKNODE_TRACE_CAMERA(cid.c_str());
+	for(;;)
+	{
+		seeknode_alloc_track_thread(seeknode_clock_monotonic_ns() - ctx->connect_ns >= g_alloc_warmup_ns);
+		seeknode_frame_handle_t frame = seeknode_frame_ring_pop_handle(&ctx->udp_ring, 100000000LL);
+		if(!frame)
+		{
+			if(seeknode_frame_ring_is_closed(&ctx->udp_ring))
+			{
+				break;
+			}
+			continue;
+		}
+
+		size_t queue_depth = 0;
+		{
+			std::lock_guard<std::mutex> lock(ctx->udp_ring.mutex);
+			queue_depth = ctx->udp_ring.num_ready;
+		}
+		seeknode_metric_set(metrics->udp_queue_depth, (double)queue_depth);
+
+		seeknode_udp_frame_info_t info;
+		info.format = ctx->udp_format;
+		info.width = frame->width;
+		info.height = frame->height;
+		info.fpa_frame_count = frame->header.fpa_frame_count;
+		info.timestamp_utc_ns = frame->header.timestamp_utc_ns;
+		info.min_value = frame->header.thermography_min_value;
+		info.max_value = frame->header.thermography_max_value;
+		const uint64_t num_errors = ctx->udp.num_errors;
+		const uint64_t num_bytes = ctx->udp.num_bytes;
+		bool is_sent = false;
+		{
+			SEEKNODE_TRACE_SCOPE("udp_send");
+			is_sent = seeknode_udp_sender_send(&ctx->udp, &info, frame->data.data(), frame->stride * frame->height);
+		}
+		if(!is_sent || ctx->udp.num_errors != num_errors)
+		{
+			seeknode_dropmon_add_drops(&ctx->drops, SEEKNODE_DROP_STAGE_WRITER, 1);
+		}
+		else
+		{
+			seeknode_metric_add(metrics->udp_frames, 1);
+		}
+		seeknode_metric_add(metrics->udp_bytes, ctx->udp.num_bytes - num_bytes);
+		frame.reset();
+
+		const int64_t now_ns = seeknode_clock_monotonic_ns();
+		if(now_ns - report_ns >= (int64_t)(g_report_period * 1.0e9))
+		{
+			report_ns = now_ns;
+			uint64_t num_queue_drops = 0;
+			{
+				std::lock_guard<std::mutex> lock(ctx->udp_ring.mutex);
+				num_queue_drops = ctx->udp_ring.num_dropped + ctx->udp_ring.num_exhausted;
+			}
+			fprintf(stdout, "udp stream: %s (frames: %llu, queue drops: %llu, packets: %llu, errors: %llu, %.1f MB)\n",
+				cid.c_str(),
+				(unsigned long long)ctx->udp.num_frames,
+				(unsigned long long)num_queue_drops,
+				(unsigned long long)ctx->udp.num_packets,
+				(unsigned long long)ctx->udp.num_errors,
+				ctx->udp.num_bytes * 1.0e-6);
+		}
+	}
+}
+
+// Applies the cached settings of a camera whose capture session just started.
+// The first session of a chip records the core defaults and resolves the configuration from the parameters; every
+// later session (restart or reconnect) only sets what differs from the defaults, without querying the camera.
+static void apply_settings(samplectx_t* ctx, const char* cid)
+{
+	camera_cache_t* cache = ctx->cache;
+	if(!cache->has_defaults)
+	{
+		seeknode_settings_init(&cache->defaults);
+		const uint32_t unread = seeknode_settings_read(ctx->camera, &cache->defaults);
+		if(unread != 0)
+		{
+			fprintf(stderr, "failed to read camera settings: %s (count: %zu)\n", cid, seeknode_settings_count(unread));
+		}
+		cache->applied = cache->defaults;
+		load_settings(cid, &cache->applied);
+		cache->has_defaults = true;
+	}
+
+	const uint32_t changed = seeknode_settings_diff(&cache->applied, &cache->defaults);
+	const uint32_t failed = seeknode_settings_apply(ctx->camera, &cache->applied, changed);
+	if(failed != 0)
+	{
+		fprintf(stderr, "failed to apply camera settings: %s (count: %zu)\n", cid, seeknode_settings_count(failed));
+	}
+	if(changed != 0)
+	{
+		fprintf(stdout, "applied camera settings: %s (count: %zu)\n", cid, seeknode_settings_count(changed & ~failed));
+	}
+
+	ctx->is_shutter_scheduled = cache->applied.shutter_mode == SEEKCAMERA_SHUTTER_MODE_MANUAL && (failed & SEEKNODE_SETTING_SHUTTER_MODE) == 0;
+	if(g_shutter_scheduled && !ctx->is_shutter_scheduled)
+	{
+		fprintf(stderr, "failed to set manual shutter mode: %s\n", cid);
+	}
+}
+
+// Number of attempts to restart a capture session before the camera is left for a reconnect.
+static const int NUM_RESTART_ATTEMPTS = 3;
+
+// Delay before the first retry of a failed restart; later retries wait proportionally longer.
+static const int64_t RESTART_RETRY_DELAY_MS = 500;
+
+// Restarts the capture session of a camera and brings it back to its configuration.
+// The thermography window is owned by the window controller and restored from its current state.
+// The camera only goes live once both are restored: the frame callback drops frames until then, so it never reads the
+// shutter schedule or the window while they are written here.
+// A failed attempt is retried on the bring-up queue under the camera key, so a disconnect drops the retry as well.
+// The retry waits in the queue, not on a bring-up thread, so it neither holds a thread nor delays the disconnect.
+static void restart_capture_session(samplectx_t* ctx, const char* cid, int attempt)
+{
+	SEEKNODE_TRACE_SCOPE("restart");
+	ctx->session_start_ns = seeknode_clock_monotonic_ns();
+	if(attempt == 0)
+	{
+		ctx->is_restart = true;
+		++ctx->num_restarts;
+		seeknode_metric_add(ctx->cache->metrics.restarts, 1);
+	}
+
+	if(ctx->is_live)
+	{
+		ctx->is_live = false;
+		SEEKNODE_TRACE_SCOPE("capture_session_stop");
+		seekcamera_capture_session_stop(ctx->camera);
+	}
+
+	seekcamera_error_t status = SEEKCAMERA_SUCCESS;
+	{
+		SEEKNODE_TRACE_SCOPE("capture_session_start");
+		status = seekcamera_capture_session_start(ctx->camera, SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT);
+	}
+	if(status != SEEKCAMERA_SUCCESS)
+	{
+		fprintf(stderr, "failed to restart capture session: %s (%s, attempt %d of %d)\n",
+			cid,
+			seekcamera_error_get_str(status),
+			attempt + 1,
+			NUM_RESTART_ATTEMPTS);
+		count_sdk_error(cid, status);
+		seeknode_metric_set(ctx->cache->metrics.connected, 0.0);
+		ctx->session_start_ns = 0;
+		if(attempt + 1 < NUM_RESTART_ATTEMPTS)
+		{
+			const std::string chipid = cid;
+			seeknode_workqueue_submit_delayed(&g_bringup, ctx->camera, RESTART_RETRY_DELAY_MS * (attempt + 1), [=]() {
+				restart_capture_session(ctx, chipid.c_str(), attempt + 1);
+			});
+		}
+		else
+		{
+			fprintf(stderr, "gave up restarting capture session: %s (waiting for a reconnect)\n", cid);
+		}
+		return;
+	}
+	fprintf(stdout, "restarted capture session: %s\n", cid);
+
+	apply_settings(ctx, cid);
+	if(ctx->is_windowed && ctx->window.sensor_width > 0 && !seeknode_window_is_full(&ctx->window))
+	{
+		const seeknode_window_t* window = &ctx->window;
+		if(seekcamera_set_thermography_window(ctx->camera, window->x, window->y, window->width, window->height) != SEEKCAMERA_SUCCESS)
+		{
+			fprintf(stderr, "failed to restore thermography window: %s\n", cid);
+		}
+	}
+
+	ctx->is_live = true;
+	seeknode_metric_set(ctx->cache->metrics.connected, 1.0);
 }
 
 // Handles camera connect events.
@@ -241,14 +2134,23 @@ void handle_camera_connect(seekcamera_t* camera, seekcamera_error_t event_status
 	(void)event_status;
 	(void)user_data;
 
+	const int64_t bringup_start_ns = seeknode_clock_monotonic_ns();
+	SEEKNODE_TRACE_SCOPE("connect");
+
 	// Each camera is associated with an application level context structure.
 	// On each connect, the available context resource pool is searched to find a free context.
+	// Connects run in parallel on the bring-up threads, so the context is claimed, camera included, under the pool lock.
 	samplectx_t* ctx = NULL;
-	for(int i = 0; i < NUM_MAX_DEVICES && (ctx == NULL); ++i)
 	{
-		if(g_ctx_pool[i].is_free)
+		std::lock_guard<std::mutex> lock(g_ctx_pool_mutex);
+		for(int i = 0; i < NUM_MAX_DEVICES && (ctx == NULL); ++i)
 		{
-			ctx = &(g_ctx_pool[i]);
+			if(g_ctx_pool[i].is_free)
+			{
+				ctx = &(g_ctx_pool[i]);
+				ctx->is_free = false;
+				ctx->camera = camera;
+			}
 		}
 	}
 
@@ -263,12 +2165,176 @@ void handle_camera_connect(seekcamera_t* camera, seekcamera_error_t event_status
 
 	seekcamera_chipid_t cid;
 	seekcamera_get_chipid(camera, &cid);
+	SEEKNODE_TRACE_CAMERA(cid);
+
+	// Query the device metadata on the first connect of a chip; reconnects use the cached values.
+	// The queries run without the cache lock; the entry is filled under it for the metrics timer.
+	camera_cache_t* cache = get_camera_cache(cid);
+	if(!cache->has_device_info)
+	{
+		seekcamera_serial_number_t serial_number;
+		seekcamera_core_part_number_t core_part_number;
+		seekcamera_firmware_version_t firmware_version;
+		seekcamera_io_type_t io_type;
+		const bool has_device_info =
+			seekcamera_get_serial_number(camera, &serial_number) == SEEKCAMERA_SUCCESS &&
+			seekcamera_get_core_part_number(camera, &core_part_number) == SEEKCAMERA_SUCCESS &&
+			seekcamera_get_firmware_version(camera, &firmware_version) == SEEKCAMERA_SUCCESS &&
+			seekcamera_get_io_type(camera, &io_type) == SEEKCAMERA_SUCCESS;
+		if(has_device_info)
+		{
+			std::lock_guard<std::mutex> lock(g_camera_cache_mutex);
+			memcpy(cache->serial_number, serial_number, sizeof(serial_number));
+			memcpy(cache->core_part_number, core_part_number, sizeof(core_part_number));
+			cache->firmware_version = firmware_version;
+			cache->io_type = io_type;
+			cache->has_device_info = true;
+		}
+		else
+		{
+			fprintf(stderr, "failed to get device info: %s\n", cid);
+		}
+	}
+	if(cache->has_device_info)
+	{
+		fprintf(stdout, "device info: %s (sn: %s, cpn: %s, firmware: %u.%u.%u.%u, io: %s)\n",
+			cid,
+			cache->serial_number,
+			cache->core_part_number,
+			cache->firmware_version.product,
+			cache->firmware_version.variant,
+			cache->firmware_version.major,
+			cache->firmware_version.minor,
+			cache->io_type == SEEKCAMERA_IO_TYPE_SPI ? "spi" : "usb");
+	}
 
 	// Reset the context values to be assocated with this camera.
-	ctx->is_free = false;
 	ctx->is_live = false;
 	ctx->log = NULL;
-	ctx->camera = camera;
+	ctx->cache = cache;
+	ctx->clock = g_clock_options;
+	ctx->last_report_ns = 0;
+	stage_timing_init(&ctx->roi_timing, cid, "roi");
+	ctx->blobs = g_blob_options;
+	stage_timing_init(&ctx->blobs_timing, cid, "blobs");
+	ctx->is_gated = g_gate_enabled;
+	ctx->gate = g_gate_options;
+	stage_timing_init(&ctx->gate_timing, cid, "gate");
+	stage_timing_init(&ctx->denoise_timing, cid, "denoise");
+	stage_timing_init(&ctx->bad_pixels_timing, cid, "bad_pixels");
+	stage_timing_init(&ctx->rect_timing, cid, "rectify");
+	ctx->composite_generation = UINT64_MAX;
+	stage_timing_init(&ctx->composite_timing, cid, "composite");
+	seeknode_welford_init(&ctx->statistics);
+	ctx->statistics.batch_frames = (size_t)g_statistics_batch_frames;
+	ctx->statistics_frame_count = 0;
+	ctx->statistics_window_start_ns = (uint64_t)seeknode_clock_monotonic_ns();
+	ctx->is_statistics_export_requested = false;
+	ctx->is_statistics_exporting = false;
+	stage_timing_init(&ctx->statistics_timing, cid, "statistics");
+	ctx->nonuniformity = g_nonuniformity_options;
+	ctx->connect_ns = seeknode_clock_monotonic_ns();
+	ctx->last_fsc_ns = 0;
+	ctx->is_fsc_running = false;
+	if(!ctx->worker_thread.joinable())
+	{
+		ctx->worker_thread = std::thread(background_worker_thread, ctx);
+	}
+	stage_timing_init(&ctx->nonuniformity_timing, cid, "nonuniformity");
+	ctx->record_until_ns = 0;
+	stage_timing_init(&ctx->alarms_timing, cid, "alarms");
+	ctx->is_shutter_scheduled = false;
+	ctx->shutter = g_shutter_options;
+	ctx->is_windowed = g_window_auto;
+	ctx->window = g_window_options;
+	ctx->previous_window = g_window_options;
+	ctx->is_window_change_pending = false;
+	ctx->frame_origin_x = 0;
+	ctx->frame_origin_y = 0;
+	ctx->crop_requests.clear();
+	ctx->num_frames = 0;
+	ctx->cpu_report_ns = 0;
+	ctx->cpu_report_frames = 0;
+	ctx->cpu_metrics_ns = 0;
+	ctx->session_start_ns = seeknode_clock_monotonic_ns();
+	ctx->is_restart = false;
+	ctx->num_restarts = 0;
+	ctx->max_first_frame_ns = 0;
+	ctx->is_shm_enabled = g_shm_enabled;
+	ctx->is_shm_failed = false;
+	stage_timing_init(&ctx->shm_timing, cid, "shm");
+	ctx->is_udp_enabled = false;
+	stage_timing_init(&ctx->udp_timing, cid, "udp");
+	stage_timing_init(&ctx->publish_timing, cid, "publish");
+	stage_timing_init(&ctx->record_timing, cid, "record");
+	seeknode_dropmon_init(&ctx->drops);
+	ctx->drops.stall_timeout_ns = (int64_t)(g_drops_stall_timeout * 1.0e9);
+
+	// The camera clock may have restarted since the last connect.
+	seeknode_clock_reset(&ctx->clock);
+	ctx->frame_header.frame_id = g_frame_id_prefix + cid;
+	ctx->image_converter = seeknode_converter_find(SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT, SEEKNODE_ENCODING_32FC1);
+
+	// Each camera publishes on topics namespaced by its chip id.
+	// Advertising before the capture session starts guarantees the publishers are valid in the frame callback.
+	const std::string topic_prefix = std::string(cid) + "/";
+	ctx->image_pub = g_node->advertise<sensor_msgs::Image>(topic_prefix + "thermography", 1);
+	ctx->time_reference_pub = g_node->advertise<sensor_msgs::TimeReference>(topic_prefix + "time_reference", 10);
+	ctx->drops_pub = g_node->advertise<seek_package::FrameDrop>(topic_prefix + "frame_drops", 10);
+
+	load_bad_pixels(cid, ctx);
+	load_denoise(cid, &ctx->denoise);
+	load_rois(cid, &ctx->roi);
+	load_calibration(cid, &ctx->calibration);
+	load_alarms(cid, &ctx->alarms);
+	if(!ctx->alarms.rules.empty())
+	{
+		ctx->alarms_pub = g_node->advertise<seek_package::AlarmEvent>(topic_prefix + "alarms", 10);
+	}
+	seeknode_undistort_init(&ctx->undistort);
+	if(seeknode_undistort_model_is_valid(&ctx->calibration))
+	{
+		ctx->rect_pub = g_node->advertise<sensor_msgs::Image>(topic_prefix + "thermography_rect", 1);
+	}
+	if(!ctx->roi.rois.empty())
+	{
+		ctx->roi_pub = g_node->advertise<seek_package::RoiStats>(topic_prefix + "roi_stats", 10);
+	}
+	if(!isnan(ctx->blobs.threshold))
+	{
+		ctx->blobs_pub = g_node->advertise<seek_package::Blobs>(topic_prefix + "blobs", 10);
+	}
+	if(ctx->is_windowed)
+	{
+		ctx->window_pub = g_node->advertise<sensor_msgs::RegionOfInterest>(topic_prefix + "thermography_window", 1, true);
+		ctx->crop_sub = g_node->subscribe<sensor_msgs::RegionOfInterest>(
+			topic_prefix + "crop",
+			10,
+			[ctx](const sensor_msgs::RegionOfInterestConstPtr& message) { crop_callback(ctx, message); });
+	}
+
+	// Stream over UDP from a thread of its own so a slow link never delays the frame callback.
+	if(g_udp_enabled)
+	{
+		const size_t slot_index = (size_t)(ctx - g_ctx_pool);
+		ctx->udp = g_udp_options;
+		ctx->udp_format = g_udp_format;
+		ctx->udp_converter = seeknode_converter_find(
+			SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT,
+			ctx->udp_format == SEEKNODE_UDP_FORMAT_MONO8 ? SEEKNODE_ENCODING_MONO8 : SEEKNODE_ENCODING_32FC1);
+		if(seeknode_udp_sender_open(&ctx->udp, g_udp_host, (uint16_t)(g_udp_port + slot_index)))
+		{
+			fprintf(stdout, "udp stream: %s (%s:%d)\n", cid, g_udp_host.c_str(), g_udp_port + (int)slot_index);
+			const size_t depth = (size_t)std::max(g_udp_queue_depth, 1);
+			seeknode_frame_ring_init(&ctx->udp_ring, depth + 2, depth);
+			ctx->is_udp_enabled = true;
+			ctx->udp_thread = std::thread(udp_sender_thread, ctx, std::string(cid));
+		}
+		else
+		{
+			fprintf(stderr, "failed to open udp stream: %s (%s:%d)\n", cid, g_udp_host.c_str(), g_udp_port + (int)slot_index);
+		}
+	}
 
 	// The Seek camera API is asynchronous and event driven.
 	// Frames are delivered to a unique callback function which is registered on a per camera basis.
@@ -293,17 +2359,23 @@ void handle_camera_connect(seekcamera_t* camera, seekcamera_error_t event_status
 	// Several types of output imagery are configurable.
 	// This sample application only outputs thermography values as single precision floating point values.
 	const uint32_t frame_format = SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT;
-	status = seekcamera_capture_session_start(camera, frame_format);
+	{
+		SEEKNODE_TRACE_SCOPE("capture_session_start");
+		status = seekcamera_capture_session_start(camera, frame_format);
+	}
 
-	if(status == SEEKCAMERA_SUCCESS)
+	const bool is_started = status == SEEKCAMERA_SUCCESS;
+	if(is_started)
 	{
 		fprintf(stdout, "started capture session: %s\n", cid);
-		ctx->is_live = true;
+
+		// Bring the camera to its configuration (e.g. take over the shutter from the core).
+		apply_settings(ctx, cid);
 	}
 	else
 	{
 		fprintf(stderr, "failed to start capture session: %s (%s)\n", cid, seekcamera_error_get_str(status));
-		ctx->is_live = false;
+		count_sdk_error(cid, status);
 	}
 
 	// Create the thermography log file.
@@ -321,6 +2393,15 @@ void handle_camera_connect(seekcamera_t* camera, seekcamera_error_t event_status
 	{
 		fprintf(stderr, "failed to open log file: %s\n", cid);
 	}
+
+	// Frames are dropped until the camera is live, so the frame callback only sees the context once it is complete.
+	if(is_started)
+	{
+		ctx->is_live = true;
+		seeknode_metric_set(cache->metrics.connected, 1.0);
+	}
+
+	fprintf(stdout, "brought up camera: %s (%.1f ms)\n", cid, (seeknode_clock_monotonic_ns() - bringup_start_ns) * 1.0e-6);
 }
 
 // Handles camera disconnect events.
@@ -328,24 +2409,29 @@ void handle_camera_disconnect(seekcamera_t* camera, seekcamera_error_t event_sta
 {
 	(void)event_status;
 	(void)user_data;
+	SEEKNODE_TRACE_SCOPE("disconnect");
 
 	// Search for the resource pool for the context associated with the camera.
 	// The context and camera can be uniquely associated using chip id.
+	// Other cameras may be claiming contexts on the bring-up threads meanwhile, so the pool is searched under its lock.
 	samplectx_t* ctx = NULL;
-	for(int i = 0; i < NUM_MAX_DEVICES && (ctx == NULL); ++i)
 	{
-		samplectx_t* candidate_ctx = &(g_ctx_pool[i]);
-		if(candidate_ctx->camera != NULL)
-		{
-			seekcamera_chipid_t cid;
-			seekcamera_get_chipid(camera, &cid);
+		seekcamera_chipid_t cid;
+		seekcamera_get_chipid(camera, &cid);
 
-			seekcamera_chipid_t candidate_cid;
-			seekcamera_get_chipid(candidate_ctx->camera, &candidate_cid);
-
-			if(strcmp(cid, candidate_cid) == 0)
+		std::lock_guard<std::mutex> lock(g_ctx_pool_mutex);
+		for(int i = 0; i < NUM_MAX_DEVICES && (ctx == NULL); ++i)
+		{
+			samplectx_t* candidate_ctx = &(g_ctx_pool[i]);
+			if(!candidate_ctx->is_free && candidate_ctx->camera != NULL)
 			{
-				ctx = candidate_ctx;
+				seekcamera_chipid_t candidate_cid;
+				seekcamera_get_chipid(candidate_ctx->camera, &candidate_cid);
+
+				if(strcmp(cid, candidate_cid) == 0)
+				{
+					ctx = candidate_ctx;
+				}
 			}
 		}
 	}
@@ -362,9 +2448,13 @@ void handle_camera_disconnect(seekcamera_t* camera, seekcamera_error_t event_sta
 	// Care should be taken to synchronize any state depending on the camera.
 	if(ctx->is_live)
 	{
+		SEEKNODE_TRACE_SCOPE("capture_session_stop");
 		seekcamera_capture_session_stop(camera);
 	}
 
+	// Wait for a pending statistics export or flat scene correction store; both use the camera handle.
+	wait_for_worker(ctx);
+
 	// Close the log.
 	if(ctx->log != NULL)
 	{
@@ -372,20 +2462,291 @@ void handle_camera_disconnect(seekcamera_t* camera, seekcamera_error_t event_sta
 		ctx->log = NULL;
 	}
 
+	// Stop publishing.
+	ctx->image_pub.shutdown();
+	ctx->time_reference_pub.shutdown();
+	ctx->roi_pub.shutdown();
+	ctx->blobs_pub.shutdown();
+	ctx->rect_pub.shutdown();
+	ctx->alarms_pub.shutdown();
+	ctx->window_pub.shutdown();
+	ctx->crop_sub.shutdown();
+
+	// Readers of the shared memory ring see it closed and reopen it if the camera comes back.
+	seeknode_shm_writer_close(&ctx->shm);
+
+	// Stop the UDP sender once the frames in flight are abandoned.
+	if(ctx->is_udp_enabled)
+	{
+		seeknode_frame_ring_close(&ctx->udp_ring);
+		if(ctx->udp_thread.joinable())
+		{
+			ctx->udp_thread.join();
+		}
+		seeknode_udp_sender_close(&ctx->udp);
+		ctx->is_udp_enabled = false;
+	}
+
+	// Blank the tile so the composite does not keep showing a stale frame.
+	if(g_composite_enabled)
+	{
+		std::lock_guard<std::mutex> lock(g_composite_mutex);
+		seeknode_composite_clear_tile(&g_composite, g_composite_image.data.data(), g_composite_image.step, (size_t)(ctx - g_ctx_pool));
+	}
+
 	// Invalidate the tracked metadata.
+	// The drop watchdog publishes under the pool lock, so its publisher is shut down there.
+	seeknode_metric_set(ctx->cache->metrics.connected, 0.0);
+	std::lock_guard<std::mutex> lock(g_ctx_pool_mutex);
+	ctx->drops_pub.shutdown();
 	ctx->is_free = true;
 	ctx->is_live = false;
 	ctx->camera = NULL;
 }
 
+// Requests every connected camera to export its pixel statistics with its next frame.
+static bool export_statistics_callback(std_srvs::Trigger::Request& request, std_srvs::Trigger::Response& response)
+{
+	(void)request;
+
+	int count = 0;
+	std::lock_guard<std::mutex> lock(g_ctx_pool_mutex);
+	for(int i = 0; i < NUM_MAX_DEVICES; ++i)
+	{
+		if(!g_ctx_pool[i].is_free && g_ctx_pool[i].is_live)
+		{
+			g_ctx_pool[i].is_statistics_export_requested = true;
+			++count;
+		}
+	}
+
+	response.success = g_statistics_enabled && count > 0;
+	response.message = g_statistics_enabled ? "export requested for " + std::to_string(count) + " camera(s)" : "statistics are disabled";
+	return true;
+}
+
+// Writes the trace buffered so far to trace-<unix time>.json in the working directory.
+static bool dump_trace_callback(std_srvs::Trigger::Request& request, std_srvs::Trigger::Response& response)
+{
+	(void)request;
+
+#if SEEKNODE_TRACE
+	char filename[MAX_FILENAME_LENGTH] = { 0 };
+	snprintf(filename, MAX_FILENAME_LENGTH, "trace-%lld.json", (long long)time(NULL));
+	response.success = seeknode_trace_write_json(filename);
+	response.message = response.success ? filename : std::string("failed to write ") + filename;
+#else
+	response.success = false;
+	response.message = "tracing is compiled out";
+#endif
+	return true;
+}
+
+// Tracks the external busy signal used by the shutter scheduler.
+static void busy_callback(const std_msgs::BoolConstPtr& message)
+{
+	g_busy_ns = seeknode_clock_monotonic_ns();
+	g_is_busy = message->data != 0;
+}
+
+// Publishes the monitoring composite.
+static void composite_timer_callback(const ros::TimerEvent& event)
+{
+	(void)event;
+
+	{
+		std::lock_guard<std::mutex> lock(g_composite_mutex);
+		memcpy(g_composite_message.data.data(), g_composite_image.data.data(), g_composite_image.data.size());
+		++g_composite_generation;
+	}
+	g_composite_message.header.stamp = ros::Time::now();
+	g_composite_pub.publish(g_composite_message);
+}
+
+// Checks every camera for stalls and raises the frame losses collected since the last check.
+static void drops_timer_callback(const ros::TimerEvent& event)
+{
+	(void)event;
+
+	const int64_t now_ns = seeknode_clock_monotonic_ns();
+	std::lock_guard<std::mutex> lock(g_ctx_pool_mutex);
+	for(int i = 0; i < NUM_MAX_DEVICES; ++i)
+	{
+		samplectx_t* ctx = &g_ctx_pool[i];
+		if(ctx->is_free || !ctx->is_live || !ctx->drops_pub)
+		{
+			continue;
+		}
+
+		seekcamera_chipid_t cid;
+		seekcamera_get_chipid(ctx->camera, &cid);
+		seek_package::FrameDrop message;
+		message.header.stamp = ros::Time::now();
+		message.header.frame_id = g_frame_id_prefix + cid;
+		message.fpa_frame_count = ctx->drops.last_seen_fpa_frame_count;
+
+		const int64_t stall_ns = seeknode_dropmon_check_stall(&ctx->drops, now_ns);
+		if(stall_ns > 0)
+		{
+			fprintf(stderr, "stream stalled: %s (no frame for %.1f ms, fpa frame count: %u)\n", cid, stall_ns * 1.0e-6, message.fpa_frame_count);
+			message.stage = "stall";
+			message.count = 0;
+			message.duration = (float)(stall_ns * 1.0e-9);
+			ctx->drops_pub.publish(message);
+			seeknode_metric_add(ctx->cache->metrics.stalls, 1);
+		}
+
+		for(int stage = 0; stage < SEEKNODE_DROP_STAGE_COUNT; ++stage)
+		{
+			const uint64_t count = seeknode_dropmon_take_drops(&ctx->drops, (seeknode_drop_stage_t)stage);
+			if(count > 0)
+			{
+				seeknode_metric_add(ctx->cache->metrics.dropped[stage], count);
+				message.stage = seeknode_drop_stage_get_str((seeknode_drop_stage_t)stage);
+				message.count = count;
+				message.duration = 0.0f;
+				ctx->drops_pub.publish(message);
+			}
+		}
+	}
+}
+
+// Publishes the metrics of every camera seen since start on /diagnostics and writes the Prometheus text file.
+static void metrics_timer_callback(const ros::TimerEvent& event)
+{
+	(void)event;
+
+	const int64_t now_ns = seeknode_clock_monotonic_ns();
+	diagnostic_msgs::DiagnosticArray diagnostics;
+	diagnostics.header.stamp = ros::Time::now();
+	{
+		std::lock_guard<std::mutex> lock(g_camera_cache_mutex);
+		for(auto& entry : g_camera_cache)
+		{
+			camera_metrics_t* metrics = &entry.second.metrics;
+			if(metrics->frames == NULL)
+			{
+				continue;
+			}
+
+			const uint64_t frames = (uint64_t)seeknode_metric_read(metrics->frames);
+			double dropped = 0.0;
+			for(int stage = 0; stage < SEEKNODE_DROP_STAGE_COUNT; ++stage)
+			{
+				dropped += seeknode_metric_read(metrics->dropped[stage]);
+			}
+			const double elapsed = (now_ns - metrics->previous_ns) * 1.0e-9;
+			const double fps = elapsed > 0.0 ? (frames - metrics->previous_frames) / elapsed : 0.0;
+			const bool has_dropped = dropped > metrics->previous_dropped;
+			seeknode_metric_set(metrics->fps, fps);
+			metrics->previous_frames = frames;
+			metrics->previous_dropped = dropped;
+			metrics->previous_ns = now_ns;
+
+			diagnostic_msgs::DiagnosticStatus status;
+			status.name = "seek_node: " + entry.first;
+			status.hardware_id = entry.second.has_device_info ? std::string(entry.second.serial_number) : entry.first;
+			if(seeknode_metric_read(metrics->connected) == 0.0)
+			{
+				status.level = diagnostic_msgs::DiagnosticStatus::STALE;
+				status.message = "not streaming";
+			}
+			else if(fps == 0.0)
+			{
+				status.level = diagnostic_msgs::DiagnosticStatus::ERROR;
+				status.message = "no frames";
+			}
+			else if(has_dropped)
+			{
+				status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+				status.message = "frames dropped";
+			}
+			else
+			{
+				status.level = diagnostic_msgs::DiagnosticStatus::OK;
+				status.message = "streaming";
+			}
+			diagnostics.status.push_back(status);
+		}
+	}
+
+	if(g_allocations_metric != NULL)
+	{
+		seeknode_metric_set(g_allocations_metric, (double)seeknode_alloc_get_count());
+	}
+
+	// Every metric labeled with a camera becomes a value of its status, keyed by name and other labels.
+	std::vector<seeknode_metric_sample_t> samples;
+	seeknode_metrics_snapshot(&g_metrics, &samples);
+	for(auto& status : diagnostics.status)
+	{
+		const std::string cid = status.name.substr(strlen("seek_node: "));
+		for(const auto& sample : samples)
+		{
+			if(seeknode_metric_get_label(sample.metric, "camera") != cid)
+			{
+				continue;
+			}
+
+			diagnostic_msgs::KeyValue value;
+			value.key = sample.metric->name;
+			for(const auto& label : sample.metric->labels)
+			{
+				if(label.first != "camera")
+				{
+					value.key += "/" + label.second;
+				}
+			}
+			char text[32];
+			snprintf(text, sizeof(text), "%.6g", sample.value);
+			value.value = text;
+			status.values.push_back(value);
+		}
+	}
+	g_diagnostics_pub.publish(diagnostics);
+
+	if(!g_metrics_textfile.empty() && !seeknode_metrics_write_prometheus(&g_metrics, g_metrics_textfile))
+	{
+		fprintf(stderr, "failed to write metrics: %s\n", g_metrics_textfile.c_str());
+	}
+}
+
 // Handles camera error events.
+// Communication errors are recovered by restarting the capture session with the cached settings.
 void handle_camera_error(seekcamera_t* camera, seekcamera_error_t event_status, void* user_data)
 {
 	(void)user_data;
 
 	seekcamera_chipid_t cid;
 	seekcamera_get_chipid(camera, &cid);
-	fprintf(stderr, "encountered unexpected error: %s (%s)", cid, seekcamera_error_get_str(event_status));
+	fprintf(stderr, "encountered unexpected error: %s (%s)\n", cid, seekcamera_error_get_str(event_status));
+	count_sdk_error(cid, event_status);
+	SEEKNODE_TRACE_CAMERA(cid);
+	SEEKNODE_TRACE_INSTANT("error");
+
+	if(event_status != SEEKCAMERA_ERROR_DEVICE_COMMUNICATION &&
+		event_status != SEEKCAMERA_ERROR_SENSOR_COMMUNICATION &&
+		event_status != SEEKCAMERA_ERROR_TIMEOUT)
+	{
+		return;
+	}
+
+	// The restart runs outside the pool lock; the context stays claimed because a disconnect first waits for this task.
+	samplectx_t* ctx = NULL;
+	{
+		std::lock_guard<std::mutex> lock(g_ctx_pool_mutex);
+		for(int i = 0; i < NUM_MAX_DEVICES && (ctx == NULL); ++i)
+		{
+			if(!g_ctx_pool[i].is_free && g_ctx_pool[i].camera == camera)
+			{
+				ctx = &g_ctx_pool[i];
+			}
+		}
+	}
+	if(ctx != NULL)
+	{
+		restart_capture_session(ctx, cid, 0);
+	}
 }
 
 // Callback function for the Seek camera manager.
@@ -396,17 +2757,22 @@ void camera_event_callback(seekcamera_t* camera, seekcamera_manager_event_t even
 	seekcamera_get_chipid(camera, &cid);
 
 	fprintf(stdout, "%s: %s\n", seekcamera_manager_get_event_str(event), cid);
+	SEEKNODE_TRACE_CAMERA(cid);
 
+	// Connects and errors are handed to the bring-up threads, in order for each camera.
+	// Disconnects are handled here: the camera is only valid during this callback, so its pending tasks are dropped
+	// and its running one waited for first.
 	switch(event)
 	{
 		case SEEKCAMERA_MANAGER_EVENT_CONNECT:
-			handle_camera_connect(camera, event_status, user_data);
+			seeknode_workqueue_submit(&g_bringup, camera, [=]() { handle_camera_connect(camera, event_status, user_data); });
 			break;
 		case SEEKCAMERA_MANAGER_EVENT_DISCONNECT:
+			seeknode_workqueue_cancel(&g_bringup, camera);
 			handle_camera_disconnect(camera, event_status, user_data);
 			break;
 		case SEEKCAMERA_MANAGER_EVENT_ERROR:
-			handle_camera_error(camera, event_status, user_data);
+			seeknode_workqueue_submit(&g_bringup, camera, [=]() { handle_camera_error(camera, event_status, user_data); });
 			break;
 		default:
 			break;
@@ -417,11 +2783,267 @@ void camera_event_callback(seekcamera_t* camera, seekcamera_manager_event_t even
 int main(int argc, char** argv)
 {
 	// Install signal handlers.
+	// The ROS handler is disabled so Ctrl+C goes through the same shutdown path as the standalone sample.
 	signal(SIGINT, signal_callback);
 	signal(SIGTERM, signal_callback);
+	ros::init(argc, argv, "seek_node", ros::init_options::NoSigintHandler);
+
+	ros::NodeHandle node("~");
+	g_node = &node;
+
+	// Clock estimator options.
+	seeknode_clock_init(&g_clock_options);
+	int clock_warmup_samples = (int)g_clock_options.warmup_samples;
+	int clock_latency_us = 0;
+	double clock_envelope_window = g_clock_options.envelope_window_ns * 1.0e-9;
+	node.param("frame_id_prefix", g_frame_id_prefix, g_frame_id_prefix);
+	node.param("clock/forgetting_factor", g_clock_options.forgetting_factor, g_clock_options.forgetting_factor);
+	node.param("clock/outlier_threshold", g_clock_options.outlier_threshold, g_clock_options.outlier_threshold);
+	node.param("clock/reset_threshold", g_clock_options.reset_threshold_s, g_clock_options.reset_threshold_s);
+	node.param("clock/warmup_samples", clock_warmup_samples, clock_warmup_samples);
+	node.param("clock/envelope_window", clock_envelope_window, clock_envelope_window);
+	node.param("clock/latency_us", clock_latency_us, clock_latency_us);
+	node.param("report_period", g_report_period, g_report_period);
+	g_clock_options.warmup_samples = (size_t)clock_warmup_samples;
+	g_clock_options.envelope_window_ns = (int64_t)(clock_envelope_window * 1.0e9);
+	g_clock_options.latency_ns = (int64_t)clock_latency_us * 1000;
+
+	// Hot spot detection options.
+	// Detection is disabled unless a threshold is given.
+	seeknode_blob_detector_init(&g_blob_options);
+	double blob_threshold = NAN;
+	int blob_min_area = (int)g_blob_options.min_area;
+	int blob_max_count = (int)g_blob_options.max_blobs;
+	int blob_connectivity = 8;
+	node.param("blobs/threshold", blob_threshold, blob_threshold);
+	node.param("blobs/min_area", blob_min_area, blob_min_area);
+	node.param("blobs/max_count", blob_max_count, blob_max_count);
+	node.param("blobs/connectivity", blob_connectivity, blob_connectivity);
+	g_blob_options.threshold = (float)blob_threshold;
+	g_blob_options.min_area = (uint32_t)blob_min_area;
+	g_blob_options.max_blobs = (size_t)blob_max_count;
+	g_blob_options.connectivity_8 = blob_connectivity != 4;
+
+	// Scene change gating options.
+	seeknode_gate_init(&g_gate_options);
+	double gate_threshold = g_gate_options.threshold;
+	double gate_extrema_threshold = g_gate_options.extrema_threshold;
+	int gate_row_step = (int)g_gate_options.row_step;
+	int gate_column_step = (int)g_gate_options.column_step;
+	double gate_heartbeat_period = g_gate_options.heartbeat_ns * 1.0e-9;
+	node.param("gate/enabled", g_gate_enabled, g_gate_enabled);
+	node.param("gate/threshold", gate_threshold, gate_threshold);
+	node.param("gate/extrema_threshold", gate_extrema_threshold, gate_extrema_threshold);
+	node.param("gate/row_step", gate_row_step, gate_row_step);
+	node.param("gate/column_step", gate_column_step, gate_column_step);
+	node.param("gate/heartbeat_period", gate_heartbeat_period, gate_heartbeat_period);
+	g_gate_options.threshold = (float)gate_threshold;
+	g_gate_options.extrema_threshold = (float)gate_extrema_threshold;
+	g_gate_options.row_step = (size_t)gate_row_step;
+	g_gate_options.column_step = (size_t)gate_column_step;
+	g_gate_options.heartbeat_ns = (int64_t)(gate_heartbeat_period * 1.0e9);
+
+	// Bad pixel maps are saved per chip id in this directory.
+	const char* home = getenv("HOME");
+	g_bad_pixels_directory = std::string(home != NULL ? home : ".") + "/.ros/seek_package";
+	node.param("bad_pixels/directory", g_bad_pixels_directory, g_bad_pixels_directory);
+
+	// Monitoring composite options.
+	// The composite image is allocated once; cameras write their tiles straight into it.
+	int composite_tiles = 9;
+	int composite_columns = 0;
+	int composite_tile_width = 320;
+	int composite_tile_height = 240;
+	double composite_rate = 5.0;
+	double composite_min = NAN;
+	double composite_max = NAN;
+	node.param("composite/enabled", g_composite_enabled, g_composite_enabled);
+	node.param("composite/tiles", composite_tiles, composite_tiles);
+	node.param("composite/columns", composite_columns, composite_columns);
+	node.param("composite/tile_width", composite_tile_width, composite_tile_width);
+	node.param("composite/tile_height", composite_tile_height, composite_tile_height);
+	node.param("composite/rate", composite_rate, composite_rate);
+	node.param("composite/min", composite_min, composite_min);
+	node.param("composite/max", composite_max, composite_max);
+	g_composite_min = (float)composite_min;
+	g_composite_max = (float)composite_max;
+
+	ros::Timer composite_timer;
+	if(g_composite_enabled && composite_tiles > 0 && composite_tile_width > 0 && composite_tile_height > 0 && composite_rate > 0.0)
+	{
+		seeknode_composite_init(&g_composite);
+		seeknode_composite_configure(
+			&g_composite,
+			(size_t)std::min(composite_tiles, NUM_MAX_DEVICES),
+			(size_t)std::max(composite_columns, 0),
+			(size_t)composite_tile_width,
+			(size_t)composite_tile_height);
+		g_composite_image.header.frame_id = g_frame_id_prefix + "composite";
+		g_composite_image.width = (uint32_t)g_composite.width;
+		g_composite_image.height = (uint32_t)g_composite.height;
+		g_composite_image.encoding = "mono8";
+		g_composite_image.is_bigendian = 0;
+		g_composite_image.step = (uint32_t)g_composite.width;
+		g_composite_image.data.assign(g_composite.width * g_composite.height, 0);
+		g_composite_message = g_composite_image;
+		g_composite_pub = node.advertise<sensor_msgs::Image>("composite", 1);
+		composite_timer = node.createTimer(ros::Duration(1.0 / composite_rate), composite_timer_callback);
+	}
+	else
+	{
+		g_composite_enabled = false;
+	}
+
+	// Per-pixel statistics options.
+	node.param("statistics/enabled", g_statistics_enabled, g_statistics_enabled);
+	node.param("statistics/frame_step", g_statistics_frame_step, g_statistics_frame_step);
+	node.param("statistics/batch_frames", g_statistics_batch_frames, g_statistics_batch_frames);
+	node.param("statistics/window", g_statistics_window, g_statistics_window);
+	g_statistics_frame_step = std::max(g_statistics_frame_step, 1);
+	g_statistics_batch_frames = std::max(g_statistics_batch_frames, 1);
+	ros::ServiceServer export_statistics_service = node.advertiseService("export_statistics", export_statistics_callback);
+
+	// Automatic flat scene correction options.
+	seeknode_nonuniformity_init(&g_nonuniformity_options);
+	double fsc_uniform_range = g_nonuniformity_options.uniform_range;
+	int fsc_frames = (int)g_nonuniformity_options.frames;
+	node.param("fsc/auto", g_fsc_auto, g_fsc_auto);
+	node.param("fsc/threshold", g_fsc_threshold, g_fsc_threshold);
+	node.param("fsc/uniform_range", fsc_uniform_range, fsc_uniform_range);
+	node.param("fsc/frames", fsc_frames, fsc_frames);
+	node.param("fsc/warmup", g_fsc_warmup, g_fsc_warmup);
+	node.param("fsc/min_interval", g_fsc_min_interval, g_fsc_min_interval);
+	g_nonuniformity_options.uniform_range = (float)fsc_uniform_range;
+	g_nonuniformity_options.frames = (size_t)std::max(fsc_frames, 1);
+
+	// Recording options.
+	std::string record_mode = "always";
+	node.param("record/mode", record_mode, record_mode);
+	node.param("record/post_alarm", g_record_post_alarm, g_record_post_alarm);
+	g_record_on_alarm = record_mode == "alarm";
+	if(record_mode != "always" && record_mode != "alarm")
+	{
+		fprintf(stderr, "invalid record mode: %s\n", record_mode.c_str());
+	}
+
+	// Shutter scheduling options.
+	// In the default (auto) mode the core keeps control of its shutter; blackouts are measured either way.
+	seeknode_shutter_init(&g_shutter_options);
+	std::string shutter_mode = "auto";
+	double shutter_min_interval = g_shutter_options.min_interval_ns * 1.0e-9;
+	double shutter_max_interval = g_shutter_options.max_interval_ns * 1.0e-9;
+	double shutter_hard_interval = g_shutter_options.hard_interval_ns * 1.0e-9;
+	double shutter_temperature_drift = g_shutter_options.temperature_drift;
+	int shutter_diode_drift = (int)g_shutter_options.diode_drift;
+	node.param("shutter/mode", shutter_mode, shutter_mode);
+	node.param("shutter/min_interval", shutter_min_interval, shutter_min_interval);
+	node.param("shutter/max_interval", shutter_max_interval, shutter_max_interval);
+	node.param("shutter/hard_interval", shutter_hard_interval, shutter_hard_interval);
+	node.param("shutter/temperature_drift", shutter_temperature_drift, shutter_temperature_drift);
+	node.param("shutter/diode_drift", shutter_diode_drift, shutter_diode_drift);
+	node.param("shutter/busy_timeout", g_busy_timeout, g_busy_timeout);
+	g_shutter_scheduled = shutter_mode == "scheduled";
+	if(shutter_mode != "auto" && shutter_mode != "scheduled")
+	{
+		fprintf(stderr, "invalid shutter mode: %s\n", shutter_mode.c_str());
+	}
+	g_shutter_options.min_interval_ns = (int64_t)(shutter_min_interval * 1.0e9);
+	g_shutter_options.max_interval_ns = (int64_t)(shutter_max_interval * 1.0e9);
+	g_shutter_options.hard_interval_ns = (int64_t)(std::max(shutter_hard_interval, shutter_max_interval) * 1.0e9);
+	g_shutter_options.temperature_drift = (float)shutter_temperature_drift;
+	g_shutter_options.diode_drift = (uint32_t)std::max(shutter_diode_drift, 0);
+	ros::Subscriber busy_sub;
+	if(g_shutter_scheduled)
+	{
+		busy_sub = node.subscribe("busy", 10, busy_callback);
+	}
+
+	// Thermography window options.
+	// Off by default: published images and logs then always cover the full sensor.
+	seeknode_window_init(&g_window_options);
+	std::string window_mode = "off";
+	node.param("thermography_window/mode", window_mode, window_mode);
+	node.param("thermography_window/margin", g_window_options.margin, g_window_options.margin);
+	node.param("thermography_window/alignment", g_window_options.alignment, g_window_options.alignment);
+	node.param("thermography_window/request_timeout", g_crop_request_timeout, g_crop_request_timeout);
+	g_window_auto = window_mode == "auto";
+	if(window_mode != "off" && window_mode != "auto")
+	{
+		fprintf(stderr, "invalid thermography window mode: %s\n", window_mode.c_str());
+	}
+
+	// Bring-up options.
+	// With the expected number of cameras set, the time from start until all of them stream is reported.
+	int bringup_threads = 4;
+	node.param("bringup/threads", bringup_threads, bringup_threads);
+	node.param("bringup/expected_cameras", g_expected_cameras, g_expected_cameras);
+
+	// Shared memory transport options.
+	// Each camera writes to the segment <prefix><chipid> (under /dev/shm) when enabled.
+	node.param("shm/enabled", g_shm_enabled, g_shm_enabled);
+	node.param("shm/prefix", g_shm_prefix, g_shm_prefix);
+	node.param("shm/slots", g_shm_slots, g_shm_slots);
+
+	// UDP streaming options.
+	seeknode_udp_sender_init(&g_udp_options);
+	std::string udp_format = "mono8";
+	int udp_fragment_size = (int)g_udp_options.fragment_size;
+	int udp_fec_group = (int)g_udp_options.fec_group_size;
+	node.param("udp/enabled", g_udp_enabled, g_udp_enabled);
+	node.param("udp/host", g_udp_host, g_udp_host);
+	node.param("udp/port", g_udp_port, g_udp_port);
+	node.param("udp/format", udp_format, udp_format);
+	node.param("udp/fragment_size", udp_fragment_size, udp_fragment_size);
+	node.param("udp/fec_group", udp_fec_group, udp_fec_group);
+	node.param("udp/queue_depth", g_udp_queue_depth, g_udp_queue_depth);
+	g_udp_options.fragment_size = (size_t)std::max(udp_fragment_size, 1);
+	g_udp_options.fec_group_size = (size_t)std::max(udp_fec_group, 0);
+	g_udp_format = udp_format == "thermography" ? SEEKNODE_UDP_FORMAT_THERMOGRAPHY_FLOAT : SEEKNODE_UDP_FORMAT_MONO8;
+	if(udp_format != "thermography" && udp_format != "mono8")
+	{
+		fprintf(stderr, "invalid udp format: %s\n", udp_format.c_str());
+	}
+
+	// Frame loss and stall monitor options.
+	double drops_check_period = 0.25;
+	node.param("drops/stall_timeout", g_drops_stall_timeout, g_drops_stall_timeout);
+	node.param("drops/check_period", drops_check_period, drops_check_period);
+	ros::Timer drops_timer = node.createTimer(ros::Duration(std::max(drops_check_period, 0.01)), drops_timer_callback);
+
+	// Trace options.
+	// Each thread keeps its last events; dump_trace writes them as Chrome trace JSON.
+	bool trace_enabled = false;
+	int trace_events = 65536;
+	node.param("trace/enabled", trace_enabled, trace_enabled);
+	node.param("trace/events", trace_events, trace_events);
+	if(trace_enabled)
+	{
+		seeknode_trace_enable((size_t)std::max(trace_events, 1));
+	}
+	ros::ServiceServer dump_trace_service = node.advertiseService("dump_trace", dump_trace_callback);
+
+	// Metrics options.
+	// The text file is meant for the node_exporter textfile collector (e.g. /var/lib/node_exporter/seek.prom).
+	double metrics_period = 1.0;
+	node.param("metrics/period", metrics_period, metrics_period);
+	node.param("metrics/textfile", g_metrics_textfile, g_metrics_textfile);
+	g_diagnostics_pub = node.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 10);
+	ros::Timer metrics_timer = node.createTimer(ros::Duration(std::max(metrics_period, 0.1)), metrics_timer_callback);
+
+	// Allocation tracking options (builds with SEEKNODE_ALLOC_TRACKING, ignored otherwise).
+	// Heap allocations on the frame and UDP threads of warm cameras are counted; the first call stacks are printed
+	// on exit. Messages handed to roscpp are not counted.
+	double alloc_warmup = g_alloc_warmup_ns * 1.0e-9;
+	node.param("alloc/warmup", alloc_warmup, alloc_warmup);
+	g_alloc_warmup_ns = (int64_t)(std::max(alloc_warmup, 0.0) * 1.0e9);
+	if(seeknode_alloc_is_available())
+	{
+		g_allocations_metric = seeknode_metrics_gauge(&g_metrics, "seek_frame_path_allocations", "Heap allocations on the frame threads of warm cameras.", {});
+		seeknode_alloc_arm(true);
+	}
 
 	// Default values for the command line arguments.
-	char* discovery_mode_str = "usb";
+	const char* discovery_mode_str = "usb";
 	seekcamera_io_type_t discovery_mode = SEEKCAMERA_IO_TYPE_USB;
 
 	// Parse command line arguments.
@@ -484,8 +3106,16 @@ int main(int argc, char** argv)
 		g_ctx_pool[i].is_live = false;
 		g_ctx_pool[i].log = NULL;
 		g_ctx_pool[i].camera = NULL;
+		g_ctx_pool[i].worker_jobs = 0;
+		g_ctx_pool[i].is_worker_busy = false;
+		g_ctx_pool[i].is_worker_stopping = false;
+		seeknode_shm_writer_init(&g_ctx_pool[i].shm);
 	}
 
+	// Start the bring-up threads before any camera event can arrive.
+	g_start_ns = seeknode_clock_monotonic_ns();
+	seeknode_workqueue_start(&g_bringup, (size_t)std::max(bringup_threads, 1));
+
 	// Create the camera manager.
 	// This is the structure that owns all Seek camera devices.
 	seekcamera_manager_t* manager = NULL;
@@ -493,6 +3123,7 @@ int main(int argc, char** argv)
 	if(status != SEEKCAMERA_SUCCESS)
 	{
 		fprintf(stderr, "failed to create camera manager: %s\n", seekcamera_error_get_str(status));
+		seeknode_workqueue_stop(&g_bringup);
 		return 1;
 	}
 
@@ -504,13 +3135,16 @@ int main(int argc, char** argv)
 	{
 		fprintf(stderr, "failed to register camera event callback: %s\n", seekcamera_error_get_str(status));
 		seekcamera_manager_destroy(&manager);
+		seeknode_workqueue_stop(&g_bringup);
 		return 1;
 	}
 
 	// Camera events are asynchronous and interrupt the current thread.
-	// There are much better ways of keeping the main thread alive.
-	// This is just a simple example.
-	while(g_keep_running)
+	// ROS callbacks (timers, subscriptions, services) are serviced by a background spinner.
+	ros::AsyncSpinner spinner(1);
+	spinner.start();
+
+	while(g_keep_running && ros::ok())
 	{
 		const int sleep_ms = 1000;
 #ifdef _WIN32
@@ -523,21 +3157,39 @@ int main(int argc, char** argv)
 	// Cleanup the camera manager.
 	// Cameras will be disconnected and invalidated.
 	status = seekcamera_manager_destroy(&manager);
+	seeknode_workqueue_stop(&g_bringup);
 	if(status != SEEKCAMERA_SUCCESS)
 	{
 		fprintf(stderr, "failed to free camera manager: %s\n", seekcamera_error_get_str(status));
 		return 1;
 	}
 
-	// Invalidate the camera contexts.
+	// Stop the background workers and invalidate the camera contexts.
 	for(int i = 0; i < NUM_MAX_DEVICES; ++i)
 	{
+		if(g_ctx_pool[i].worker_thread.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(g_ctx_pool[i].worker_mutex);
+				g_ctx_pool[i].is_worker_stopping = true;
+				g_ctx_pool[i].worker_cv.notify_all();
+			}
+			g_ctx_pool[i].worker_thread.join();
+		}
 		g_ctx_pool[i].is_free = true;
 		g_ctx_pool[i].is_live = false;
 		g_ctx_pool[i].log = NULL;
 		g_ctx_pool[i].camera = NULL;
 	}
 
+	spinner.stop();
+	ros::shutdown();
+
+	if(seeknode_alloc_is_available())
+	{
+		seeknode_alloc_print_report(stdout);
+	}
+
 	fprintf(stdout, "done\n");
 
 	return 0;
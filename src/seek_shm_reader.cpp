@@ -0,0 +1,174 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Reads the shared memory ring of a camera (see ~shm/enabled) and reports the rate, age and losses of the frames.
+// It also serves as an example of a local consumer that is not a ROS node.
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+
+#include "seeknode/seeknode_clock.h"
+#include "seeknode/seeknode_shm.h"
+
+static std::atomic<bool> g_keep_running(true);
+
+static void signal_callback(int signum)
+{
+	(void)signum;
+	g_keep_running = false;
+}
+
+static void print_usage()
+{
+	fprintf(stdout, "Usage: seek_shm_reader <name> [-p period]\n");
+	fprintf(stdout, "\tname : Shared memory segment, e.g. /seeknode_<chipid>\n");
+	fprintf(stdout, "\t-p   : Report period in seconds (default: 1)\n");
+	fprintf(stdout, "\t-h   : Displays this message\n");
+}
+
+int main(int argc, char** argv)
+{
+	signal(SIGINT, signal_callback);
+	signal(SIGTERM, signal_callback);
+
+	const char* name = NULL;
+	double period = 1.0;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "-p") == 0 && i < argc - 1)
+		{
+			period = atof(argv[++i]);
+		}
+		else if(strcmp(argv[i], "-h") == 0)
+		{
+			print_usage();
+			return 0;
+		}
+		else if(argv[i][0] != '-' && name == NULL)
+		{
+			name = argv[i];
+		}
+		else
+		{
+			print_usage();
+			return 1;
+		}
+	}
+	if(name == NULL)
+	{
+		print_usage();
+		return 1;
+	}
+
+	seeknode_shm_reader_t reader;
+	seeknode_shm_reader_init(&reader);
+	while(g_keep_running)
+	{
+		// Wait for the writer; the segment disappears while the camera is disconnected.
+		if(!seeknode_shm_reader_open(&reader, name))
+		{
+			usleep(500000);
+			continue;
+		}
+		fprintf(stdout, "opened: %s (CID: %s, slots: %u)\n", name, reader.header->chipid, reader.header->num_slots);
+		fflush(stdout);
+
+		int64_t report_ns = seeknode_clock_monotonic_ns();
+		uint64_t report_read = 0;
+		double total_age_ms = 0.0;
+		uint64_t num_aged = 0;
+		float min_value = 0.0f;
+		float max_value = 0.0f;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		while(g_keep_running)
+		{
+			seeknode_shm_view_t view;
+			const seeknode_shm_read_result_t result = seeknode_shm_reader_next(&reader, &view, 100000000LL);
+			if(result == SEEKNODE_SHM_READ_CLOSED)
+			{
+				fprintf(stdout, "closed: %s\n", name);
+				break;
+			}
+
+			if(result == SEEKNODE_SHM_READ_OK)
+			{
+				// Work on the slot in place, then make sure the writer did not overwrite it meanwhile.
+				const seeknode_shm_slot_t* slot = view.slot;
+				const float* pixels = (const float*)view.data;
+				const size_t count = (size_t)slot->width * slot->height;
+				float frame_min = count > 0 ? pixels[0] : 0.0f;
+				float frame_max = frame_min;
+				for(size_t i = 1; i < count; ++i)
+				{
+					frame_min = pixels[i] < frame_min ? pixels[i] : frame_min;
+					frame_max = pixels[i] > frame_max ? pixels[i] : frame_max;
+				}
+				const int64_t stamp_ns = slot->stamp_ns;
+				const uint32_t frame_width = slot->width;
+				const uint32_t frame_height = slot->height;
+				if(seeknode_shm_reader_validate(&reader, &view))
+				{
+					total_age_ms += (seeknode_clock_realtime_ns() - stamp_ns) * 1.0e-6;
+					++num_aged;
+					min_value = frame_min;
+					max_value = frame_max;
+					width = frame_width;
+					height = frame_height;
+				}
+			}
+
+			const int64_t now_ns = seeknode_clock_monotonic_ns();
+			if(now_ns - report_ns >= (int64_t)(period * 1.0e9))
+			{
+				const uint64_t num_read = reader.num_read - report_read;
+				fprintf(stdout, "frames: %.1f/s (size: %ux%u, min: %.2f, max: %.2f, age: %.2f ms, lag: %llu, max lag: %llu, lost: %llu, torn: %llu)\n",
+					num_read / ((now_ns - report_ns) * 1.0e-9),
+					width,
+					height,
+					min_value,
+					max_value,
+					num_aged > 0 ? total_age_ms / num_aged : 0.0,
+					(unsigned long long)reader.lag,
+					(unsigned long long)reader.max_lag,
+					(unsigned long long)reader.num_lost,
+					(unsigned long long)reader.num_torn);
+				fflush(stdout);
+				report_ns = now_ns;
+				report_read = reader.num_read;
+				total_age_ms = 0.0;
+				num_aged = 0;
+			}
+		}
+		seeknode_shm_reader_close(&reader);
+	}
+
+	seeknode_shm_reader_close(&reader);
+	return 0;
+}
@@ -0,0 +1,847 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Scaling stress test of the frame pipeline with simulated cameras (see seeknode_simcam.h).
+// For each camera count, every camera runs the ROS independent stages of the node (pixel statistics, bad pixel
+// correction, denoise, scene gate, non-uniformity estimation, output conversion, rectification, regions, blobs, the
+// monitoring composite, alarms and optionally the shared memory ring, the frame ring handing frames to a sender thread
+// as the UDP stream does, and the CSV record) on its own callback thread. The harness
+// measures the frame rate of each camera, the latency from frame due to frame processed, the resident memory and the
+// CPU load of every core, and prints a scaling report (Markdown, also written with -o). Run it on each target
+// architecture; the report records the machine it ran on.
+//
+// With -a, built with allocation tracking (cmake -DSEEKNODE_ALLOC_TRACKING=ON), it checks that the frame path does not
+// allocate once warm: any heap allocation on a camera or sender thread during a measured window fails the run.
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "seeknode/seeknode_alarm.h"
+#include "seeknode/seeknode_alloc.h"
+#include "seeknode/seeknode_badpixel.h"
+#include "seeknode/seeknode_blob.h"
+#include "seeknode/seeknode_clock.h"
+#include "seeknode/seeknode_composite.h"
+#include "seeknode/seeknode_convert.h"
+#include "seeknode/seeknode_denoise.h"
+#include "seeknode/seeknode_framering.h"
+#include "seeknode/seeknode_gate.h"
+#include "seeknode/seeknode_nonuniformity.h"
+#include "seeknode/seeknode_roi.h"
+#include "seeknode/seeknode_shm.h"
+#include "seeknode/seeknode_simcam.h"
+#include "seeknode/seeknode_undistort.h"
+#include "seeknode/seeknode_welford.h"
+
+// Every STUCK_PIXEL_PERIOD-th pixel of the simulated sensor is stuck, so the bad pixel map has something to correct.
+static const size_t STUCK_PIXEL_PERIOD = 997;
+static const float STUCK_PIXEL_VALUE = 25.0f;
+
+// Frames learned for the bad pixel map; learning allocates when it completes, so it must end within the warmup.
+static const size_t BAD_PIXEL_LEARN_FRAMES = 20;
+
+// Statistics accumulate every STATISTICS_FRAME_STEP-th frame, as with the node's default ~statistics/frame_step.
+static const uint64_t STATISTICS_FRAME_STEP = 4;
+
+// Tile size of the monitoring composite.
+static const size_t COMPOSITE_TILE_WIDTH = 160;
+static const size_t COMPOSITE_TILE_HEIGHT = 120;
+
+// Enumerated type representing the output each camera produces for its subscribers.
+typedef enum output_format_t
+{
+	OUTPUT_FORMAT_THERMOGRAPHY = 0,  // 32FC1 image copy
+	OUTPUT_FORMAT_MONO8,             // 8-bit conversion
+} output_format_t;
+
+// Structure holding the harness options.
+typedef struct options_t
+{
+	std::vector<int> counts;
+	double rate;
+	size_t width;
+	size_t height;
+	output_format_t format;
+	double warmup;
+	double duration;
+	bool is_shm_enabled;
+	bool is_ring_enabled;
+	bool is_record_enabled;
+	bool is_alloc_check;
+	std::string report_path;
+} options_t;
+
+// Structure holding a simulated camera, its pipeline and its measurements.
+// Everything but the camera is only touched by the camera thread until the camera is stopped.
+typedef struct pipeline_t
+{
+	seeknode_simcam_t camera;
+	std::vector<float> pixels;         // Working copy of the frame; the node filters the SDK buffer in place
+	int index;                         // Composite tile
+	uint64_t num_frames;
+	seeknode_welford_t statistics;
+	seeknode_badpixel_t bad_pixels;
+	seeknode_denoise_t denoise;
+	seeknode_gate_t gate;
+	seeknode_nonuniformity_t nonuniformity;
+	seeknode_undistort_t undistort;
+	std::vector<float> rect;           // Rectified image message buffer
+	seeknode_roi_engine_t roi;
+	seeknode_blob_detector_t blobs;
+	seeknode_alarm_engine_t alarms;
+	seeknode_shm_writer_t shm;
+	const seeknode_converter_t* converter;  // To the output format
+	seeknode_frame_ring_t ring;        // To the sender thread, with -u
+	std::thread sender;
+	FILE* log;                         // CSV record, with -l
+	std::vector<uint8_t> image;        // Output message buffer
+	std::vector<int64_t> latencies_ns;
+	uint64_t skipped_at_start;
+} pipeline_t;
+
+// Structure holding the results of a step.
+typedef struct step_result_t
+{
+	int num_cameras;
+	double min_fps;
+	double mean_fps;
+	uint64_t num_skipped;
+	double p50_ms;
+	double p99_ms;
+	double max_ms;
+	double rss_mb;
+	double process_cores;              // CPU time of the process over wall time
+	double mean_core_load;             // Percent
+	double max_core_load;              // Percent
+	uint64_t num_allocations;          // On camera and sender threads, with -a
+} step_result_t;
+
+// Busy and total jiffies of a core.
+typedef struct core_times_t
+{
+	uint64_t busy;
+	uint64_t total;
+} core_times_t;
+
+static std::atomic<bool> g_keep_running(true);
+
+// Monitoring composite shared by the cameras of a step, written under the mutex as in the node.
+static std::mutex g_composite_mutex;
+static seeknode_composite_t g_composite;
+static std::vector<uint8_t> g_composite_image;
+
+// Only frames due within the measurement window (monotonic clock) are measured.
+static std::atomic<int64_t> g_measure_start_ns(INT64_MAX);
+static std::atomic<int64_t> g_measure_end_ns(INT64_MAX);
+
+static void signal_callback(int signum)
+{
+	(void)signum;
+	g_keep_running = false;
+}
+
+static void print_usage()
+{
+	fprintf(stdout, "Usage: seek_stress [-c counts] [-r rate] [-s WxH] [-f format] [-w warmup] [-d duration] [-m] [-u] [-l] [-a] [-o report]\n");
+	fprintf(stdout, "\t-c : Comma separated camera counts (default: 1,2,4,8,16,32,64)\n");
+	fprintf(stdout, "\t-r : Frame rate of each camera (default: 27)\n");
+	fprintf(stdout, "\t-s : Frame size (default: 320x240)\n");
+	fprintf(stdout, "\t-f : Output format: thermography, mono8 (default: thermography)\n");
+	fprintf(stdout, "\t-w : Warmup of each step in seconds, not measured (default: 2)\n");
+	fprintf(stdout, "\t-d : Measured duration of each step in seconds (default: 10)\n");
+	fprintf(stdout, "\t-m : Also write every frame to a shared memory ring\n");
+	fprintf(stdout, "\t-u : Also hand every published frame to a sender thread through a frame ring\n");
+	fprintf(stdout, "\t-l : Also record every frame to the CSV log format (written to /dev/null)\n");
+	fprintf(stdout, "\t-a : Fail if a camera thread allocates after warmup (allocation tracking build)\n");
+	fprintf(stdout, "\t-o : Report file (Markdown)\n");
+	fprintf(stdout, "\t-h : Displays this message\n");
+}
+
+// Sleeps for a while unless interrupted.
+static void wait(double seconds)
+{
+	const int64_t end_ns = seeknode_clock_monotonic_ns() + (int64_t)(seconds * 1.0e9);
+	while(g_keep_running && seeknode_clock_monotonic_ns() < end_ns)
+	{
+		usleep(10000);
+	}
+}
+
+// Reads the busy and total times of every core from /proc/stat.
+static std::vector<core_times_t> read_core_times()
+{
+	std::vector<core_times_t> cores;
+	FILE* file = fopen("/proc/stat", "r");
+	if(file == NULL)
+	{
+		return cores;
+	}
+
+	char line[512];
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		unsigned long long user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+		int core = 0;
+		if(strncmp(line, "cpu", 3) != 0 || line[3] < '0' || line[3] > '9')
+		{
+			continue;
+		}
+		if(sscanf(line, "cpu%d %llu %llu %llu %llu %llu %llu %llu %llu", &core, &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal) < 5)
+		{
+			continue;
+		}
+
+		core_times_t times;
+		times.total = user + nice + system + idle + iowait + irq + softirq + steal;
+		times.busy = times.total - idle - iowait;
+		cores.push_back(times);
+	}
+	fclose(file);
+	return cores;
+}
+
+// Reads a memory figure of the process (e.g. "VmRSS") from /proc/self/status, in MB.
+static double read_memory_mb(const char* field)
+{
+	FILE* file = fopen("/proc/self/status", "r");
+	if(file == NULL)
+	{
+		return 0.0;
+	}
+
+	double value_mb = 0.0;
+	char line[256];
+	const size_t length = strlen(field);
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		if(strncmp(line, field, length) == 0 && line[length] == ':')
+		{
+			value_mb = atof(line + length + 1) / 1024.0;
+			break;
+		}
+	}
+	fclose(file);
+	return value_mb;
+}
+
+static int64_t get_process_cpu_ns()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return ((int64_t)usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000LL +
+		((int64_t)usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000LL;
+}
+
+// Sets up the pipeline of a camera the way the node configures a camera with regions, blobs and an alarm.
+static void configure_pipeline(pipeline_t* pipeline, const options_t* options, int index)
+{
+	const size_t width = options->width;
+	const size_t height = options->height;
+	char chipid[16] = { 0 };
+	snprintf(chipid, sizeof(chipid), "SIM%03d", index);
+
+	seeknode_simcam_init(&pipeline->camera);
+	pipeline->camera.chipid = chipid;
+	pipeline->camera.width = width;
+	pipeline->camera.height = height;
+	pipeline->camera.rate = options->rate;
+	pipeline->pixels.resize(width * height);
+	pipeline->index = index;
+	pipeline->num_frames = 0;
+
+	seeknode_welford_init(&pipeline->statistics);
+	seeknode_welford_configure(&pipeline->statistics, width, height);
+
+	seeknode_badpixel_init(&pipeline->bad_pixels);
+	pipeline->bad_pixels.learn_frames = BAD_PIXEL_LEARN_FRAMES;
+	seeknode_badpixel_configure(&pipeline->bad_pixels, width, height);
+	seeknode_badpixel_start_learning(&pipeline->bad_pixels);
+
+	seeknode_denoise_init(&pipeline->denoise);
+	pipeline->denoise.mode = SEEKNODE_DENOISE_MODE_MOTION_ADAPTIVE;
+	seeknode_denoise_configure(&pipeline->denoise, width, height);
+
+	seeknode_gate_init(&pipeline->gate);
+	seeknode_gate_configure(&pipeline->gate, width, height);
+
+	seeknode_nonuniformity_init(&pipeline->nonuniformity);
+	seeknode_nonuniformity_configure(&pipeline->nonuniformity, width, height);
+
+	// A lens with moderate barrel distortion.
+	seeknode_camera_model_t model;
+	memset(&model, 0, sizeof(model));
+	model.fx = (double)width;
+	model.fy = (double)width;
+	model.cx = width * 0.5;
+	model.cy = height * 0.5;
+	model.k1 = -0.2;
+	model.k2 = 0.05;
+	seeknode_undistort_init(&pipeline->undistort);
+	seeknode_undistort_configure(&pipeline->undistort, &model, width, height);
+	pipeline->rect.resize(width * height);
+
+	seeknode_roi_engine_init(&pipeline->roi);
+	seeknode_roi_engine_add_rect(&pipeline->roi, "left", 0, 0, (int)width / 2, (int)height, 40.0f);
+	seeknode_roi_engine_add_polygon(&pipeline->roi, "center", { width * 0.25f, height * 0.25f, width * 0.75f, height * 0.25f, width * 0.5f, height * 0.75f }, 40.0f);
+	seeknode_roi_engine_configure(&pipeline->roi, width, height);
+
+	seeknode_blob_detector_init(&pipeline->blobs);
+	pipeline->blobs.threshold = 40.0f;
+	seeknode_blob_detector_configure(&pipeline->blobs, width, height);
+
+	seeknode_alarm_engine_init(&pipeline->alarms);
+	seeknode_alarm_rule_t rule = seeknode_alarm_rule_t();
+	rule.name = "hot";
+	rule.type = SEEKNODE_ALARM_TYPE_ABOVE;
+	rule.threshold = 50.0f;
+	rule.hysteresis = 1.0f;
+	seeknode_alarm_engine_add_rule(&pipeline->alarms, &rule);
+	rule.name = "rising";
+	rule.type = SEEKNODE_ALARM_TYPE_RISE;
+	rule.threshold = 5.0f;
+	rule.window_ns = 2000000000LL;
+	seeknode_alarm_engine_add_rule(&pipeline->alarms, &rule);
+	seeknode_alarm_engine_configure(&pipeline->alarms, width, height);
+
+	seeknode_shm_writer_init(&pipeline->shm);
+	if(options->is_shm_enabled)
+	{
+		const std::string name = "/seek_stress_" + std::to_string(getpid()) + "_" + std::to_string(index);
+		if(!seeknode_shm_writer_open(&pipeline->shm, name, chipid, 4, width * height * sizeof(float)))
+		{
+			fprintf(stderr, "failed to create shared memory: %s\n", name.c_str());
+		}
+	}
+
+	// As for the UDP stream: a frame being sent, two queued and one being written.
+	pipeline->converter = seeknode_converter_find(
+		SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT,
+		options->format == OUTPUT_FORMAT_MONO8 ? SEEKNODE_ENCODING_MONO8 : SEEKNODE_ENCODING_32FC1);
+	pipeline->image.resize(width * height * pipeline->converter->dst_pixel_size);
+	seeknode_frame_ring_init(&pipeline->ring, 4, 2);
+	seeknode_frame_ring_reserve(&pipeline->ring, pipeline->image.size());
+	pipeline->log = options->is_record_enabled ? fopen("/dev/null", "w") : NULL;
+	pipeline->latencies_ns.clear();
+	pipeline->latencies_ns.reserve((size_t)(options->rate * (options->duration + 1.0)));
+}
+
+// Writes a frame in the CSV log format of the node: a header line padded to the frame width and one line per row.
+static void record_frame(FILE* log, const seekcamera_frame_header_t* header, const float* pixels, size_t stride, size_t width, size_t height)
+{
+	size_t count = 0;
+	count += fprintf(log, "timestamp_utc_ns=%zu,", (size_t)header->timestamp_utc_ns) > 0 ? 1 : 0;
+	count += fprintf(log, "chipid=%s,", header->chipid) > 0 ? 1 : 0;
+	count += fprintf(log, "fpa_frame_count=%u,", header->fpa_frame_count) > 0 ? 1 : 0;
+	count += fprintf(log, "thermography_min_value=%f,", header->thermography_min_value) > 0 ? 1 : 0;
+	count += fprintf(log, "thermography_max_value=%f,", header->thermography_max_value) > 0 ? 1 : 0;
+	for(size_t i = count; i < width; ++i)
+	{
+		fprintf(log, "blank,");
+	}
+	fputc('\n', log);
+
+	for(size_t y = 0; y < height; ++y)
+	{
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride);
+		for(size_t x = 0; x < width; ++x)
+		{
+			fprintf(log, "%.1f,", row[x]);
+		}
+		fputc('\n', log);
+	}
+}
+
+// Frame callback of a simulated camera: the stages of the node's frame callback that do not need ROS.
+static void process_frame(pipeline_t* pipeline, const options_t* options, const seeknode_simcam_frame_t* frame)
+{
+	seekcamera_frame_header_t frame_header = frame->header;
+	seekcamera_frame_header_t* header = &frame_header;
+	const size_t width = header->width;
+	const size_t height = header->height;
+	const size_t stride = width * sizeof(float);
+	float* pixels = pipeline->pixels.data();
+	seeknode_alloc_track_thread(true);
+	memcpy(pixels, frame->pixels.data(), width * height * sizeof(float));
+	for(size_t i = 0; i < width * height; i += STUCK_PIXEL_PERIOD)
+	{
+		pixels[i] = STUCK_PIXEL_VALUE;
+	}
+
+	if(pipeline->num_frames++ % STATISTICS_FRAME_STEP == 0)
+	{
+		seeknode_welford_add(&pipeline->statistics, pixels, stride);
+	}
+
+	// The map is learned during the warmup and applied afterwards.
+	if(seeknode_badpixel_is_learning(&pipeline->bad_pixels))
+	{
+		seeknode_badpixel_learn(&pipeline->bad_pixels, pixels, stride);
+	}
+	else if(!pipeline->bad_pixels.bad.empty())
+	{
+		seeknode_badpixel_apply(&pipeline->bad_pixels, pixels, stride);
+		seeknode_badpixel_update_header(header, pixels, stride, 0, 0, width, height);
+	}
+
+	seeknode_denoise_process(&pipeline->denoise, pixels, stride);
+	const bool do_publish = seeknode_gate_process(
+		&pipeline->gate,
+		pixels,
+		stride,
+		header->thermography_min_value,
+		header->thermography_max_value,
+		frame->capture_ns,
+		pipeline->image.size());
+
+	seeknode_nonuniformity_process(&pipeline->nonuniformity, pixels, stride, header->thermography_min_value, header->thermography_max_value);
+
+	if(do_publish)
+	{
+		pipeline->converter->convert(
+			pixels,
+			stride,
+			pipeline->image.data(),
+			width * pipeline->converter->dst_pixel_size,
+			width,
+			height,
+			header->thermography_min_value,
+			header->thermography_max_value);
+
+		seeknode_frame_slot_t* slot = options->is_ring_enabled ? seeknode_frame_ring_acquire(&pipeline->ring, pipeline->image.size()) : NULL;
+		if(slot != NULL)
+		{
+			slot->header = *header;
+			slot->encoding = pipeline->converter->encoding;
+			slot->width = width;
+			slot->height = height;
+			slot->stride = pipeline->image.size() / height;
+			memcpy(slot->data.data(), pipeline->image.data(), pipeline->image.size());
+			seeknode_frame_ring_publish(&pipeline->ring, slot);
+		}
+
+		seeknode_undistort_remap_f32(&pipeline->undistort, pixels, stride, pipeline->rect.data(), stride);
+	}
+
+	if(seeknode_shm_writer_is_open(&pipeline->shm))
+	{
+		seeknode_shm_writer_publish(&pipeline->shm, header, frame->capture_ns, SEEKNODE_SHM_FORMAT_THERMOGRAPHY_FLOAT, pixels, stride, width, height, sizeof(float), 0, 0);
+	}
+
+	seeknode_roi_engine_process(&pipeline->roi, pixels, stride);
+	seeknode_blob_detector_process(&pipeline->blobs, pixels, stride);
+
+	{
+		std::lock_guard<std::mutex> lock(g_composite_mutex);
+		seeknode_composite_write_tile(
+			&g_composite,
+			g_composite_image.data(),
+			g_composite.width,
+			(size_t)pipeline->index,
+			pixels,
+			width,
+			height,
+			stride,
+			header->thermography_min_value,
+			header->thermography_max_value);
+	}
+
+	seeknode_alarm_engine_process(
+		&pipeline->alarms,
+		pixels,
+		stride,
+		header->thermography_min_value,
+		header->thermography_max_value,
+		(int64_t)header->timestamp_utc_ns);
+
+	if(pipeline->log != NULL)
+	{
+		record_frame(pipeline->log, header, pixels, stride, width, height);
+	}
+
+	if(frame->capture_ns >= g_measure_start_ns.load(std::memory_order_relaxed) && frame->capture_ns < g_measure_end_ns.load(std::memory_order_relaxed))
+	{
+		pipeline->latencies_ns.push_back(seeknode_clock_monotonic_ns() - frame->capture_ns);
+	}
+}
+
+// Sender thread of a camera: consumes the frame ring the way the node's UDP sender does, without the socket.
+static void sender_thread(pipeline_t* pipeline)
+{
+	seeknode_alloc_track_thread(true);
+	while(true)
+	{
+		seeknode_frame_handle_t frame = seeknode_frame_ring_pop_handle(&pipeline->ring, 100000000LL);
+		if(!frame && seeknode_frame_ring_is_closed(&pipeline->ring))
+		{
+			break;
+		}
+	}
+}
+
+// Gets a percentile of sorted values.
+static double get_percentile_ms(const std::vector<int64_t>& sorted, double percentile)
+{
+	if(sorted.empty())
+	{
+		return 0.0;
+	}
+	const size_t index = std::min((size_t)(percentile * 0.01 * sorted.size()), sorted.size() - 1);
+	return sorted[index] * 1.0e-6;
+}
+
+static void run_step(const options_t* options, int num_cameras, step_result_t* result)
+{
+	g_measure_start_ns = INT64_MAX;
+	g_measure_end_ns = INT64_MAX;
+	seeknode_composite_init(&g_composite);
+	seeknode_composite_configure(&g_composite, (size_t)num_cameras, 0, COMPOSITE_TILE_WIDTH, COMPOSITE_TILE_HEIGHT);
+	g_composite_image.assign(g_composite.width * g_composite.height, 0);
+
+	std::vector<std::unique_ptr<pipeline_t> > pipelines;
+	for(int i = 0; i < num_cameras; ++i)
+	{
+		pipelines.emplace_back(new pipeline_t());
+		pipeline_t* pipeline = pipelines.back().get();
+		configure_pipeline(pipeline, options, i);
+		if(options->is_ring_enabled)
+		{
+			pipeline->sender = std::thread(sender_thread, pipeline);
+		}
+		seeknode_simcam_start(&pipeline->camera, [pipeline, options](const seeknode_simcam_frame_t* frame) { process_frame(pipeline, options, frame); });
+	}
+
+	wait(options->warmup);
+	for(auto& pipeline : pipelines)
+	{
+		pipeline->skipped_at_start = pipeline->camera.num_skipped;
+	}
+	const std::vector<core_times_t> cores_start = read_core_times();
+	const int64_t cpu_start_ns = get_process_cpu_ns();
+	const int64_t start_ns = seeknode_clock_monotonic_ns();
+	g_measure_start_ns = start_ns;
+	if(options->is_alloc_check)
+	{
+		seeknode_alloc_arm(true);
+	}
+
+	wait(options->duration);
+	const int64_t end_ns = seeknode_clock_monotonic_ns();
+	g_measure_end_ns = end_ns;
+	result->num_allocations = 0;
+	if(options->is_alloc_check)
+	{
+		seeknode_alloc_arm(false);
+		result->num_allocations = seeknode_alloc_get_count();
+		if(result->num_allocations > 0)
+		{
+			seeknode_alloc_print_report(stderr);
+		}
+	}
+	const int64_t cpu_end_ns = get_process_cpu_ns();
+	const std::vector<core_times_t> cores_end = read_core_times();
+	result->rss_mb = read_memory_mb("VmRSS");
+
+	for(auto& pipeline : pipelines)
+	{
+		seeknode_simcam_stop(&pipeline->camera);
+		seeknode_shm_writer_close(&pipeline->shm);
+		seeknode_frame_ring_close(&pipeline->ring);
+		if(pipeline->sender.joinable())
+		{
+			pipeline->sender.join();
+		}
+		if(pipeline->log != NULL)
+		{
+			fclose(pipeline->log);
+		}
+	}
+
+	// Frames due within the window but processed after it still count, with their full latency.
+	const double elapsed = (end_ns - start_ns) * 1.0e-9;
+	std::vector<int64_t> latencies_ns;
+	result->num_cameras = num_cameras;
+	result->min_fps = 1.0e9;
+	result->mean_fps = 0.0;
+	result->num_skipped = 0;
+	for(auto& pipeline : pipelines)
+	{
+		const double fps = pipeline->latencies_ns.size() / elapsed;
+		result->min_fps = std::min(result->min_fps, fps);
+		result->mean_fps += fps / num_cameras;
+		result->num_skipped += pipeline->camera.num_skipped - pipeline->skipped_at_start;
+		latencies_ns.insert(latencies_ns.end(), pipeline->latencies_ns.begin(), pipeline->latencies_ns.end());
+	}
+	std::sort(latencies_ns.begin(), latencies_ns.end());
+	result->p50_ms = get_percentile_ms(latencies_ns, 50.0);
+	result->p99_ms = get_percentile_ms(latencies_ns, 99.0);
+	result->max_ms = latencies_ns.empty() ? 0.0 : latencies_ns.back() * 1.0e-6;
+	result->process_cores = (cpu_end_ns - cpu_start_ns) * 1.0e-9 / elapsed;
+
+	result->mean_core_load = 0.0;
+	result->max_core_load = 0.0;
+	const size_t num_cores = std::min(cores_start.size(), cores_end.size());
+	for(size_t i = 0; i < num_cores; ++i)
+	{
+		const uint64_t total = cores_end[i].total - cores_start[i].total;
+		const double load = total > 0 ? 100.0 * (cores_end[i].busy - cores_start[i].busy) / total : 0.0;
+		result->mean_core_load += load / num_cores;
+		result->max_core_load = std::max(result->max_core_load, load);
+	}
+}
+
+static bool parse_counts(const char* str, std::vector<int>* counts)
+{
+	counts->clear();
+	const char* c = str;
+	while(*c != '\0')
+	{
+		char* end = NULL;
+		const long count = strtol(c, &end, 10);
+		if(end == c || count <= 0)
+		{
+			return false;
+		}
+		counts->push_back((int)count);
+		c = *end == ',' ? end + 1 : end;
+	}
+	return !counts->empty();
+}
+
+static void write_report(FILE* file, const options_t* options, const std::vector<step_result_t>& results)
+{
+	struct utsname machine;
+	uname(&machine);
+
+	fprintf(file, "# seek_stress scaling report\n\n");
+	fprintf(file, "- machine: %s %s (%s), %ld cores online\n", machine.sysname, machine.release, machine.machine, sysconf(_SC_NPROCESSORS_ONLN));
+	fprintf(file, "- cameras: %zux%zu at %.1f Hz, %s output%s%s%s\n",
+		options->width,
+		options->height,
+		options->rate,
+		options->format == OUTPUT_FORMAT_MONO8 ? "mono8" : "thermography",
+		options->is_shm_enabled ? ", shared memory ring" : "",
+		options->is_ring_enabled ? ", frame ring to a sender thread" : "",
+		options->is_record_enabled ? ", CSV record" : "");
+	fprintf(file, "- each step: %.1f s warmup, %.1f s measured\n\n", options->warmup, options->duration);
+	fprintf(file, "| cameras | fps min | fps mean | skipped | p50 ms | p99 ms | max ms | RSS MB | process cores | core load mean %% | core load max %% |\n");
+	fprintf(file, "|---:|---:|---:|---:|---:|---:|---:|---:|---:|---:|---:|\n");
+	for(const auto& result : results)
+	{
+		fprintf(file, "| %d | %.1f | %.1f | %llu | %.2f | %.2f | %.2f | %.1f | %.2f | %.1f | %.1f |\n",
+			result.num_cameras,
+			result.min_fps,
+			result.mean_fps,
+			(unsigned long long)result.num_skipped,
+			result.p50_ms,
+			result.p99_ms,
+			result.max_ms,
+			result.rss_mb,
+			result.process_cores,
+			result.mean_core_load,
+			result.max_core_load);
+	}
+
+	// A step saturates when a camera falls behind its rate or loses frames.
+	const step_result_t* saturated = NULL;
+	for(const auto& result : results)
+	{
+		if(result.min_fps < 0.95 * options->rate || result.num_skipped > 0)
+		{
+			saturated = &result;
+			break;
+		}
+	}
+	fprintf(file, "\n");
+	if(saturated != NULL)
+	{
+		fprintf(file, "Saturated at %d cameras (slowest camera: %.1f fps, skipped frames: %llu).\n",
+			saturated->num_cameras,
+			saturated->min_fps,
+			(unsigned long long)saturated->num_skipped);
+	}
+	else if(!results.empty())
+	{
+		fprintf(file, "No saturation up to %d cameras.\n", results.back().num_cameras);
+	}
+	fprintf(file, "Peak RSS: %.1f MB.\n", read_memory_mb("VmHWM"));
+}
+
+int main(int argc, char** argv)
+{
+	signal(SIGINT, signal_callback);
+	signal(SIGTERM, signal_callback);
+
+	options_t options;
+	options.counts = { 1, 2, 4, 8, 16, 32, 64 };
+	options.rate = 27.0;
+	options.width = 320;
+	options.height = 240;
+	options.format = OUTPUT_FORMAT_THERMOGRAPHY;
+	options.warmup = 2.0;
+	options.duration = 10.0;
+	options.is_shm_enabled = false;
+	options.is_ring_enabled = false;
+	options.is_record_enabled = false;
+	options.is_alloc_check = false;
+	for(int i = 1; i < argc; ++i)
+	{
+		const bool has_value = i < argc - 1;
+		bool is_valid = true;
+		if(strcmp(argv[i], "-c") == 0 && has_value)
+		{
+			is_valid = parse_counts(argv[++i], &options.counts);
+		}
+		else if(strcmp(argv[i], "-r") == 0 && has_value)
+		{
+			options.rate = atof(argv[++i]);
+			is_valid = options.rate > 0.0;
+		}
+		else if(strcmp(argv[i], "-s") == 0 && has_value)
+		{
+			unsigned int width = 0;
+			unsigned int height = 0;
+			is_valid = sscanf(argv[++i], "%ux%u", &width, &height) == 2 && width >= 16 && height >= 16 && width <= 4096 && height <= 4096;
+			options.width = width;
+			options.height = height;
+		}
+		else if(strcmp(argv[i], "-f") == 0 && has_value)
+		{
+			const char* format = argv[++i];
+			is_valid = strcmp(format, "thermography") == 0 || strcmp(format, "mono8") == 0;
+			options.format = strcmp(format, "mono8") == 0 ? OUTPUT_FORMAT_MONO8 : OUTPUT_FORMAT_THERMOGRAPHY;
+		}
+		else if(strcmp(argv[i], "-w") == 0 && has_value)
+		{
+			options.warmup = atof(argv[++i]);
+		}
+		else if(strcmp(argv[i], "-d") == 0 && has_value)
+		{
+			options.duration = atof(argv[++i]);
+			is_valid = options.duration > 0.0;
+		}
+		else if(strcmp(argv[i], "-m") == 0)
+		{
+			options.is_shm_enabled = true;
+		}
+		else if(strcmp(argv[i], "-u") == 0)
+		{
+			options.is_ring_enabled = true;
+		}
+		else if(strcmp(argv[i], "-l") == 0)
+		{
+			options.is_record_enabled = true;
+		}
+		else if(strcmp(argv[i], "-a") == 0)
+		{
+			options.is_alloc_check = true;
+		}
+		else if(strcmp(argv[i], "-o") == 0 && has_value)
+		{
+			options.report_path = argv[++i];
+		}
+		else
+		{
+			print_usage();
+			return strcmp(argv[i], "-h") == 0 ? 0 : 1;
+		}
+
+		if(!is_valid)
+		{
+			print_usage();
+			return 1;
+		}
+	}
+
+	if(options.is_alloc_check && !seeknode_alloc_is_available())
+	{
+		seeknode_alloc_print_report(stderr);
+		return 1;
+	}
+
+	std::vector<step_result_t> results;
+	uint64_t num_allocations = 0;
+	for(const int num_cameras : options.counts)
+	{
+		if(!g_keep_running)
+		{
+			break;
+		}
+
+		step_result_t result;
+		run_step(&options, num_cameras, &result);
+		if(!g_keep_running)
+		{
+			break;
+		}
+		results.push_back(result);
+		num_allocations += result.num_allocations;
+		fprintf(stdout, "step: %d cameras (fps: %.1f min, %.1f mean, skipped: %llu, latency p50: %.2f ms, p99: %.2f ms, max: %.2f ms, rss: %.1f MB, cpu: %.2f cores, max core: %.1f%%)\n",
+			result.num_cameras,
+			result.min_fps,
+			result.mean_fps,
+			(unsigned long long)result.num_skipped,
+			result.p50_ms,
+			result.p99_ms,
+			result.max_ms,
+			result.rss_mb,
+			result.process_cores,
+			result.max_core_load);
+		fflush(stdout);
+	}
+
+	fprintf(stdout, "\n");
+	write_report(stdout, &options, results);
+	if(!options.report_path.empty())
+	{
+		FILE* file = fopen(options.report_path.c_str(), "w");
+		if(file == NULL)
+		{
+			fprintf(stderr, "failed to write report: %s\n", options.report_path.c_str());
+			return 1;
+		}
+		write_report(file, &options, results);
+		fclose(file);
+	}
+
+	if(options.is_alloc_check)
+	{
+		fprintf(stdout, "allocation check: %s (%llu allocations on camera and sender threads after warmup)\n",
+			num_allocations == 0 ? "passed" : "failed",
+			(unsigned long long)num_allocations);
+		return num_allocations == 0 ? 0 : 1;
+	}
+	return 0;
+}
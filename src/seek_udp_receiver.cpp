@@ -0,0 +1,258 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Receives a camera's UDP stream (see ~udp/enabled) and reports rate, latency and loss.
+// With -l it instead runs a sender and a receiver over loopback with synthetic frames, dropping packets on purpose,
+// and checks every delivered frame byte for byte. Halfway through, the sender is reopened as after a camera reconnect
+// or a node restart (a new session, frame ids from 0 again), and the receiver must follow it.
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "seeknode/seeknode_clock.h"
+#include "seeknode/seeknode_udp.h"
+
+static std::atomic<bool> g_keep_running(true);
+
+static void signal_callback(int signum)
+{
+	(void)signum;
+	g_keep_running = false;
+}
+
+static void print_usage()
+{
+	fprintf(stdout, "Usage: seek_udp_receiver [-p port] [-r period] [-l [-n frames] [-d drop] [-f fec_group]]\n");
+	fprintf(stdout, "\t-p : UDP port (default: 5600)\n");
+	fprintf(stdout, "\t-r : Report period in seconds (default: 1)\n");
+	fprintf(stdout, "\t-l : Loopback test with synthetic 320x240 frames\n");
+	fprintf(stdout, "\t-n : Loopback frames (default: 300)\n");
+	fprintf(stdout, "\t-d : Loopback packet drop probability (default: 0.01)\n");
+	fprintf(stdout, "\t-f : Loopback FEC group size, 0 disables (default: 8)\n");
+	fprintf(stdout, "\t-h : Displays this message\n");
+}
+
+// Fills a synthetic frame whose content depends on its number.
+static void fill_frame(seeknode_udp_frame_t* frame, uint32_t number)
+{
+	seeknode_udp_frame_info_t* info = &frame->info;
+	info->format = SEEKNODE_UDP_FORMAT_THERMOGRAPHY_FLOAT;
+	info->width = 320;
+	info->height = 240;
+	info->fpa_frame_count = number;
+	info->timestamp_utc_ns = (uint64_t)number * 37000000ULL;
+	info->min_value = 20.0f;
+	info->max_value = 40.0f;
+	frame->data.resize(info->width * info->height * sizeof(float));
+	float* pixels = (float*)frame->data.data();
+	for(size_t i = 0; i < info->width * info->height; ++i)
+	{
+		pixels[i] = 20.0f + (float)((i * 7 + number * 13) % 2000) * 0.01f;
+	}
+}
+
+static void report(const seeknode_udp_receiver_t* receiver, uint64_t num_frames, double elapsed_s)
+{
+	const double packet_loss = receiver->num_fragments_expected > 0 ?
+		100.0 * (1.0 - (double)receiver->num_fragments_received / receiver->num_fragments_expected) :
+		0.0;
+	fprintf(stdout, "frames: %.1f/s (latency: %.2f ms, max: %.2f ms, assembly: %.2f ms, lost: %llu, recovered: %llu, late packets: %llu, invalid: %llu, fragment loss: %.2f%%)\n",
+		num_frames / elapsed_s,
+		receiver->num_frames > 0 ? receiver->total_latency_ms / receiver->num_frames : 0.0,
+		receiver->max_latency_ms,
+		receiver->num_frames > 0 ? receiver->total_assembly_ms / receiver->num_frames : 0.0,
+		(unsigned long long)receiver->num_lost,
+		(unsigned long long)receiver->num_recovered,
+		(unsigned long long)receiver->num_late,
+		(unsigned long long)receiver->num_invalid,
+		packet_loss);
+	fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+	signal(SIGINT, signal_callback);
+	signal(SIGTERM, signal_callback);
+
+	int port = 5600;
+	double period = 1.0;
+	bool is_loopback = false;
+	int loopback_frames = 300;
+	double drop_probability = 0.01;
+	int fec_group_size = 8;
+	for(int i = 1; i < argc; ++i)
+	{
+		const bool has_value = i < argc - 1;
+		if(strcmp(argv[i], "-p") == 0 && has_value)
+		{
+			port = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "-r") == 0 && has_value)
+		{
+			period = atof(argv[++i]);
+		}
+		else if(strcmp(argv[i], "-l") == 0)
+		{
+			is_loopback = true;
+		}
+		else if(strcmp(argv[i], "-n") == 0 && has_value)
+		{
+			loopback_frames = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "-d") == 0 && has_value)
+		{
+			drop_probability = atof(argv[++i]);
+		}
+		else if(strcmp(argv[i], "-f") == 0 && has_value)
+		{
+			fec_group_size = atoi(argv[++i]);
+		}
+		else
+		{
+			print_usage();
+			return strcmp(argv[i], "-h") == 0 ? 0 : 1;
+		}
+	}
+
+	seeknode_udp_receiver_t receiver;
+	seeknode_udp_receiver_init(&receiver);
+	if(!seeknode_udp_receiver_open(&receiver, (uint16_t)port))
+	{
+		fprintf(stderr, "failed to bind UDP port %d\n", port);
+		return 1;
+	}
+	fprintf(stdout, "listening: UDP port %d\n", port);
+
+	// Loopback sender at 27 Hz, restarted halfway like the node does on a reconnect (options copied, then opened).
+	const int restart_frame = loopback_frames / 2;
+	std::thread sender_thread;
+	if(is_loopback)
+	{
+		sender_thread = std::thread([=]() {
+			seeknode_udp_sender_t options;
+			seeknode_udp_sender_init(&options);
+			options.fec_group_size = (size_t)std::max(fec_group_size, 0);
+			options.drop_probability = drop_probability;
+
+			seeknode_udp_sender_t sender;
+			seeknode_udp_frame_t frame;
+			for(int number = 0; number < loopback_frames && g_keep_running; ++number)
+			{
+				if(number == 0 || number == restart_frame)
+				{
+					if(number > 0)
+					{
+						seeknode_udp_sender_close(&sender);
+					}
+					sender = options;
+					if(!seeknode_udp_sender_open(&sender, "127.0.0.1", (uint16_t)port))
+					{
+						fprintf(stderr, "failed to open UDP sender\n");
+						g_keep_running = false;
+						return;
+					}
+				}
+				fill_frame(&frame, (uint32_t)number);
+				seeknode_udp_sender_send(&sender, &frame.info, frame.data.data(), frame.data.size());
+				usleep(37000);
+			}
+			fprintf(stdout, "sent: %llu frames after the restart (packets: %llu, dropped on purpose: %llu, errors: %llu, %.1f MB)\n",
+				(unsigned long long)sender.num_frames,
+				(unsigned long long)sender.num_packets,
+				(unsigned long long)sender.num_dropped,
+				(unsigned long long)sender.num_errors,
+				sender.num_bytes * 1.0e-6);
+			seeknode_udp_sender_close(&sender);
+		});
+	}
+
+	seeknode_udp_frame_t frame;
+	seeknode_udp_frame_t expected;
+	uint64_t num_corrupted = 0;
+	uint64_t num_restarted = 0;      // Loopback frames delivered after the sender restart
+	int64_t report_ns = seeknode_clock_monotonic_ns();
+	uint64_t report_frames = 0;
+	int64_t last_frame_ns = report_ns;
+	while(g_keep_running)
+	{
+		const bool has_frame = seeknode_udp_receiver_receive(&receiver, &frame, 100000000LL);
+		const int64_t now_ns = seeknode_clock_monotonic_ns();
+		if(has_frame)
+		{
+			last_frame_ns = now_ns;
+			if(is_loopback)
+			{
+				fill_frame(&expected, frame.info.fpa_frame_count);
+				if(frame.data != expected.data || frame.info.width != expected.info.width || frame.info.timestamp_utc_ns != expected.info.timestamp_utc_ns)
+				{
+					++num_corrupted;
+				}
+				num_restarted += frame.info.fpa_frame_count >= (uint32_t)restart_frame ? 1 : 0;
+			}
+		}
+
+		if(now_ns - report_ns >= (int64_t)(period * 1.0e9))
+		{
+			report(&receiver, receiver.num_frames - report_frames, (now_ns - report_ns) * 1.0e-9);
+			report_ns = now_ns;
+			report_frames = receiver.num_frames;
+		}
+
+		// The loopback test ends once the sender is done and the stream went quiet.
+		if(is_loopback && now_ns - last_frame_ns > 1000000000LL)
+		{
+			break;
+		}
+	}
+
+	if(sender_thread.joinable())
+	{
+		sender_thread.join();
+	}
+	seeknode_udp_receiver_close(&receiver);
+
+	if(is_loopback)
+	{
+		// Frames after the restart must be delivered at about the rate of those before it.
+		const uint64_t num_before = receiver.num_frames - num_restarted;
+		const bool is_restart_followed = receiver.num_sessions == 2 && num_restarted * 2 >= num_before * (uint64_t)(loopback_frames - restart_frame) / (uint64_t)std::max(restart_frame, 1);
+		fprintf(stdout, "loopback: %llu of %d frames delivered (%llu of %d after the sender restart, sessions: %llu), %llu recovered by FEC, %llu corrupted\n",
+			(unsigned long long)receiver.num_frames,
+			loopback_frames,
+			(unsigned long long)num_restarted,
+			loopback_frames - restart_frame,
+			(unsigned long long)receiver.num_sessions,
+			(unsigned long long)receiver.num_recovered,
+			(unsigned long long)num_corrupted);
+		return num_corrupted == 0 && receiver.num_frames > 0 && is_restart_followed ? 0 : 1;
+	}
+	return 0;
+}
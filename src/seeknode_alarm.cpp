@@ -0,0 +1,322 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "seeknode/seeknode_alarm.h"
+#include "seeknode/seeknode_simd.h"
+
+// Highest frame rate of the supported cores; rise histories are reserved for a full window at this rate.
+static const double MAX_FRAME_RATE = 30.0;
+
+// Finds the maximum (or minimum, with negate) of a region and its location.
+// Rows are reduced with vectors; only the winning row is searched for the location.
+static float seeknode_alarm_scan_extremum(const seeknode_alarm_rule_t* rule, const float* pixels, size_t stride, bool is_min, uint16_t* out_x, uint16_t* out_y)
+{
+	const size_t width = rule->right - rule->left;
+	float best = is_min ? INFINITY : -INFINITY;
+	size_t best_y = rule->top;
+	for(size_t y = rule->top; y < rule->bottom; ++y)
+	{
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride) + rule->left;
+		float value = row[0];
+		size_t x = 0;
+		if(width >= SEEKNODE_F32X4_LANES)
+		{
+			seeknode_f32x4_t v = seeknode_f32x4_load(row);
+			for(x = SEEKNODE_F32X4_LANES; x + SEEKNODE_F32X4_LANES <= width; x += SEEKNODE_F32X4_LANES)
+			{
+				v = is_min ? seeknode_f32x4_min(v, seeknode_f32x4_load(row + x)) : seeknode_f32x4_max(v, seeknode_f32x4_load(row + x));
+			}
+			value = is_min ? seeknode_f32x4_reduce_min(v) : seeknode_f32x4_reduce_max(v);
+		}
+		for(; x < width; ++x)
+		{
+			value = is_min ? std::min(value, row[x]) : std::max(value, row[x]);
+		}
+		if(is_min ? value < best : value > best)
+		{
+			best = value;
+			best_y = y;
+		}
+	}
+
+	const float* row = (const float*)((const uint8_t*)pixels + best_y * stride) + rule->left;
+	*out_x = (uint16_t)(rule->left + (std::find(row, row + width, best) - row));
+	*out_y = (uint16_t)best_y;
+	return best;
+}
+
+// Computes the mean of a region.
+static float seeknode_alarm_scan_mean(const seeknode_alarm_rule_t* rule, const float* pixels, size_t stride)
+{
+	const size_t width = rule->right - rule->left;
+	double sum = 0.0;
+	for(size_t y = rule->top; y < rule->bottom; ++y)
+	{
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride) + rule->left;
+		seeknode_f32x4_t v = seeknode_f32x4_set1(0.0f);
+		size_t x = 0;
+		for(; x + SEEKNODE_F32X4_LANES <= width; x += SEEKNODE_F32X4_LANES)
+		{
+			v = seeknode_f32x4_add(v, seeknode_f32x4_load(row + x));
+		}
+		float row_sum = seeknode_f32x4_reduce_add(v);
+		for(; x < width; ++x)
+		{
+			row_sum += row[x];
+		}
+		sum += row_sum;
+	}
+	return (float)(sum / (double)(width * (rule->bottom - rule->top)));
+}
+
+// Updates the latched state of a rule from its value.
+// Returns true if the state changed.
+static bool seeknode_alarm_latch(seeknode_alarm_rule_t* rule, bool is_firing, bool is_cleared)
+{
+	if(!rule->is_active && is_firing)
+	{
+		rule->is_active = true;
+		return true;
+	}
+	if(rule->is_active && is_cleared)
+	{
+		rule->is_active = false;
+		return true;
+	}
+	return false;
+}
+
+void seeknode_alarm_engine_init(seeknode_alarm_engine_t* engine)
+{
+	engine->rules.clear();
+	engine->origin_x = 0;
+	engine->origin_y = 0;
+	engine->width = 0;
+	engine->height = 0;
+	engine->events.clear();
+	engine->num_frames = 0;
+	engine->num_scans = 0;
+	engine->num_skips = 0;
+}
+
+bool seeknode_alarm_type_from_str(const char* str, seeknode_alarm_type_t* type)
+{
+	if(strcmp(str, "above") == 0)
+	{
+		*type = SEEKNODE_ALARM_TYPE_ABOVE;
+	}
+	else if(strcmp(str, "below") == 0)
+	{
+		*type = SEEKNODE_ALARM_TYPE_BELOW;
+	}
+	else if(strcmp(str, "rise") == 0)
+	{
+		*type = SEEKNODE_ALARM_TYPE_RISE;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+const char* seeknode_alarm_type_get_str(seeknode_alarm_type_t type)
+{
+	switch(type)
+	{
+		case SEEKNODE_ALARM_TYPE_ABOVE:
+			return "above";
+		case SEEKNODE_ALARM_TYPE_BELOW:
+			return "below";
+		case SEEKNODE_ALARM_TYPE_RISE:
+			return "rise";
+		default:
+			return "unknown";
+	}
+}
+
+void seeknode_alarm_engine_add_rule(seeknode_alarm_engine_t* engine, const seeknode_alarm_rule_t* rule)
+{
+	engine->rules.push_back(*rule);
+
+	seeknode_alarm_rule_t* added = &engine->rules.back();
+	added->left = 0;
+	added->top = 0;
+	added->right = 0;
+	added->bottom = 0;
+	added->is_active = false;
+	added->value = NAN;
+	added->value_x = 0;
+	added->value_y = 0;
+	added->history.clear();
+	added->history.reserve(added->type == SEEKNODE_ALARM_TYPE_RISE ? (size_t)(added->window_ns * 1.0e-9 * MAX_FRAME_RATE) + 2 : 0);
+	added->history_head = 0;
+
+	// Reclip every rule on the next frame.
+	engine->width = 0;
+	engine->height = 0;
+}
+
+void seeknode_alarm_engine_configure(seeknode_alarm_engine_t* engine, size_t width, size_t height)
+{
+	seeknode_alarm_engine_configure_window(engine, 0, 0, width, height);
+}
+
+void seeknode_alarm_engine_configure_window(seeknode_alarm_engine_t* engine, size_t origin_x, size_t origin_y, size_t width, size_t height)
+{
+	if(engine->origin_x == origin_x && engine->origin_y == origin_y && engine->width == width && engine->height == height)
+	{
+		return;
+	}
+
+	engine->origin_x = origin_x;
+	engine->origin_y = origin_y;
+	engine->width = width;
+	engine->height = height;
+	for(seeknode_alarm_rule_t& rule : engine->rules)
+	{
+		const long x = (long)rule.x - (long)origin_x;
+		const long y = (long)rule.y - (long)origin_y;
+		const long right = rule.width > 0 ? x + rule.width : (long)width;
+		const long bottom = rule.height > 0 ? y + rule.height : (long)height;
+		rule.left = (size_t)std::min(std::max(x, 0L), (long)width);
+		rule.top = (size_t)std::min(std::max(y, 0L), (long)height);
+		rule.right = (size_t)std::min(std::max(right, (long)rule.left), (long)width);
+		rule.bottom = (size_t)std::min(std::max(bottom, (long)rule.top), (long)height);
+		rule.history.clear();
+		rule.history_head = 0;
+	}
+	engine->events.reserve(engine->rules.size());
+}
+
+bool seeknode_alarm_engine_process(
+	seeknode_alarm_engine_t* engine,
+	const float* pixels,
+	size_t stride,
+	float min_value,
+	float max_value,
+	int64_t timestamp_ns)
+{
+	engine->events.clear();
+	++engine->num_frames;
+
+	for(size_t i = 0; i < engine->rules.size(); ++i)
+	{
+		seeknode_alarm_rule_t* rule = &engine->rules[i];
+		if(rule->right <= rule->left || rule->bottom <= rule->top)
+		{
+			continue;
+		}
+
+		const float clear_level = rule->type == SEEKNODE_ALARM_TYPE_BELOW ? rule->threshold + rule->hysteresis : rule->threshold - rule->hysteresis;
+		bool is_changed = false;
+		switch(rule->type)
+		{
+			case SEEKNODE_ALARM_TYPE_ABOVE:
+			case SEEKNODE_ALARM_TYPE_BELOW:
+			{
+				// The frame extremum bounds the region extremum: if it cannot cross the level that would change the
+				// state, neither can the region.
+				const bool is_min = rule->type == SEEKNODE_ALARM_TYPE_BELOW;
+				const float bound = is_min ? min_value : max_value;
+				if(!rule->is_active && !(is_min ? bound < rule->threshold : bound > rule->threshold))
+				{
+					++engine->num_skips;
+					continue;
+				}
+				if(rule->is_active && (is_min ? bound > clear_level : bound < clear_level))
+				{
+					// The whole frame is back past the clear level.
+					++engine->num_skips;
+					rule->value = bound;
+					is_changed = seeknode_alarm_latch(rule, false, true);
+					break;
+				}
+
+				++engine->num_scans;
+				rule->value = seeknode_alarm_scan_extremum(rule, pixels, stride, is_min, &rule->value_x, &rule->value_y);
+				const bool is_firing = is_min ? rule->value < rule->threshold : rule->value > rule->threshold;
+				const bool is_cleared = is_min ? rule->value > clear_level : rule->value < clear_level;
+				is_changed = seeknode_alarm_latch(rule, is_firing, is_cleared);
+				break;
+			}
+			case SEEKNODE_ALARM_TYPE_RISE:
+			{
+				// The window minimum must see every frame, so rise rules always scan their region.
+				++engine->num_scans;
+				const float mean = seeknode_alarm_scan_mean(rule, pixels, stride);
+				while(rule->history.size() > rule->history_head && rule->history.back().second >= mean)
+				{
+					rule->history.pop_back();
+				}
+				// Expired entries are compacted away only when the buffer is full, so it stops growing once warm.
+				if(rule->history.size() == rule->history.capacity() && rule->history_head > 0)
+				{
+					rule->history.erase(rule->history.begin(), rule->history.begin() + rule->history_head);
+					rule->history_head = 0;
+				}
+				rule->history.push_back(std::make_pair(timestamp_ns, mean));
+				while(rule->history[rule->history_head].first < timestamp_ns - rule->window_ns)
+				{
+					++rule->history_head;
+				}
+
+				rule->value = mean - rule->history[rule->history_head].second;
+				is_changed = seeknode_alarm_latch(rule, rule->value > rule->threshold, rule->value < clear_level);
+				break;
+			}
+			default:
+				break;
+		}
+
+		if(is_changed)
+		{
+			seeknode_alarm_event_t event;
+			event.rule = i;
+			event.is_active = rule->is_active;
+			event.value = rule->value;
+			event.x = rule->value_x;
+			event.y = rule->value_y;
+			engine->events.push_back(event);
+		}
+	}
+
+	return !engine->events.empty();
+}
+
+bool seeknode_alarm_engine_is_recording(const seeknode_alarm_engine_t* engine)
+{
+	for(const seeknode_alarm_rule_t& rule : engine->rules)
+	{
+		if(rule.is_active && rule.is_recording)
+		{
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,191 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <atomic>
+
+#include "seeknode/seeknode_alloc.h"
+
+#if SEEKNODE_ALLOC_TRACKING
+#	include <errno.h>
+#	include <string.h>
+#	include <unistd.h>
+#	include <execinfo.h>
+#endif
+
+// Maximum depth of a kept call stack.
+#define MAX_STACK_DEPTH 24
+
+static std::atomic<bool> g_is_armed(false);
+static std::atomic<uint64_t> g_count(0);
+static thread_local bool t_is_tracked = false;
+
+#if SEEKNODE_ALLOC_TRACKING
+
+// Glibc entry points behind the interposed functions.
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pointer, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+extern "C" void __libc_free(void* pointer);
+
+// Call stacks of the first allocations counted; a slot is claimed by incrementing the count.
+static void* g_stacks[SEEKNODE_ALLOC_MAX_STACKS][MAX_STACK_DEPTH];
+static int g_stack_depths[SEEKNODE_ALLOC_MAX_STACKS];
+static size_t g_stack_sizes[SEEKNODE_ALLOC_MAX_STACKS];
+
+// Set while the calling thread records a call stack, which may allocate itself.
+static thread_local bool t_is_recording = false;
+
+static void count_allocation(size_t size)
+{
+	if(!t_is_tracked || t_is_recording || !g_is_armed.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	const uint64_t index = g_count.fetch_add(1, std::memory_order_relaxed);
+	if(index < SEEKNODE_ALLOC_MAX_STACKS)
+	{
+		t_is_recording = true;
+		g_stack_sizes[index] = size;
+		g_stack_depths[index] = backtrace(g_stacks[index], MAX_STACK_DEPTH);
+		t_is_recording = false;
+	}
+}
+
+extern "C" void* malloc(size_t size)
+{
+	count_allocation(size);
+	return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+	count_allocation(count * size);
+	return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* pointer, size_t size)
+{
+	count_allocation(size);
+	return __libc_realloc(pointer, size);
+}
+
+extern "C" void* memalign(size_t alignment, size_t size)
+{
+	count_allocation(size);
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size)
+{
+	count_allocation(size);
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** pointer, size_t alignment, size_t size)
+{
+	if(alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+	{
+		return EINVAL;
+	}
+	count_allocation(size);
+	*pointer = __libc_memalign(alignment, size);
+	return *pointer != NULL || size == 0 ? 0 : ENOMEM;
+}
+
+extern "C" void free(void* pointer)
+{
+	__libc_free(pointer);
+}
+
+bool seeknode_alloc_is_available()
+{
+	return true;
+}
+
+void seeknode_alloc_arm(bool is_armed)
+{
+	// The first backtrace loads the unwinder, which allocates; do it before any tracked allocation.
+	void* stack[1];
+	backtrace(stack, 1);
+
+	if(is_armed)
+	{
+		g_count = 0;
+	}
+	g_is_armed = is_armed;
+}
+
+void seeknode_alloc_print_report(FILE* file)
+{
+	const uint64_t count = g_count.load();
+	fprintf(file, "allocations on tracked threads: %llu\n", (unsigned long long)count);
+	fflush(file);
+	for(uint64_t i = 0; i < count && i < SEEKNODE_ALLOC_MAX_STACKS; ++i)
+	{
+		fprintf(file, "allocation %llu (%zu bytes):\n", (unsigned long long)i, g_stack_sizes[i]);
+		fflush(file);
+		backtrace_symbols_fd(g_stacks[i], g_stack_depths[i], fileno(file));
+	}
+}
+
+#else
+
+bool seeknode_alloc_is_available()
+{
+	return false;
+}
+
+void seeknode_alloc_arm(bool is_armed)
+{
+	g_is_armed = is_armed;
+}
+
+void seeknode_alloc_print_report(FILE* file)
+{
+	fprintf(file, "allocation tracking is not compiled in (SEEKNODE_ALLOC_TRACKING)\n");
+}
+
+#endif
+
+void seeknode_alloc_track_thread(bool is_tracked)
+{
+	t_is_tracked = is_tracked;
+}
+
+uint64_t seeknode_alloc_get_count()
+{
+	return g_count.load();
+}
+
+seeknode_alloc_pause_t::seeknode_alloc_pause_t() :
+	was_tracked(t_is_tracked)
+{
+	t_is_tracked = false;
+}
+
+seeknode_alloc_pause_t::~seeknode_alloc_pause_t()
+{
+	t_is_tracked = was_tracked;
+}
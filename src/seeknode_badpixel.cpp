@@ -0,0 +1,607 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "seeknode/seeknode_badpixel.h"
+#include "seeknode/seeknode_simd.h"
+
+// File format: magic, version, width, height, count, then count pixel indices (little endian uint32).
+// Fields are serialized byte by byte so maps can be moved between hosts of either byte order.
+static const uint32_t BADPIXEL_FILE_MAGIC = 0x50424b53; // "SKBP"
+static const uint32_t BADPIXEL_FILE_VERSION = 1;
+
+// Only every n-th residual is used to estimate the spread of the residuals of a frame.
+static const size_t RESIDUAL_SUBSAMPLING = 7;
+
+// Scales a median absolute deviation to a standard deviation for normally distributed data.
+static const float MAD_TO_SIGMA = 1.4826f;
+
+// Gets a pixel of a frame with a byte stride.
+static inline float seeknode_badpixel_at(const float* pixels, size_t stride, size_t x, size_t y)
+{
+	return ((const float*)((const uint8_t*)pixels + y * stride))[x];
+}
+
+// Sorts a few values in place and returns their median.
+static inline float seeknode_badpixel_median(float* values, size_t count)
+{
+	// Insertion sort; count is at most 24.
+	for(size_t j = 1; j < count; ++j)
+	{
+		const float value = values[j];
+		size_t k = j;
+		for(; k > 0 && values[k - 1] > value; --k)
+		{
+			values[k] = values[k - 1];
+		}
+		values[k] = value;
+	}
+	return (count % 2 == 1) ? values[count / 2] : 0.5f * (values[count / 2 - 1] + values[count / 2]);
+}
+
+// Resolves the good neighbours of every flagged pixel.
+// The 3x3 neighbourhood is used when it has any good pixel; clusters fall back to the 5x5 neighbourhood.
+static void seeknode_badpixel_build_index(seeknode_badpixel_t* badpixel)
+{
+	const int width = (int)badpixel->width;
+	const int height = (int)badpixel->height;
+
+	badpixel->bad.clear();
+	badpixel->offsets.clear();
+	badpixel->neighbours.clear();
+	badpixel->isolated.clear();
+	badpixel->clustered.clear();
+
+	for(int y = 0; y < height; ++y)
+	{
+		for(int x = 0; x < width; ++x)
+		{
+			if(badpixel->bitmap[y * width + x] == 0)
+			{
+				continue;
+			}
+
+			badpixel->bad.push_back((uint32_t)(y * width + x));
+			badpixel->offsets.push_back((uint32_t)badpixel->neighbours.size());
+
+			int radius = 1;
+			for(; radius <= 2; ++radius)
+			{
+				for(int dy = -radius; dy <= radius; ++dy)
+				{
+					for(int dx = -radius; dx <= radius; ++dx)
+					{
+						const int nx = x + dx;
+						const int ny = y + dy;
+						if((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= width || ny >= height)
+						{
+							continue;
+						}
+						if(badpixel->bitmap[ny * width + nx] == 0)
+						{
+							badpixel->neighbours.push_back((uint32_t)(ny * width + nx));
+						}
+					}
+				}
+				if(badpixel->neighbours.size() > badpixel->offsets.back())
+				{
+					break;
+				}
+			}
+
+			const uint32_t entry = (uint32_t)badpixel->bad.size() - 1;
+			if(radius == 1 && badpixel->neighbours.size() - badpixel->offsets.back() == 8)
+			{
+				badpixel->isolated.push_back(entry);
+			}
+			else
+			{
+				badpixel->clustered.push_back(entry);
+			}
+		}
+	}
+	badpixel->offsets.push_back((uint32_t)badpixel->neighbours.size());
+	badpixel->has_map = true;
+}
+
+// Builds the bitmap from the learning statistics.
+static void seeknode_badpixel_finish_learning(seeknode_badpixel_t* badpixel)
+{
+	const size_t num_pixels = badpixel->width * badpixel->height;
+	const size_t n = badpixel->learned_frames;
+
+	// Median temporal variance of the array.
+	badpixel->scratch.resize(num_pixels);
+	for(size_t i = 0; i < num_pixels; ++i)
+	{
+		badpixel->scratch[i] = badpixel->m2[i] / (float)(n - 1);
+	}
+	std::nth_element(badpixel->scratch.begin(), badpixel->scratch.begin() + num_pixels / 2, badpixel->scratch.end());
+	const float median_variance = badpixel->scratch[num_pixels / 2];
+
+	const uint32_t max_outliers = (uint32_t)(badpixel->outlier_fraction * n);
+	for(size_t i = 0; i < num_pixels; ++i)
+	{
+		const float variance = badpixel->m2[i] / (float)(n - 1);
+		const bool is_outlier = badpixel->outliers[i] > max_outliers;
+		const bool is_stuck = median_variance > 0.0f && variance < badpixel->stuck_ratio * median_variance;
+		const bool is_flickering = median_variance > 0.0f && variance > badpixel->flicker_ratio * median_variance;
+		badpixel->bitmap[i] = (is_outlier || is_stuck || is_flickering) ? 1 : 0;
+	}
+
+	seeknode_badpixel_build_index(badpixel);
+
+	// Release the learning state.
+	badpixel->learned_frames = 0;
+	std::vector<float>().swap(badpixel->mean);
+	std::vector<float>().swap(badpixel->m2);
+	std::vector<uint16_t>().swap(badpixel->outliers);
+	std::vector<float>().swap(badpixel->residuals);
+	std::vector<float>().swap(badpixel->scratch);
+}
+
+void seeknode_badpixel_init(seeknode_badpixel_t* badpixel)
+{
+	badpixel->learn_frames = 300;
+	badpixel->outlier_sigma = 6.0f;
+	badpixel->outlier_fraction = 0.5f;
+	badpixel->stuck_ratio = 0.01f;
+	badpixel->flicker_ratio = 25.0f;
+	badpixel->width = 0;
+	badpixel->height = 0;
+	badpixel->bitmap.clear();
+	badpixel->has_map = false;
+	badpixel->bad.clear();
+	badpixel->offsets.clear();
+	badpixel->neighbours.clear();
+	badpixel->isolated.clear();
+	badpixel->clustered.clear();
+	badpixel->learned_frames = 0;
+	badpixel->mean.clear();
+	badpixel->m2.clear();
+	badpixel->outliers.clear();
+	badpixel->residuals.clear();
+	badpixel->scratch.clear();
+}
+
+void seeknode_badpixel_configure(seeknode_badpixel_t* badpixel, size_t width, size_t height)
+{
+	if(badpixel->width == width && badpixel->height == height)
+	{
+		return;
+	}
+
+	const bool was_learning = seeknode_badpixel_is_learning(badpixel);
+	badpixel->width = width;
+	badpixel->height = height;
+	badpixel->bitmap.assign(width * height, 0);
+	badpixel->has_map = false;
+	badpixel->bad.clear();
+	badpixel->offsets.clear();
+	badpixel->neighbours.clear();
+	badpixel->isolated.clear();
+	badpixel->clustered.clear();
+	if(was_learning)
+	{
+		seeknode_badpixel_start_learning(badpixel);
+	}
+}
+
+void seeknode_badpixel_start_learning(seeknode_badpixel_t* badpixel)
+{
+	const size_t num_pixels = badpixel->width * badpixel->height;
+	badpixel->learned_frames = 0;
+	badpixel->mean.assign(num_pixels, 0.0f);
+	badpixel->m2.assign(num_pixels, 0.0f);
+	badpixel->outliers.assign(num_pixels, 0);
+	badpixel->residuals.assign(num_pixels, 0.0f);
+	badpixel->scratch.reserve(num_pixels);
+}
+
+bool seeknode_badpixel_is_learning(const seeknode_badpixel_t* badpixel)
+{
+	return !badpixel->mean.empty();
+}
+
+bool seeknode_badpixel_learn(seeknode_badpixel_t* badpixel, const float* pixels, size_t stride)
+{
+	const size_t width = badpixel->width;
+	const size_t height = badpixel->height;
+	if(!seeknode_badpixel_is_learning(badpixel) || width < 3 || height < 3)
+	{
+		return false;
+	}
+
+	// Temporal statistics (Welford).
+	const float n = (float)(badpixel->learned_frames + 1);
+	for(size_t y = 0; y < height; ++y)
+	{
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride);
+		float* mean = badpixel->mean.data() + y * width;
+		float* m2 = badpixel->m2.data() + y * width;
+		for(size_t x = 0; x < width; ++x)
+		{
+			const float delta = row[x] - mean[x];
+			mean[x] += delta / n;
+			m2[x] += delta * (row[x] - mean[x]);
+		}
+	}
+
+	// Spatial residuals against the median of the 8-neighbours (clamped at the borders).
+	// The median keeps a defect from turning its neighbours into outliers as well.
+	float* residuals = badpixel->residuals.data();
+	float values[8];
+	for(size_t y = 0; y < height; ++y)
+	{
+		const size_t rows[3] = { y > 0 ? y - 1 : y + 1, y, y + 1 < height ? y + 1 : y - 1 };
+		for(size_t x = 0; x < width; ++x)
+		{
+			const size_t columns[3] = { x > 0 ? x - 1 : x + 1, x, x + 1 < width ? x + 1 : x - 1 };
+			size_t count = 0;
+			for(size_t j = 0; j < 3; ++j)
+			{
+				for(size_t i = 0; i < 3; ++i)
+				{
+					if(i != 1 || j != 1)
+					{
+						values[count++] = seeknode_badpixel_at(pixels, stride, columns[i], rows[j]);
+					}
+				}
+			}
+			residuals[y * width + x] = seeknode_badpixel_at(pixels, stride, x, y) - seeknode_badpixel_median(values, count);
+		}
+	}
+
+	// Robust spread of the residuals from a subsample.
+	badpixel->scratch.clear();
+	for(size_t i = 0; i < width * height; i += RESIDUAL_SUBSAMPLING)
+	{
+		badpixel->scratch.push_back(fabsf(residuals[i]));
+	}
+	const size_t median_index = badpixel->scratch.size() / 2;
+	std::nth_element(badpixel->scratch.begin(), badpixel->scratch.begin() + median_index, badpixel->scratch.end());
+	const float sigma = std::max(badpixel->scratch[median_index] * MAD_TO_SIGMA, 1.0e-3f);
+
+	const float limit = badpixel->outlier_sigma * sigma;
+	for(size_t i = 0; i < width * height; ++i)
+	{
+		if(fabsf(residuals[i]) > limit && badpixel->outliers[i] < UINT16_MAX)
+		{
+			++badpixel->outliers[i];
+		}
+	}
+
+	++badpixel->learned_frames;
+	if(badpixel->learned_frames < std::max(badpixel->learn_frames, (size_t)2))
+	{
+		return false;
+	}
+
+	seeknode_badpixel_finish_learning(badpixel);
+	return true;
+}
+
+void seeknode_badpixel_apply(const seeknode_badpixel_t* badpixel, float* pixels, size_t stride)
+{
+	seeknode_badpixel_apply_window(badpixel, pixels, stride, 0, 0, badpixel->width, badpixel->height);
+}
+
+// Replaces entry i of the index with the median of its neighbours inside the window [x0, x1) x [y0, y1).
+static void seeknode_badpixel_replace(const seeknode_badpixel_t* badpixel, size_t i, float* pixels, size_t stride, size_t x0, size_t y0, size_t x1, size_t y1)
+{
+	const size_t sensor_width = badpixel->width;
+	const uint32_t index = badpixel->bad[i];
+	const size_t x = index % sensor_width;
+	const size_t y = index / sensor_width;
+	if(x < x0 || x >= x1 || y < y0 || y >= y1)
+	{
+		return;
+	}
+
+	float values[24];
+	size_t count = 0;
+	for(uint32_t j = badpixel->offsets[i]; j < badpixel->offsets[i + 1]; ++j)
+	{
+		const uint32_t neighbour = badpixel->neighbours[j];
+		const size_t nx = neighbour % sensor_width;
+		const size_t ny = neighbour / sensor_width;
+		if(nx >= x0 && nx < x1 && ny >= y0 && ny < y1)
+		{
+			values[count++] = seeknode_badpixel_at(pixels, stride, nx - x0, ny - y0);
+		}
+	}
+	if(count == 0)
+	{
+		return;
+	}
+
+	((float*)((uint8_t*)pixels + (y - y0) * stride))[x - x0] = seeknode_badpixel_median(values, count);
+}
+
+// Orders two vectors lane by lane.
+static inline void seeknode_badpixel_sort2(seeknode_f32x4_t* a, seeknode_f32x4_t* b)
+{
+	const seeknode_f32x4_t lo = seeknode_f32x4_min(*a, *b);
+	*b = seeknode_f32x4_max(*a, *b);
+	*a = lo;
+}
+
+void seeknode_badpixel_apply_window(const seeknode_badpixel_t* badpixel, float* pixels, size_t stride, size_t x0, size_t y0, size_t width, size_t height)
+{
+	const size_t sensor_width = badpixel->width;
+	const size_t x1 = x0 + width;
+	const size_t y1 = y0 + height;
+
+	// Neighbours are read from the frame; they are all good pixels so the order of replacement does not matter.
+	// Isolated defects whose 3x3 neighbourhood lies in the window are gathered four at a time, one per lane, and their
+	// median is the mean of the middle two outputs of a sorting network over the 8 neighbours.
+	const size_t num_isolated = badpixel->isolated.size();
+	size_t i = 0;
+	for(; i + SEEKNODE_F32X4_LANES <= num_isolated; i += SEEKNODE_F32X4_LANES)
+	{
+		float* targets[SEEKNODE_F32X4_LANES];
+		float values[8][SEEKNODE_F32X4_LANES];
+		bool is_inside = true;
+		for(size_t lane = 0; lane < SEEKNODE_F32X4_LANES; ++lane)
+		{
+			const uint32_t index = badpixel->bad[badpixel->isolated[i + lane]];
+			const size_t x = index % sensor_width;
+			const size_t y = index / sensor_width;
+			if(x <= x0 || x + 1 >= x1 || y <= y0 || y + 1 >= y1)
+			{
+				is_inside = false;
+				break;
+			}
+
+			float* row = (float*)((uint8_t*)pixels + (y - y0) * stride) + (x - x0);
+			const float* above = (const float*)((const uint8_t*)row - stride);
+			const float* below = (const float*)((const uint8_t*)row + stride);
+			values[0][lane] = above[-1];
+			values[1][lane] = above[0];
+			values[2][lane] = above[1];
+			values[3][lane] = row[-1];
+			values[4][lane] = row[1];
+			values[5][lane] = below[-1];
+			values[6][lane] = below[0];
+			values[7][lane] = below[1];
+			targets[lane] = row;
+		}
+		if(!is_inside)
+		{
+			for(size_t lane = 0; lane < SEEKNODE_F32X4_LANES; ++lane)
+			{
+				seeknode_badpixel_replace(badpixel, badpixel->isolated[i + lane], pixels, stride, x0, y0, x1, y1);
+			}
+			continue;
+		}
+
+		seeknode_f32x4_t v[8];
+		for(int k = 0; k < 8; ++k)
+		{
+			v[k] = seeknode_f32x4_load(values[k]);
+		}
+
+		// Batcher odd-even merge sort of 8 elements (19 comparators).
+		seeknode_badpixel_sort2(&v[0], &v[1]);
+		seeknode_badpixel_sort2(&v[2], &v[3]);
+		seeknode_badpixel_sort2(&v[4], &v[5]);
+		seeknode_badpixel_sort2(&v[6], &v[7]);
+		seeknode_badpixel_sort2(&v[0], &v[2]);
+		seeknode_badpixel_sort2(&v[1], &v[3]);
+		seeknode_badpixel_sort2(&v[4], &v[6]);
+		seeknode_badpixel_sort2(&v[5], &v[7]);
+		seeknode_badpixel_sort2(&v[1], &v[2]);
+		seeknode_badpixel_sort2(&v[5], &v[6]);
+		seeknode_badpixel_sort2(&v[0], &v[4]);
+		seeknode_badpixel_sort2(&v[1], &v[5]);
+		seeknode_badpixel_sort2(&v[2], &v[6]);
+		seeknode_badpixel_sort2(&v[3], &v[7]);
+		seeknode_badpixel_sort2(&v[2], &v[4]);
+		seeknode_badpixel_sort2(&v[3], &v[5]);
+		seeknode_badpixel_sort2(&v[1], &v[2]);
+		seeknode_badpixel_sort2(&v[3], &v[4]);
+		seeknode_badpixel_sort2(&v[5], &v[6]);
+
+		float medians[SEEKNODE_F32X4_LANES];
+		seeknode_f32x4_store(medians, seeknode_f32x4_mul(seeknode_f32x4_add(v[3], v[4]), seeknode_f32x4_set1(0.5f)));
+		for(size_t lane = 0; lane < SEEKNODE_F32X4_LANES; ++lane)
+		{
+			*targets[lane] = medians[lane];
+		}
+	}
+	for(; i < num_isolated; ++i)
+	{
+		seeknode_badpixel_replace(badpixel, badpixel->isolated[i], pixels, stride, x0, y0, x1, y1);
+	}
+
+	for(uint32_t entry : badpixel->clustered)
+	{
+		seeknode_badpixel_replace(badpixel, entry, pixels, stride, x0, y0, x1, y1);
+	}
+}
+
+void seeknode_badpixel_update_header(seekcamera_frame_header_t* header, const float* pixels, size_t stride, size_t x0, size_t y0, size_t width, size_t height)
+{
+	if(width == 0 || height == 0)
+	{
+		return;
+	}
+
+	// Find the rows holding the extrema with a vector pass, then locate them within those rows.
+	float min_value = INFINITY;
+	float max_value = -INFINITY;
+	size_t min_row = 0;
+	size_t max_row = 0;
+	for(size_t y = 0; y < height; ++y)
+	{
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride);
+		float row_min = row[0];
+		float row_max = row[0];
+		size_t x = 0;
+		if(width >= SEEKNODE_F32X4_LANES)
+		{
+			seeknode_f32x4_t v_min = seeknode_f32x4_load(row);
+			seeknode_f32x4_t v_max = v_min;
+			for(x = SEEKNODE_F32X4_LANES; x + SEEKNODE_F32X4_LANES <= width; x += SEEKNODE_F32X4_LANES)
+			{
+				const seeknode_f32x4_t v = seeknode_f32x4_load(row + x);
+				v_min = seeknode_f32x4_min(v_min, v);
+				v_max = seeknode_f32x4_max(v_max, v);
+			}
+			row_min = seeknode_f32x4_reduce_min(v_min);
+			row_max = seeknode_f32x4_reduce_max(v_max);
+		}
+		for(; x < width; ++x)
+		{
+			row_min = std::min(row_min, row[x]);
+			row_max = std::max(row_max, row[x]);
+		}
+		if(row_min < min_value)
+		{
+			min_value = row_min;
+			min_row = y;
+		}
+		if(row_max > max_value)
+		{
+			max_value = row_max;
+			max_row = y;
+		}
+	}
+
+	const float* row = (const float*)((const uint8_t*)pixels + min_row * stride);
+	header->thermography_min_x = (uint16_t)(x0 + (std::find(row, row + width, min_value) - row));
+	header->thermography_min_y = (uint16_t)(y0 + min_row);
+	header->thermography_min_value = min_value;
+
+	row = (const float*)((const uint8_t*)pixels + max_row * stride);
+	header->thermography_max_x = (uint16_t)(x0 + (std::find(row, row + width, max_value) - row));
+	header->thermography_max_y = (uint16_t)(y0 + max_row);
+	header->thermography_max_value = max_value;
+
+	const size_t spot_x = header->thermography_spot_x;
+	const size_t spot_y = header->thermography_spot_y;
+	if(spot_x >= x0 && spot_x < x0 + width && spot_y >= y0 && spot_y < y0 + height)
+	{
+		header->thermography_spot_value = seeknode_badpixel_at(pixels, stride, spot_x - x0, spot_y - y0);
+	}
+}
+
+// Reads count little endian uint32 values.
+static bool seeknode_badpixel_read_u32(FILE* file, uint32_t* values, size_t count)
+{
+	uint8_t bytes[4];
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(fread(bytes, 1, 4, file) != 4)
+		{
+			return false;
+		}
+		values[i] = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	}
+	return true;
+}
+
+// Writes count uint32 values as little endian.
+static bool seeknode_badpixel_write_u32(FILE* file, const uint32_t* values, size_t count)
+{
+	uint8_t bytes[4];
+	for(size_t i = 0; i < count; ++i)
+	{
+		bytes[0] = (uint8_t)values[i];
+		bytes[1] = (uint8_t)(values[i] >> 8);
+		bytes[2] = (uint8_t)(values[i] >> 16);
+		bytes[3] = (uint8_t)(values[i] >> 24);
+		if(fwrite(bytes, 1, 4, file) != 4)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool seeknode_badpixel_load(seeknode_badpixel_t* badpixel, const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if(file == NULL)
+	{
+		return false;
+	}
+
+	uint32_t fields[5] = { 0 };
+	bool is_valid = seeknode_badpixel_read_u32(file, fields, 5);
+	is_valid = is_valid && fields[0] == BADPIXEL_FILE_MAGIC && fields[1] == BADPIXEL_FILE_VERSION;
+	is_valid = is_valid && fields[2] == badpixel->width && fields[3] == badpixel->height;
+
+	std::vector<uint32_t> indices(is_valid ? fields[4] : 0);
+	is_valid = is_valid && seeknode_badpixel_read_u32(file, indices.data(), indices.size());
+	fclose(file);
+
+	if(!is_valid)
+	{
+		return false;
+	}
+
+	const size_t num_pixels = badpixel->width * badpixel->height;
+	badpixel->bitmap.assign(num_pixels, 0);
+	for(uint32_t index : indices)
+	{
+		if(index < num_pixels)
+		{
+			badpixel->bitmap[index] = 1;
+		}
+	}
+
+	seeknode_badpixel_build_index(badpixel);
+	return true;
+}
+
+bool seeknode_badpixel_save(const seeknode_badpixel_t* badpixel, const char* path)
+{
+	if(!badpixel->has_map)
+	{
+		return false;
+	}
+
+	FILE* file = fopen(path, "wb");
+	if(file == NULL)
+	{
+		return false;
+	}
+
+	const uint32_t fields[5] = {
+		BADPIXEL_FILE_MAGIC,
+		BADPIXEL_FILE_VERSION,
+		(uint32_t)badpixel->width,
+		(uint32_t)badpixel->height,
+		(uint32_t)badpixel->bad.size(),
+	};
+	bool is_valid = seeknode_badpixel_write_u32(file, fields, 5);
+	is_valid = is_valid && seeknode_badpixel_write_u32(file, badpixel->bad.data(), badpixel->bad.size());
+	is_valid = (fclose(file) == 0) && is_valid;
+	return is_valid;
+}
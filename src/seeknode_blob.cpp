@@ -0,0 +1,289 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "seeknode/seeknode_blob.h"
+#include "seeknode/seeknode_simd.h"
+
+// Thresholds a row into packed mask words (bit x is set when pixel x is above the threshold).
+static void seeknode_blob_threshold_row(const float* row, size_t width, float threshold, uint64_t* words)
+{
+	const seeknode_f32x4_t t = seeknode_f32x4_set1(threshold);
+
+	size_t x = 0;
+	size_t word = 0;
+	for(; x + 64 <= width; x += 64, ++word)
+	{
+		uint64_t bits = 0;
+		for(size_t i = 0; i < 64; i += SEEKNODE_F32X4_LANES)
+		{
+			bits |= (uint64_t)seeknode_f32x4_cmpgt_mask(seeknode_f32x4_load(row + x + i), t) << i;
+		}
+		words[word] = bits;
+	}
+
+	// Partial last word; bits past the width stay clear.
+	if(x < width)
+	{
+		uint64_t bits = 0;
+		size_t i = 0;
+		for(; x + i + SEEKNODE_F32X4_LANES <= width; i += SEEKNODE_F32X4_LANES)
+		{
+			bits |= (uint64_t)seeknode_f32x4_cmpgt_mask(seeknode_f32x4_load(row + x + i), t) << i;
+		}
+		for(; x + i < width; ++i)
+		{
+			bits |= (row[x + i] > threshold) ? (1ull << i) : 0ull;
+		}
+		words[word] = bits;
+	}
+}
+
+// Finds the root of a run with path halving.
+static inline uint32_t seeknode_blob_find(uint32_t* parent, uint32_t i)
+{
+	while(parent[i] != i)
+	{
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+// Merges the sets of two runs; the root is always the earliest run.
+static inline void seeknode_blob_union(uint32_t* parent, uint32_t a, uint32_t b)
+{
+	a = seeknode_blob_find(parent, a);
+	b = seeknode_blob_find(parent, b);
+	if(a < b)
+	{
+		parent[b] = a;
+	}
+	else if(b < a)
+	{
+		parent[a] = b;
+	}
+}
+
+void seeknode_blob_detector_init(seeknode_blob_detector_t* detector)
+{
+	detector->threshold = NAN;
+	detector->min_area = 1;
+	detector->max_blobs = 64;
+	detector->connectivity_8 = true;
+	detector->blobs.clear();
+	detector->width = 0;
+	detector->height = 0;
+	detector->mask_words_per_row = 0;
+}
+
+void seeknode_blob_detector_configure(seeknode_blob_detector_t* detector, size_t width, size_t height)
+{
+	if(detector->width == width && detector->height == height)
+	{
+		return;
+	}
+
+	detector->width = width;
+	detector->height = height;
+	detector->mask_words_per_row = (width + 63) / 64;
+	detector->mask.assign(detector->mask_words_per_row * height, 0);
+
+	// A checkerboard row has the most runs; reserving for it keeps the frame path free of reallocations.
+	const size_t max_runs = height * ((width + 1) / 2);
+	detector->runs.reserve(max_runs);
+	detector->row_start.assign(height + 1, 0);
+	detector->parent.reserve(max_runs);
+	detector->blob_index.reserve(max_runs);
+	detector->accumulators.reserve(max_runs);
+	detector->blobs.reserve(max_runs);
+}
+
+void seeknode_blob_detector_process(seeknode_blob_detector_t* detector, const float* pixels, size_t stride)
+{
+	const size_t width = detector->width;
+	const size_t height = detector->height;
+	const size_t words_per_row = detector->mask_words_per_row;
+
+	detector->blobs.clear();
+	detector->runs.clear();
+	if(isnan(detector->threshold))
+	{
+		return;
+	}
+
+	// Pass 1: threshold and extract runs.
+	// Run boundaries are the set bits of mask ^ (mask << 1), carried across word boundaries.
+	for(size_t y = 0; y < height; ++y)
+	{
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride);
+		uint64_t* words = detector->mask.data() + y * words_per_row;
+		seeknode_blob_threshold_row(row, width, detector->threshold, words);
+
+		detector->row_start[y] = detector->runs.size();
+
+		bool in_run = false;
+		size_t start = 0;
+		uint64_t carry = 0;
+		for(size_t w = 0; w < words_per_row; ++w)
+		{
+			const uint64_t bits = words[w];
+			uint64_t edges = bits ^ ((bits << 1) | carry);
+			carry = bits >> 63;
+			while(edges != 0)
+			{
+				const size_t x = w * 64 + (size_t)__builtin_ctzll(edges);
+				if(!in_run)
+				{
+					start = x;
+				}
+				else
+				{
+					detector->runs.push_back({ (uint16_t)y, (uint16_t)start, (uint16_t)x });
+				}
+				in_run = !in_run;
+				edges &= edges - 1;
+			}
+		}
+		if(in_run)
+		{
+			detector->runs.push_back({ (uint16_t)y, (uint16_t)start, (uint16_t)width });
+		}
+	}
+	detector->row_start[height] = detector->runs.size();
+
+	const size_t num_runs = detector->runs.size();
+	if(num_runs == 0)
+	{
+		return;
+	}
+
+	// Pass 2: merge runs overlapping on consecutive rows.
+	// Both rows are sorted by x so a single forward sweep finds every overlap.
+	const seeknode_blob_run_t* runs = detector->runs.data();
+	detector->parent.resize(num_runs);
+	uint32_t* parent = detector->parent.data();
+	for(size_t i = 0; i < num_runs; ++i)
+	{
+		parent[i] = (uint32_t)i;
+	}
+
+	const int d = detector->connectivity_8 ? 1 : 0;
+	for(size_t y = 1; y < height; ++y)
+	{
+		const size_t prev_end = detector->row_start[y];
+		const size_t cur_end = detector->row_start[y + 1];
+		size_t p = detector->row_start[y - 1];
+		for(size_t c = prev_end; c < cur_end; ++c)
+		{
+			while(p < prev_end && (int)runs[p].x1 + d <= (int)runs[c].x0)
+			{
+				++p;
+			}
+			for(size_t q = p; q < prev_end && (int)runs[q].x0 < (int)runs[c].x1 + d; ++q)
+			{
+				seeknode_blob_union(parent, (uint32_t)c, (uint32_t)q);
+			}
+		}
+	}
+
+	// Pass 3: accumulate statistics per set.
+	detector->blob_index.assign(num_runs, -1);
+	detector->accumulators.clear();
+	for(size_t i = 0; i < num_runs; ++i)
+	{
+		const uint32_t root = seeknode_blob_find(parent, (uint32_t)i);
+		int32_t index = detector->blob_index[root];
+		if(index < 0)
+		{
+			index = (int32_t)detector->accumulators.size();
+			detector->blob_index[root] = index;
+
+			seeknode_blob_accumulator_t accumulator = {};
+			accumulator.min_x = UINT16_MAX;
+			accumulator.min_y = UINT16_MAX;
+			accumulator.peak_value = -INFINITY;
+			detector->accumulators.push_back(accumulator);
+		}
+
+		const seeknode_blob_run_t& run = runs[i];
+		seeknode_blob_accumulator_t& accumulator = detector->accumulators[index];
+		const uint32_t length = run.x1 - run.x0;
+		const float* row = (const float*)((const uint8_t*)pixels + run.y * stride);
+
+		accumulator.area += length;
+		accumulator.sum_x += 0.5 * (double)(run.x0 + run.x1 - 1) * length;
+		accumulator.sum_y += (double)run.y * length;
+		accumulator.min_x = std::min(accumulator.min_x, run.x0);
+		accumulator.max_x = std::max(accumulator.max_x, (uint16_t)(run.x1 - 1));
+		accumulator.min_y = std::min(accumulator.min_y, run.y);
+		accumulator.max_y = std::max(accumulator.max_y, run.y);
+		for(uint16_t x = run.x0; x < run.x1; ++x)
+		{
+			accumulator.sum_value += row[x];
+			if(row[x] > accumulator.peak_value)
+			{
+				accumulator.peak_value = row[x];
+				accumulator.peak_x = x;
+				accumulator.peak_y = run.y;
+			}
+		}
+	}
+
+	for(const auto& accumulator : detector->accumulators)
+	{
+		if(accumulator.area < detector->min_area)
+		{
+			continue;
+		}
+
+		seeknode_blob_t blob;
+		blob.area = accumulator.area;
+		blob.centroid_x = (float)(accumulator.sum_x / accumulator.area);
+		blob.centroid_y = (float)(accumulator.sum_y / accumulator.area);
+		blob.bbox_x = accumulator.min_x;
+		blob.bbox_y = accumulator.min_y;
+		blob.bbox_width = (uint16_t)(accumulator.max_x - accumulator.min_x + 1);
+		blob.bbox_height = (uint16_t)(accumulator.max_y - accumulator.min_y + 1);
+		blob.peak_x = accumulator.peak_x;
+		blob.peak_y = accumulator.peak_y;
+		blob.peak_value = accumulator.peak_value;
+		blob.mean_value = (float)(accumulator.sum_value / accumulator.area);
+		detector->blobs.push_back(blob);
+	}
+
+	// Keep the hottest blobs.
+	auto hotter = [](const seeknode_blob_t& a, const seeknode_blob_t& b) { return a.peak_value > b.peak_value; };
+	if(detector->blobs.size() > detector->max_blobs)
+	{
+		std::partial_sort(detector->blobs.begin(), detector->blobs.begin() + detector->max_blobs, detector->blobs.end(), hotter);
+		detector->blobs.resize(detector->max_blobs);
+	}
+	else
+	{
+		std::sort(detector->blobs.begin(), detector->blobs.end(), hotter);
+	}
+}
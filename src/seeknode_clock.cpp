@@ -0,0 +1,208 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+#include <time.h>
+
+#include "seeknode/seeknode_clock.h"
+
+// Initial parameter variances.
+// The offset is known to within the first arrival delay; the drift is unknown but small (crystal tolerances are tens of ppm).
+static const double INITIAL_OFFSET_VARIANCE = 1.0e-2;
+static const double INITIAL_DRIFT_VARIANCE = 1.0e-6;
+
+// Smoothing factor of the jitter estimate.
+static const double JITTER_SMOOTHING = 0.01;
+
+// Lower bound of the jitter estimate.
+// Keeps the outlier test meaningful when arrivals are perfectly regular (e.g. simulated cameras).
+static const double MIN_JITTER_S = 10.0e-6;
+
+void seeknode_clock_init(seeknode_clock_t* clock)
+{
+	clock->forgetting_factor = 0.9995;
+	clock->outlier_threshold = 3.0;
+	clock->reset_threshold_s = 0.5;
+	clock->reset_count = 5;
+	clock->warmup_samples = 50;
+	clock->envelope_window_ns = 2000000000LL;
+	clock->latency_ns = 0;
+	clock->num_resets = 0;
+
+	seeknode_clock_reset(clock);
+}
+
+void seeknode_clock_reset(seeknode_clock_t* clock)
+{
+	clock->has_reference = false;
+	clock->camera_ref_ns = 0;
+	clock->host_ref_ns = 0;
+
+	clock->offset_s = 0.0;
+	clock->drift = 0.0;
+	clock->covariance[0][0] = INITIAL_OFFSET_VARIANCE;
+	clock->covariance[0][1] = 0.0;
+	clock->covariance[1][0] = 0.0;
+	clock->covariance[1][1] = INITIAL_DRIFT_VARIANCE;
+	clock->jitter_s = 0.0;
+
+	clock->envelope_start_ns = 0;
+	clock->envelope_min_s = INFINITY;
+	clock->previous_min_s = INFINITY;
+	clock->envelope_s = 0.0;
+
+	clock->num_samples = 0;
+	clock->num_outliers = 0;
+	clock->num_jumps = 0;
+}
+
+void seeknode_clock_update(seeknode_clock_t* clock, uint64_t camera_ns, int64_t host_ns)
+{
+	// The first sample defines the reference point.
+	// Both clocks are expressed relative to it so the filter works on small, well conditioned numbers.
+	if(!clock->has_reference)
+	{
+		clock->has_reference = true;
+		clock->camera_ref_ns = camera_ns;
+		clock->host_ref_ns = host_ns;
+		clock->envelope_start_ns = host_ns;
+		clock->num_samples = 1;
+		return;
+	}
+
+	// Regressor is [1, t] and the observation is the clock difference relative to the reference.
+	const double t = (double)(int64_t)(camera_ns - clock->camera_ref_ns) * 1.0e-9;
+	const double y = (double)(host_ns - clock->host_ref_ns) * 1.0e-9 - t;
+	const double residual = y - (clock->offset_s + clock->drift * t);
+	const double magnitude = fabs(residual);
+
+	// Consecutive large residuals mean one of the clocks jumped (camera reboot, SDK reconnect).
+	// Isolated ones are just very late frames and are treated as outliers.
+	if(magnitude > clock->reset_threshold_s)
+	{
+		++clock->num_jumps;
+		if(clock->num_jumps >= clock->reset_count)
+		{
+			seeknode_clock_reset(clock);
+			++clock->num_resets;
+			seeknode_clock_update(clock, camera_ns, host_ns);
+		}
+		return;
+	}
+	clock->num_jumps = 0;
+
+	// One-sided Huber weight: late samples far outside the current jitter are down weighted proportionally to their
+	// distance. An early sample can only come from a shorter delay and is kept at full weight.
+	double weight = 1.0;
+	const double threshold = clock->outlier_threshold * fmax(clock->jitter_s, MIN_JITTER_S);
+	if(clock->num_samples > clock->warmup_samples && residual > threshold)
+	{
+		weight = threshold / magnitude;
+		++clock->num_outliers;
+	}
+
+	// Weighted recursive least squares update with exponential forgetting.
+	double (*p)[2] = clock->covariance;
+	const double lambda = clock->forgetting_factor;
+	const double p_phi[2] = { p[0][0] + p[0][1] * t, p[1][0] + p[1][1] * t };
+	const double denominator = lambda / weight + p_phi[0] + p_phi[1] * t;
+	const double gain[2] = { p_phi[0] / denominator, p_phi[1] / denominator };
+
+	clock->offset_s += gain[0] * residual;
+	clock->drift += gain[1] * residual;
+
+	const double p00 = (p[0][0] - gain[0] * p_phi[0]) / lambda;
+	const double p01 = (p[0][1] - gain[0] * p_phi[1]) / lambda;
+	const double p11 = (p[1][1] - gain[1] * p_phi[1]) / lambda;
+	p[0][0] = p00;
+	p[0][1] = p01;
+	p[1][0] = p01;
+	p[1][1] = p11;
+
+	// Track the residual scale with clamped samples so outliers cannot inflate it.
+	// The mean absolute deviation is scaled to a standard deviation assuming normally distributed jitter.
+	const double clamped = clock->num_samples > clock->warmup_samples ? fmin(magnitude, threshold) : magnitude;
+	clock->jitter_s += JITTER_SMOOTHING * (clamped * 1.2533 - clock->jitter_s);
+
+	// Follow the earliest arrivals relative to the updated fit.
+	// Two consecutive windows are kept so the minimum always covers at least one full window.
+	const double envelope_residual = y - (clock->offset_s + clock->drift * t);
+	if(host_ns - clock->envelope_start_ns >= clock->envelope_window_ns)
+	{
+		clock->previous_min_s = clock->envelope_min_s;
+		clock->envelope_min_s = INFINITY;
+		clock->envelope_start_ns = host_ns;
+	}
+	clock->envelope_min_s = fmin(clock->envelope_min_s, envelope_residual);
+	clock->envelope_s = fmin(fmin(clock->envelope_min_s, clock->previous_min_s), 0.0);
+
+	++clock->num_samples;
+}
+
+bool seeknode_clock_is_locked(const seeknode_clock_t* clock)
+{
+	return clock->has_reference && clock->num_samples > clock->warmup_samples;
+}
+
+int64_t seeknode_clock_to_host_ns(const seeknode_clock_t* clock, uint64_t camera_ns)
+{
+	const double t = (double)(int64_t)(camera_ns - clock->camera_ref_ns) * 1.0e-9;
+	const double host_s = t + clock->offset_s + clock->envelope_s + clock->drift * t;
+	return clock->host_ref_ns + (int64_t)llround(host_s * 1.0e9) - clock->latency_ns;
+}
+
+double seeknode_clock_get_drift_ppm(const seeknode_clock_t* clock)
+{
+	return clock->drift * 1.0e6;
+}
+
+int64_t seeknode_clock_get_jitter_ns(const seeknode_clock_t* clock)
+{
+	return (int64_t)llround(clock->jitter_s * 1.0e9);
+}
+
+int64_t seeknode_clock_get_excess_delay_ns(const seeknode_clock_t* clock)
+{
+	return (int64_t)llround(-clock->envelope_s * 1.0e9);
+}
+
+int64_t seeknode_clock_monotonic_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int64_t seeknode_clock_realtime_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int64_t seeknode_clock_thread_cpu_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
@@ -0,0 +1,113 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include "seeknode/seeknode_composite.h"
+#include "seeknode/seeknode_convert.h"
+
+void seeknode_composite_init(seeknode_composite_t* composite)
+{
+	composite->tiles = 0;
+	composite->columns = 0;
+	composite->rows = 0;
+	composite->tile_width = 0;
+	composite->tile_height = 0;
+	composite->width = 0;
+	composite->height = 0;
+	composite->scratch.clear();
+}
+
+void seeknode_composite_configure(seeknode_composite_t* composite, size_t tiles, size_t columns, size_t tile_width, size_t tile_height)
+{
+	if(columns == 0)
+	{
+		columns = (size_t)ceil(sqrt((double)tiles));
+	}
+	columns = columns > 0 ? columns : 1;
+
+	composite->tiles = tiles;
+	composite->columns = columns;
+	composite->rows = (tiles + columns - 1) / columns;
+	composite->tile_width = tile_width;
+	composite->tile_height = tile_height;
+	composite->width = columns * tile_width;
+	composite->height = composite->rows * tile_height;
+	composite->scratch.assign(tiles * tile_width, 0.0f);
+}
+
+void seeknode_composite_clear_tile(const seeknode_composite_t* composite, uint8_t* image, size_t step, size_t tile)
+{
+	if(tile >= composite->tiles)
+	{
+		return;
+	}
+
+	uint8_t* origin = image + (tile / composite->columns) * composite->tile_height * step + (tile % composite->columns) * composite->tile_width;
+	for(size_t y = 0; y < composite->tile_height; ++y)
+	{
+		memset(origin + y * step, 0, composite->tile_width);
+	}
+}
+
+void seeknode_composite_write_tile(
+	seeknode_composite_t* composite,
+	uint8_t* image,
+	size_t step,
+	size_t tile,
+	const float* pixels,
+	size_t width,
+	size_t height,
+	size_t stride,
+	float min_value,
+	float max_value)
+{
+	if(tile >= composite->tiles || width == 0 || height == 0)
+	{
+		return;
+	}
+
+	const size_t tile_width = composite->tile_width;
+	const size_t tile_height = composite->tile_height;
+	uint8_t* origin = image + (tile / composite->columns) * tile_height * step + (tile % composite->columns) * tile_width;
+	float* scratch = composite->scratch.data() + tile * tile_width;
+
+	for(size_t y = 0; y < tile_height; ++y)
+	{
+		const float* row = (const float*)((const uint8_t*)pixels + (y * height / tile_height) * stride);
+
+		// Frames at the tile size are converted straight from the SDK buffer.
+		if(width == tile_width)
+		{
+			seeknode_convert_f32_to_mono8(row, origin + y * step, tile_width, min_value, max_value);
+			continue;
+		}
+
+		for(size_t x = 0; x < tile_width; ++x)
+		{
+			scratch[x] = row[x * width / tile_width];
+		}
+		seeknode_convert_f32_to_mono8(scratch, origin + y * step, tile_width, min_value, max_value);
+	}
+}
@@ -0,0 +1,239 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "seeknode/seeknode_convert.h"
+#include "seeknode/seeknode_simd.h"
+
+void seeknode_convert_f32_to_mono8(const float* src, uint8_t* dst, size_t count, float min_value, float max_value)
+{
+	// A flat range would divide by zero; it maps everything to black instead.
+	const float range = max_value - min_value;
+	const float scale = range > 0.0f ? 255.0f / range : 0.0f;
+	const seeknode_f32x4_t v_min = seeknode_f32x4_set1(min_value);
+	const seeknode_f32x4_t v_scale = seeknode_f32x4_set1(scale);
+
+	size_t i = 0;
+	for(; i + SEEKNODE_F32X4_LANES <= count; i += SEEKNODE_F32X4_LANES)
+	{
+		const seeknode_f32x4_t v = seeknode_f32x4_mul(seeknode_f32x4_sub(seeknode_f32x4_load(src + i), v_min), v_scale);
+		seeknode_f32x4_store_u8(dst + i, v);
+	}
+	if(i < count)
+	{
+		// Convert the tail through a padded copy so it rounds and saturates exactly like the vector body.
+		float tail[SEEKNODE_F32X4_LANES] = { 0.0f };
+		uint8_t out[SEEKNODE_F32X4_LANES];
+		for(size_t k = 0; i + k < count; ++k)
+		{
+			tail[k] = src[i + k];
+		}
+		seeknode_f32x4_store_u8(out, seeknode_f32x4_mul(seeknode_f32x4_sub(seeknode_f32x4_load(tail), v_min), v_scale));
+		for(size_t k = 0; i + k < count; ++k)
+		{
+			dst[i + k] = out[k];
+		}
+	}
+}
+
+// Thermography fixed point 10.6 samples are 1/64 degree steps from -40 degrees Celsius.
+static const float FIXED_10_6_SCALE = 1.0f / 64.0f;
+static const float FIXED_10_6_OFFSET = -40.0f;
+
+const char* seeknode_encoding_get_str(seeknode_encoding_t encoding)
+{
+	switch(encoding)
+	{
+		case SEEKNODE_ENCODING_32FC1:
+			return "32FC1";
+		case SEEKNODE_ENCODING_MONO8:
+			return "mono8";
+		case SEEKNODE_ENCODING_MONO16:
+			return "mono16";
+		case SEEKNODE_ENCODING_BGR8:
+			return "bgr8";
+		case SEEKNODE_ENCODING_BGRA8:
+			return "bgra8";
+		case SEEKNODE_ENCODING_RGB8:
+			return "rgb8";
+		case SEEKNODE_ENCODING_YUV422:
+			return "yuv422";
+		default:
+			return "unknown";
+	}
+}
+
+// Row kernels, one per (format, encoding) pair.
+// Each fixes both pixel sizes and converts count pixels of a row; convert_frame instantiates the frame loop around it.
+template<seekcamera_frame_format_t FORMAT, seeknode_encoding_t ENCODING, size_t SRC_SIZE, size_t DST_SIZE>
+struct kernel_traits_t
+{
+	static const seekcamera_frame_format_t format = FORMAT;
+	static const seeknode_encoding_t encoding = ENCODING;
+	static const size_t src_pixel_size = SRC_SIZE;
+	static const size_t dst_pixel_size = DST_SIZE;
+};
+
+// Same layout on both sides.
+template<seekcamera_frame_format_t FORMAT, seeknode_encoding_t ENCODING, size_t SIZE>
+struct copy_kernel_t : kernel_traits_t<FORMAT, ENCODING, SIZE, SIZE>
+{
+	static inline void row(const uint8_t* src, uint8_t* dst, size_t count, float min_value, float max_value)
+	{
+		(void)min_value;
+		(void)max_value;
+		memcpy(dst, src, count * SIZE);
+	}
+};
+
+struct thermography_mono8_kernel_t : kernel_traits_t<SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT, SEEKNODE_ENCODING_MONO8, sizeof(float), 1>
+{
+	static inline void row(const uint8_t* src, uint8_t* dst, size_t count, float min_value, float max_value)
+	{
+		seeknode_convert_f32_to_mono8((const float*)src, dst, count, min_value, max_value);
+	}
+};
+
+struct fixed_32fc1_kernel_t : kernel_traits_t<SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FIXED_10_6, SEEKNODE_ENCODING_32FC1, sizeof(uint16_t), sizeof(float)>
+{
+	static inline void row(const uint8_t* src, uint8_t* dst, size_t count, float min_value, float max_value)
+	{
+		(void)min_value;
+		(void)max_value;
+		const uint16_t* in = (const uint16_t*)src;
+		float* out = (float*)dst;
+		for(size_t i = 0; i < count; ++i)
+		{
+			out[i] = in[i] * FIXED_10_6_SCALE + FIXED_10_6_OFFSET;
+		}
+	}
+};
+
+// ARGB8888 pixels are little endian words, so the bytes are B, G, R, A; R_OFFSET and B_OFFSET place them in the output.
+template<seeknode_encoding_t ENCODING, size_t R_OFFSET, size_t B_OFFSET>
+struct argb_rgb_kernel_t : kernel_traits_t<SEEKCAMERA_FRAME_FORMAT_COLOR_ARGB8888, ENCODING, 4, 3>
+{
+	static inline void row(const uint8_t* src, uint8_t* dst, size_t count, float min_value, float max_value)
+	{
+		(void)min_value;
+		(void)max_value;
+		for(size_t i = 0; i < count; ++i, src += 4, dst += 3)
+		{
+			dst[B_OFFSET] = src[0];
+			dst[1] = src[1];
+			dst[R_OFFSET] = src[2];
+		}
+	}
+};
+
+// RGB565 channels are widened by replicating their high bits, so full scale stays full scale.
+template<seeknode_encoding_t ENCODING, size_t R_OFFSET, size_t B_OFFSET>
+struct rgb565_rgb_kernel_t : kernel_traits_t<SEEKCAMERA_FRAME_FORMAT_COLOR_RGB565, ENCODING, 2, 3>
+{
+	static inline void row(const uint8_t* src, uint8_t* dst, size_t count, float min_value, float max_value)
+	{
+		(void)min_value;
+		(void)max_value;
+		for(size_t i = 0; i < count; ++i, src += 2, dst += 3)
+		{
+			const uint32_t v = (uint32_t)src[0] | ((uint32_t)src[1] << 8);
+			const uint32_t r = (v >> 11) & 0x1f;
+			const uint32_t g = (v >> 5) & 0x3f;
+			const uint32_t b = v & 0x1f;
+			dst[R_OFFSET] = (uint8_t)((r << 3) | (r >> 2));
+			dst[1] = (uint8_t)((g << 2) | (g >> 4));
+			dst[B_OFFSET] = (uint8_t)((b << 3) | (b >> 2));
+		}
+	}
+};
+
+// YUY2 (Y0 U Y1 V) to UYVY (U Y0 V Y1), two pixels at a time; frame widths are even.
+struct yuy2_yuv422_kernel_t : kernel_traits_t<SEEKCAMERA_FRAME_FORMAT_COLOR_YUY2, SEEKNODE_ENCODING_YUV422, 2, 2>
+{
+	static inline void row(const uint8_t* src, uint8_t* dst, size_t count, float min_value, float max_value)
+	{
+		(void)min_value;
+		(void)max_value;
+		for(size_t i = 0; i + 1 < count; i += 2, src += 4, dst += 4)
+		{
+			dst[0] = src[1];
+			dst[1] = src[0];
+			dst[2] = src[3];
+			dst[3] = src[2];
+		}
+	}
+};
+
+// Frame loop around a row kernel.
+// Unpadded frames are converted as a single row; otherwise rows are converted one by one.
+template<typename K>
+static void convert_frame(const void* src, size_t src_stride, void* dst, size_t dst_stride, size_t width, size_t height, float min_value, float max_value)
+{
+	const uint8_t* in = (const uint8_t*)src;
+	uint8_t* out = (uint8_t*)dst;
+	if(src_stride == width * K::src_pixel_size && dst_stride == width * K::dst_pixel_size)
+	{
+		K::row(in, out, width * height, min_value, max_value);
+		return;
+	}
+	for(size_t y = 0; y < height; ++y)
+	{
+		K::row(in + y * src_stride, out + y * dst_stride, width, min_value, max_value);
+	}
+}
+
+template<typename K>
+constexpr seeknode_converter_t make_converter()
+{
+	return { K::format, K::encoding, K::src_pixel_size, K::dst_pixel_size, &convert_frame<K> };
+}
+
+// Supported conversions.
+static constexpr seeknode_converter_t CONVERTERS[] = {
+	make_converter<copy_kernel_t<SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT, SEEKNODE_ENCODING_32FC1, sizeof(float)> >(),
+	make_converter<thermography_mono8_kernel_t>(),
+	make_converter<copy_kernel_t<SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FIXED_10_6, SEEKNODE_ENCODING_MONO16, sizeof(uint16_t)> >(),
+	make_converter<fixed_32fc1_kernel_t>(),
+	make_converter<copy_kernel_t<SEEKCAMERA_FRAME_FORMAT_CORRECTED, SEEKNODE_ENCODING_MONO16, sizeof(uint16_t)> >(),
+	make_converter<copy_kernel_t<SEEKCAMERA_FRAME_FORMAT_PRE_AGC, SEEKNODE_ENCODING_MONO16, sizeof(uint16_t)> >(),
+	make_converter<copy_kernel_t<SEEKCAMERA_FRAME_FORMAT_GRAYSCALE, SEEKNODE_ENCODING_MONO8, 1> >(),
+	make_converter<copy_kernel_t<SEEKCAMERA_FRAME_FORMAT_COLOR_ARGB8888, SEEKNODE_ENCODING_BGRA8, 4> >(),
+	make_converter<argb_rgb_kernel_t<SEEKNODE_ENCODING_BGR8, 2, 0> >(),
+	make_converter<argb_rgb_kernel_t<SEEKNODE_ENCODING_RGB8, 0, 2> >(),
+	make_converter<rgb565_rgb_kernel_t<SEEKNODE_ENCODING_BGR8, 2, 0> >(),
+	make_converter<rgb565_rgb_kernel_t<SEEKNODE_ENCODING_RGB8, 0, 2> >(),
+	make_converter<yuy2_yuv422_kernel_t>(),
+};
+
+const seeknode_converter_t* seeknode_converter_find(seekcamera_frame_format_t format, seeknode_encoding_t encoding)
+{
+	for(const seeknode_converter_t& converter : CONVERTERS)
+	{
+		if(converter.format == format && converter.encoding == encoding)
+		{
+			return &converter;
+		}
+	}
+	return NULL;
+}
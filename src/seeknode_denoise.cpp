@@ -0,0 +1,182 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "seeknode/seeknode_denoise.h"
+#include "seeknode/seeknode_simd.h"
+
+// Default weight of the new frame.
+static const float DEFAULT_ALPHA = 0.25f;
+
+// Filters a row with a constant weight.
+static void seeknode_denoise_ema_row(float* row, float* history, size_t width, float alpha)
+{
+	const seeknode_f32x4_t a = seeknode_f32x4_set1(alpha);
+
+	size_t x = 0;
+	for(; x + SEEKNODE_F32X4_LANES <= width; x += SEEKNODE_F32X4_LANES)
+	{
+		const seeknode_f32x4_t h = seeknode_f32x4_load(history + x);
+		const seeknode_f32x4_t d = seeknode_f32x4_sub(seeknode_f32x4_load(row + x), h);
+		const seeknode_f32x4_t y = seeknode_f32x4_add(h, seeknode_f32x4_mul(a, d));
+		seeknode_f32x4_store(history + x, y);
+		seeknode_f32x4_store(row + x, y);
+	}
+	for(; x < width; ++x)
+	{
+		history[x] += alpha * (row[x] - history[x]);
+		row[x] = history[x];
+	}
+}
+
+// Filters a row with a weight that ramps from alpha to 1 as the difference approaches the motion threshold.
+static void seeknode_denoise_adaptive_row(float* row, float* history, size_t width, float alpha, float inv_threshold)
+{
+	const seeknode_f32x4_t a = seeknode_f32x4_set1(alpha);
+	const seeknode_f32x4_t one_minus_a = seeknode_f32x4_set1(1.0f - alpha);
+	const seeknode_f32x4_t one = seeknode_f32x4_set1(1.0f);
+	const seeknode_f32x4_t inv_t = seeknode_f32x4_set1(inv_threshold);
+
+	size_t x = 0;
+	for(; x + SEEKNODE_F32X4_LANES <= width; x += SEEKNODE_F32X4_LANES)
+	{
+		const seeknode_f32x4_t h = seeknode_f32x4_load(history + x);
+		const seeknode_f32x4_t d = seeknode_f32x4_sub(seeknode_f32x4_load(row + x), h);
+		const seeknode_f32x4_t k = seeknode_f32x4_min(seeknode_f32x4_mul(seeknode_f32x4_abs(d), inv_t), one);
+		const seeknode_f32x4_t w = seeknode_f32x4_add(a, seeknode_f32x4_mul(one_minus_a, k));
+		const seeknode_f32x4_t y = seeknode_f32x4_add(h, seeknode_f32x4_mul(w, d));
+		seeknode_f32x4_store(history + x, y);
+		seeknode_f32x4_store(row + x, y);
+	}
+	for(; x < width; ++x)
+	{
+		const float d = row[x] - history[x];
+		const float k = std::min(fabsf(d) * inv_threshold, 1.0f);
+		history[x] += (alpha + (1.0f - alpha) * k) * d;
+		row[x] = history[x];
+	}
+}
+
+void seeknode_denoise_init(seeknode_denoise_t* denoise)
+{
+	denoise->mode = SEEKNODE_DENOISE_MODE_OFF;
+	denoise->alpha = DEFAULT_ALPHA;
+	denoise->motion_threshold = 3.0f;
+	denoise->width = 0;
+	denoise->height = 0;
+	denoise->history.clear();
+	denoise->has_history = false;
+}
+
+bool seeknode_denoise_mode_from_str(const char* str, seeknode_denoise_mode_t* mode)
+{
+	if(strcmp(str, "off") == 0)
+	{
+		*mode = SEEKNODE_DENOISE_MODE_OFF;
+	}
+	else if(strcmp(str, "ema") == 0)
+	{
+		*mode = SEEKNODE_DENOISE_MODE_EMA;
+	}
+	else if(strcmp(str, "adaptive") == 0)
+	{
+		*mode = SEEKNODE_DENOISE_MODE_MOTION_ADAPTIVE;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+void seeknode_denoise_configure(seeknode_denoise_t* denoise, size_t width, size_t height)
+{
+	// A weight of 0 would freeze the output on the first frame and one above 1 makes the filter diverge.
+	if(!(denoise->alpha > 0.0f))
+	{
+		denoise->alpha = DEFAULT_ALPHA;
+	}
+	else if(denoise->alpha > 1.0f)
+	{
+		denoise->alpha = 1.0f;
+	}
+
+	if(denoise->width == width && denoise->height == height)
+	{
+		return;
+	}
+
+	denoise->width = width;
+	denoise->height = height;
+	denoise->history.assign(width * height, 0.0f);
+	denoise->has_history = false;
+}
+
+void seeknode_denoise_reset(seeknode_denoise_t* denoise)
+{
+	denoise->has_history = false;
+}
+
+void seeknode_denoise_process(seeknode_denoise_t* denoise, float* pixels, size_t stride)
+{
+	const size_t width = denoise->width;
+	const size_t height = denoise->height;
+
+	// The first frame seeds the history and passes through unchanged.
+	if(!denoise->has_history)
+	{
+		for(size_t y = 0; y < height; ++y)
+		{
+			memcpy(denoise->history.data() + y * width, (const uint8_t*)pixels + y * stride, width * sizeof(float));
+		}
+		denoise->has_history = true;
+		return;
+	}
+
+	const float alpha = denoise->alpha;
+	// A finite scale keeps 0 * scale at 0; an infinite one would turn unchanged pixels into NaN, which then sticks in the
+	// history.
+	const float inv_threshold = denoise->motion_threshold > 0.0f ? 1.0f / denoise->motion_threshold : FLT_MAX;
+
+	for(size_t y = 0; y < height; ++y)
+	{
+		float* row = (float*)((uint8_t*)pixels + y * stride);
+		float* history = denoise->history.data() + y * width;
+		switch(denoise->mode)
+		{
+			case SEEKNODE_DENOISE_MODE_EMA:
+				seeknode_denoise_ema_row(row, history, width, alpha);
+				break;
+			case SEEKNODE_DENOISE_MODE_MOTION_ADAPTIVE:
+				seeknode_denoise_adaptive_row(row, history, width, alpha, inv_threshold);
+				break;
+			default:
+				break;
+		}
+	}
+}
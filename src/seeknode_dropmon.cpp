@@ -0,0 +1,164 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+
+#include "seeknode/seeknode_dropmon.h"
+
+// Count increments beyond this many steps are taken as a restart of the count rather than a gap.
+static const uint32_t MAX_GAP_STEPS = 10000;
+
+// Intervals longer than this many periods are gaps or stalls and stay out of the period and jitter estimates.
+static const double IRREGULAR_INTERVAL_FACTOR = 1.5;
+
+void seeknode_dropmon_init(seeknode_dropmon_t* monitor)
+{
+	monitor->stall_timeout_ns = 1000000000LL;
+	monitor->smoothing = 0.05;
+
+	monitor->has_last = false;
+	monitor->last_fpa_frame_count = 0;
+	monitor->step = 0;
+	monitor->last_interval_arrival_ns = 0;
+	monitor->period_ns = 0.0;
+	monitor->variance_ns2 = 0.0;
+	monitor->max_interval_ns = 0;
+	monitor->num_gaps = 0;
+	monitor->max_gap = 0;
+	monitor->num_resyncs = 0;
+
+	monitor->last_arrival_ns = 0;
+	monitor->last_seen_fpa_frame_count = 0;
+	monitor->is_stalled = false;
+	monitor->num_frames = 0;
+	monitor->num_stalls = 0;
+	for(int i = 0; i < SEEKNODE_DROP_STAGE_COUNT; ++i)
+	{
+		monitor->num_dropped[i] = 0;
+		monitor->num_alerted[i] = 0;
+	}
+}
+
+const char* seeknode_drop_stage_get_str(seeknode_drop_stage_t stage)
+{
+	switch(stage)
+	{
+		case SEEKNODE_DROP_STAGE_SDK:
+			return "sdk";
+		case SEEKNODE_DROP_STAGE_RING:
+			return "ring";
+		case SEEKNODE_DROP_STAGE_WRITER:
+			return "writer";
+		case SEEKNODE_DROP_STAGE_PUBLISH:
+			return "publish";
+		default:
+			return "unknown";
+	}
+}
+
+uint32_t seeknode_dropmon_frame(seeknode_dropmon_t* monitor, uint32_t fpa_frame_count, int64_t arrival_ns, int64_t* stall_ns)
+{
+	const int64_t last_arrival_ns = monitor->last_arrival_ns.exchange(arrival_ns);
+	*stall_ns = monitor->is_stalled.exchange(false) ? arrival_ns - last_arrival_ns : 0;
+	monitor->last_seen_fpa_frame_count = fpa_frame_count;
+	++monitor->num_frames;
+
+	const uint32_t last_fpa_frame_count = monitor->last_fpa_frame_count;
+	monitor->last_fpa_frame_count = fpa_frame_count;
+	if(!monitor->has_last)
+	{
+		monitor->has_last = true;
+		monitor->last_interval_arrival_ns = arrival_ns;
+		return 0;
+	}
+
+	// Intervals are measured between consecutive deliveries, stalls included.
+	const int64_t interval_ns = arrival_ns - monitor->last_interval_arrival_ns;
+	monitor->last_interval_arrival_ns = arrival_ns;
+	monitor->max_interval_ns = interval_ns > monitor->max_interval_ns ? interval_ns : monitor->max_interval_ns;
+
+	const uint32_t delta = fpa_frame_count - last_fpa_frame_count;
+	if(delta == 0 || (monitor->step > 0 && delta > MAX_GAP_STEPS * monitor->step))
+	{
+		++monitor->num_resyncs;
+		return 0;
+	}
+	monitor->step = monitor->step == 0 || delta < monitor->step ? delta : monitor->step;
+
+	const uint32_t missing = (delta + monitor->step / 2) / monitor->step - 1;
+	if(missing > 0)
+	{
+		++monitor->num_gaps;
+		monitor->max_gap = missing > monitor->max_gap ? missing : monitor->max_gap;
+		monitor->num_dropped[SEEKNODE_DROP_STAGE_SDK] += missing;
+		return missing;
+	}
+
+	if(monitor->period_ns <= 0.0)
+	{
+		monitor->period_ns = (double)interval_ns;
+	}
+	else if(interval_ns <= IRREGULAR_INTERVAL_FACTOR * monitor->period_ns)
+	{
+		const double deviation = (double)interval_ns - monitor->period_ns;
+		monitor->period_ns += monitor->smoothing * deviation;
+		monitor->variance_ns2 += monitor->smoothing * (deviation * deviation - monitor->variance_ns2);
+	}
+	return 0;
+}
+
+void seeknode_dropmon_add_drops(seeknode_dropmon_t* monitor, seeknode_drop_stage_t stage, uint64_t count)
+{
+	monitor->num_dropped[stage].fetch_add(count, std::memory_order_relaxed);
+}
+
+int64_t seeknode_dropmon_check_stall(seeknode_dropmon_t* monitor, int64_t now_ns)
+{
+	const int64_t last_arrival_ns = monitor->last_arrival_ns.load();
+	if(monitor->num_frames < 2 || now_ns - last_arrival_ns < monitor->stall_timeout_ns || monitor->is_stalled.exchange(true))
+	{
+		return 0;
+	}
+
+	// A frame that arrived since the check has already looked for the stall flag.
+	if(monitor->last_arrival_ns.load() != last_arrival_ns)
+	{
+		monitor->is_stalled = false;
+		return 0;
+	}
+	++monitor->num_stalls;
+	return now_ns - last_arrival_ns;
+}
+
+uint64_t seeknode_dropmon_take_drops(seeknode_dropmon_t* monitor, seeknode_drop_stage_t stage)
+{
+	const uint64_t num_dropped = monitor->num_dropped[stage].load(std::memory_order_relaxed);
+	const uint64_t count = num_dropped - monitor->num_alerted[stage];
+	monitor->num_alerted[stage] = num_dropped;
+	return count;
+}
+
+double seeknode_dropmon_get_jitter_ns(const seeknode_dropmon_t* monitor)
+{
+	return sqrt(monitor->variance_ns2);
+}
@@ -0,0 +1,224 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <chrono>
+#include <utility>
+
+#include "seeknode/seeknode_framering.h"
+
+void seeknode_frame_ring_init(seeknode_frame_ring_t* ring, size_t num_slots, size_t depth)
+{
+	std::lock_guard<std::mutex> lock(ring->mutex);
+	ring->depth = depth > 0 ? depth : 1;
+	ring->slots.clear();
+	for(size_t i = 0; i < num_slots; ++i)
+	{
+		std::unique_ptr<seeknode_frame_slot_t> slot(new seeknode_frame_slot_t());
+		slot->refcount = 0;
+		slot->sequence = 0;
+		slot->encoding = SEEKNODE_ENCODING_32FC1;
+		slot->width = 0;
+		slot->height = 0;
+		slot->stride = 0;
+		ring->slots.push_back(std::move(slot));
+	}
+	ring->ready.assign(ring->depth, NULL);
+	ring->ready_head = 0;
+	ring->num_ready = 0;
+	ring->sequence = 0;
+	ring->is_closed = false;
+	ring->num_published = 0;
+	ring->num_dropped = 0;
+	ring->num_exhausted = 0;
+}
+
+void seeknode_frame_ring_reserve(seeknode_frame_ring_t* ring, size_t size)
+{
+	std::lock_guard<std::mutex> lock(ring->mutex);
+	for(const auto& slot : ring->slots)
+	{
+		// Referenced slots may be read through views of their buffer; they are grown on their next acquire.
+		if(slot->refcount.load(std::memory_order_acquire) == 0 && slot->data.size() < size)
+		{
+			slot->data.resize(size);
+		}
+	}
+}
+
+seeknode_frame_slot_t* seeknode_frame_ring_acquire(seeknode_frame_ring_t* ring, size_t size)
+{
+	seeknode_frame_slot_t* slot = NULL;
+	{
+		std::lock_guard<std::mutex> lock(ring->mutex);
+		for(const auto& candidate : ring->slots)
+		{
+			// Only the ring hands out references, so a free slot cannot be referenced concurrently.
+			if(candidate->refcount.load(std::memory_order_acquire) == 0)
+			{
+				slot = candidate.get();
+				slot->refcount.store(1, std::memory_order_relaxed);
+				slot->sequence = ring->sequence++;
+				break;
+			}
+		}
+		if(slot == NULL)
+		{
+			++ring->num_exhausted;
+			return NULL;
+		}
+	}
+
+	if(slot->data.size() < size)
+	{
+		slot->data.resize(size);
+	}
+	return slot;
+}
+
+size_t seeknode_frame_ring_publish(seeknode_frame_ring_t* ring, seeknode_frame_slot_t* slot)
+{
+	seeknode_frame_slot_t* dropped = NULL;
+	{
+		std::lock_guard<std::mutex> lock(ring->mutex);
+		if(ring->is_closed)
+		{
+			dropped = slot;
+		}
+		else
+		{
+			if(ring->num_ready == ring->depth)
+			{
+				dropped = ring->ready[ring->ready_head];
+				ring->ready_head = (ring->ready_head + 1) % ring->depth;
+				--ring->num_ready;
+				++ring->num_dropped;
+			}
+			ring->ready[(ring->ready_head + ring->num_ready) % ring->depth] = slot;
+			++ring->num_ready;
+			++ring->num_published;
+		}
+	}
+	ring->frame_ready.notify_one();
+
+	if(dropped == NULL)
+	{
+		return 0;
+	}
+	seeknode_frame_ring_release(dropped);
+	return 1;
+}
+
+seeknode_frame_slot_t* seeknode_frame_ring_pop(seeknode_frame_ring_t* ring, int64_t timeout_ns)
+{
+	std::unique_lock<std::mutex> lock(ring->mutex);
+	ring->frame_ready.wait_for(lock, std::chrono::nanoseconds(timeout_ns), [&]() { return ring->is_closed || ring->num_ready > 0; });
+	if(ring->is_closed || ring->num_ready == 0)
+	{
+		return NULL;
+	}
+
+	seeknode_frame_slot_t* slot = ring->ready[ring->ready_head];
+	ring->ready_head = (ring->ready_head + 1) % ring->depth;
+	--ring->num_ready;
+	return slot;
+}
+
+void seeknode_frame_ring_retain(seeknode_frame_slot_t* slot)
+{
+	slot->refcount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void seeknode_frame_ring_release(seeknode_frame_slot_t* slot)
+{
+	slot->refcount.fetch_sub(1, std::memory_order_release);
+}
+
+void seeknode_frame_ring_close(seeknode_frame_ring_t* ring)
+{
+	{
+		std::lock_guard<std::mutex> lock(ring->mutex);
+		ring->is_closed = true;
+		for(; ring->num_ready > 0; --ring->num_ready)
+		{
+			seeknode_frame_ring_release(ring->ready[ring->ready_head]);
+			ring->ready_head = (ring->ready_head + 1) % ring->depth;
+		}
+	}
+	ring->frame_ready.notify_all();
+}
+
+bool seeknode_frame_ring_is_closed(seeknode_frame_ring_t* ring)
+{
+	std::lock_guard<std::mutex> lock(ring->mutex);
+	return ring->is_closed;
+}
+
+seeknode_frame_handle_t seeknode_frame_ring_pop_handle(seeknode_frame_ring_t* ring, int64_t timeout_ns)
+{
+	return seeknode_frame_handle_t(seeknode_frame_ring_pop(ring, timeout_ns));
+}
+
+seeknode_frame_handle_t::seeknode_frame_handle_t() :
+	slot(NULL)
+{
+}
+
+seeknode_frame_handle_t::seeknode_frame_handle_t(seeknode_frame_slot_t* slot) :
+	slot(slot)
+{
+}
+
+seeknode_frame_handle_t::seeknode_frame_handle_t(const seeknode_frame_handle_t& other) :
+	slot(other.slot)
+{
+	if(slot != NULL)
+	{
+		seeknode_frame_ring_retain(slot);
+	}
+}
+
+seeknode_frame_handle_t::seeknode_frame_handle_t(seeknode_frame_handle_t&& other) :
+	slot(other.slot)
+{
+	other.slot = NULL;
+}
+
+seeknode_frame_handle_t& seeknode_frame_handle_t::operator=(seeknode_frame_handle_t other)
+{
+	std::swap(slot, other.slot);
+	return *this;
+}
+
+seeknode_frame_handle_t::~seeknode_frame_handle_t()
+{
+	reset();
+}
+
+void seeknode_frame_handle_t::reset()
+{
+	if(slot != NULL)
+	{
+		seeknode_frame_ring_release(slot);
+		slot = NULL;
+	}
+}
@@ -0,0 +1,142 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+
+#include <utility>
+
+#include "seeknode/seeknode_gate.h"
+#include "seeknode/seeknode_simd.h"
+
+// Number of sampled blocks in a row.
+static size_t seeknode_gate_blocks_per_row(const seeknode_gate_t* gate)
+{
+	const size_t blocks = gate->width / SEEKNODE_F32X4_LANES;
+	return (blocks + gate->column_step - 1) / gate->column_step;
+}
+
+void seeknode_gate_init(seeknode_gate_t* gate)
+{
+	gate->threshold = 0.05f;
+	gate->extrema_threshold = 0.5f;
+	gate->row_step = 4;
+	gate->column_step = 4;
+	gate->heartbeat_ns = 1000000000LL;
+
+	gate->width = 0;
+	gate->height = 0;
+	gate->reference.clear();
+	gate->candidate.clear();
+	gate->has_reference = false;
+	gate->reference_min = 0.0f;
+	gate->reference_max = 0.0f;
+	gate->last_publish_ns = 0;
+
+	gate->last_metric = 0.0f;
+	gate->num_published = 0;
+	gate->num_suppressed = 0;
+	gate->bytes_published = 0;
+	gate->bytes_suppressed = 0;
+}
+
+void seeknode_gate_configure(seeknode_gate_t* gate, size_t width, size_t height)
+{
+	if(gate->width == width && gate->height == height)
+	{
+		return;
+	}
+
+	gate->width = width;
+	gate->height = height;
+	gate->row_step = gate->row_step > 0 ? gate->row_step : 1;
+	gate->column_step = gate->column_step > 0 ? gate->column_step : 1;
+
+	const size_t rows = (height + gate->row_step - 1) / gate->row_step;
+	const size_t samples = rows * seeknode_gate_blocks_per_row(gate) * SEEKNODE_F32X4_LANES;
+	gate->reference.assign(samples, 0.0f);
+	gate->candidate.assign(samples, 0.0f);
+	gate->has_reference = false;
+}
+
+void seeknode_gate_reset(seeknode_gate_t* gate)
+{
+	gate->has_reference = false;
+}
+
+bool seeknode_gate_process(
+	seeknode_gate_t* gate,
+	const float* pixels,
+	size_t stride,
+	float min_value,
+	float max_value,
+	int64_t now_ns,
+	size_t frame_bytes)
+{
+	const size_t blocks_per_row = seeknode_gate_blocks_per_row(gate);
+	const size_t block_step = gate->column_step * SEEKNODE_F32X4_LANES;
+	const float* reference = gate->reference.data();
+	float* candidate = gate->candidate.data();
+
+	// Sum of absolute differences against the reference grid.
+	// The current samples are stored on the way so publishing only needs a swap.
+	seeknode_f32x4_t sad = seeknode_f32x4_set1(0.0f);
+	size_t i = 0;
+	for(size_t y = 0; y < gate->height; y += gate->row_step)
+	{
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride);
+		for(size_t b = 0; b < blocks_per_row; ++b, i += SEEKNODE_F32X4_LANES)
+		{
+			const seeknode_f32x4_t v = seeknode_f32x4_load(row + b * block_step);
+			sad = seeknode_f32x4_add(sad, seeknode_f32x4_abs(seeknode_f32x4_sub(v, seeknode_f32x4_load(reference + i))));
+			seeknode_f32x4_store(candidate + i, v);
+		}
+	}
+	gate->last_metric = i > 0 ? seeknode_f32x4_reduce_add(sad) / (float)i : 0.0f;
+
+	bool publish = !gate->has_reference;
+	publish = publish || gate->last_metric > gate->threshold;
+	publish = publish || now_ns - gate->last_publish_ns >= gate->heartbeat_ns;
+	if(!isnan(gate->extrema_threshold))
+	{
+		publish = publish || fabsf(max_value - gate->reference_max) > gate->extrema_threshold;
+		publish = publish || fabsf(min_value - gate->reference_min) > gate->extrema_threshold;
+	}
+
+	if(publish)
+	{
+		std::swap(gate->reference, gate->candidate);
+		gate->has_reference = true;
+		gate->reference_min = min_value;
+		gate->reference_max = max_value;
+		gate->last_publish_ns = now_ns;
+		++gate->num_published;
+		gate->bytes_published += frame_bytes;
+	}
+	else
+	{
+		++gate->num_suppressed;
+		gate->bytes_suppressed += frame_bytes;
+	}
+
+	return publish;
+}
@@ -0,0 +1,237 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <map>
+#include <new>
+
+#include "seeknode/seeknode_metrics.h"
+
+void* seeknode_metric_t::operator new(size_t size)
+{
+	void* pointer = NULL;
+	if(posix_memalign(&pointer, alignof(seeknode_metric_t), size) != 0)
+	{
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void seeknode_metric_t::operator delete(void* pointer)
+{
+	free(pointer);
+}
+
+// Shard of the calling thread, assigned round robin on first use.
+static size_t get_shard()
+{
+	static std::atomic<size_t> next_shard(0);
+	static thread_local size_t shard = next_shard++ % SEEKNODE_METRICS_SHARDS;
+	return shard;
+}
+
+static seeknode_metric_t* find_or_register(
+	seeknode_metrics_t* metrics,
+	const std::string& name,
+	const std::string& help,
+	const seeknode_metric_labels_t& labels,
+	seeknode_metric_type_t type,
+	double scale)
+{
+	std::lock_guard<std::mutex> lock(metrics->mutex);
+	for(const auto& metric : metrics->metrics)
+	{
+		if(metric->name == name && metric->labels == labels)
+		{
+			return metric.get();
+		}
+	}
+
+	std::unique_ptr<seeknode_metric_t> metric(new seeknode_metric_t());
+	metric->name = name;
+	metric->help = help;
+	metric->labels = labels;
+	metric->type = type;
+	metric->scale = scale;
+	for(auto& shard : metric->shards)
+	{
+		shard.value = 0;
+	}
+	metric->gauge = 0.0;
+	metrics->metrics.push_back(std::move(metric));
+	return metrics->metrics.back().get();
+}
+
+seeknode_metric_t* seeknode_metrics_counter(seeknode_metrics_t* metrics, const std::string& name, const std::string& help, const seeknode_metric_labels_t& labels, double scale)
+{
+	return find_or_register(metrics, name, help, labels, SEEKNODE_METRIC_COUNTER, scale);
+}
+
+seeknode_metric_t* seeknode_metrics_gauge(seeknode_metrics_t* metrics, const std::string& name, const std::string& help, const seeknode_metric_labels_t& labels)
+{
+	return find_or_register(metrics, name, help, labels, SEEKNODE_METRIC_GAUGE, 1.0);
+}
+
+void seeknode_metric_add(seeknode_metric_t* metric, uint64_t value)
+{
+	metric->shards[get_shard()].value.fetch_add(value, std::memory_order_relaxed);
+}
+
+void seeknode_metric_store(seeknode_metric_t* metric, uint64_t value)
+{
+	metric->shards[0].value.store(value, std::memory_order_relaxed);
+}
+
+void seeknode_metric_set(seeknode_metric_t* metric, double value)
+{
+	metric->gauge.store(value, std::memory_order_relaxed);
+}
+
+double seeknode_metric_read(const seeknode_metric_t* metric)
+{
+	if(metric->type == SEEKNODE_METRIC_GAUGE)
+	{
+		return metric->gauge.load(std::memory_order_relaxed);
+	}
+
+	uint64_t sum = 0;
+	for(const auto& shard : metric->shards)
+	{
+		sum += shard.value.load(std::memory_order_relaxed);
+	}
+	return (double)sum * metric->scale;
+}
+
+std::string seeknode_metric_get_label(const seeknode_metric_t* metric, const std::string& name)
+{
+	for(const auto& label : metric->labels)
+	{
+		if(label.first == name)
+		{
+			return label.second;
+		}
+	}
+	return std::string();
+}
+
+void seeknode_metrics_snapshot(seeknode_metrics_t* metrics, std::vector<seeknode_metric_sample_t>* samples)
+{
+	// Handles are never removed, so only the list itself needs the lock.
+	std::vector<const seeknode_metric_t*> list;
+	{
+		std::lock_guard<std::mutex> lock(metrics->mutex);
+		list.reserve(metrics->metrics.size());
+		for(const auto& metric : metrics->metrics)
+		{
+			list.push_back(metric.get());
+		}
+	}
+
+	samples->clear();
+	samples->reserve(list.size());
+	for(const seeknode_metric_t* metric : list)
+	{
+		seeknode_metric_sample_t sample;
+		sample.metric = metric;
+		sample.value = seeknode_metric_read(metric);
+		samples->push_back(sample);
+	}
+}
+
+// Escapes a label value (backslash, double quote and line feed).
+static std::string escape_label(const std::string& value)
+{
+	std::string escaped;
+	escaped.reserve(value.size());
+	for(const char c : value)
+	{
+		if(c == '\\' || c == '"')
+		{
+			escaped += '\\';
+			escaped += c;
+		}
+		else if(c == '\n')
+		{
+			escaped += "\\n";
+		}
+		else
+		{
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+bool seeknode_metrics_write_prometheus(seeknode_metrics_t* metrics, const std::string& path)
+{
+	std::vector<seeknode_metric_sample_t> samples;
+	seeknode_metrics_snapshot(metrics, &samples);
+
+	// Samples of a metric name are grouped under a single HELP/TYPE block, in order of first registration.
+	std::vector<std::string> names;
+	std::map<std::string, std::vector<const seeknode_metric_sample_t*> > groups;
+	for(const auto& sample : samples)
+	{
+		auto& group = groups[sample.metric->name];
+		if(group.empty())
+		{
+			names.push_back(sample.metric->name);
+		}
+		group.push_back(&sample);
+	}
+
+	const std::string temporary_path = path + ".tmp";
+	FILE* file = fopen(temporary_path.c_str(), "w");
+	if(file == NULL)
+	{
+		return false;
+	}
+
+	for(const auto& name : names)
+	{
+		const auto& group = groups[name];
+		const seeknode_metric_t* first = group.front()->metric;
+		fprintf(file, "# HELP %s %s\n", name.c_str(), first->help.c_str());
+		fprintf(file, "# TYPE %s %s\n", name.c_str(), first->type == SEEKNODE_METRIC_COUNTER ? "counter" : "gauge");
+		for(const seeknode_metric_sample_t* sample : group)
+		{
+			fputs(name.c_str(), file);
+			const seeknode_metric_labels_t& labels = sample->metric->labels;
+			for(size_t i = 0; i < labels.size(); ++i)
+			{
+				fprintf(file, "%s%s=\"%s\"", i == 0 ? "{" : ",", labels[i].first.c_str(), escape_label(labels[i].second).c_str());
+			}
+			fprintf(file, "%s %.17g\n", labels.empty() ? "" : "}", sample->value);
+		}
+	}
+
+	const bool is_written = fflush(file) == 0 && ferror(file) == 0;
+	if(fclose(file) != 0 || !is_written)
+	{
+		remove(temporary_path.c_str());
+		return false;
+	}
+	return rename(temporary_path.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,149 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "seeknode/seeknode_nonuniformity.h"
+#include "seeknode/seeknode_simd.h"
+
+// Only every n-th averaged residual is used to compute the median absolute deviation.
+static const size_t RESIDUAL_SUBSAMPLING = 3;
+
+// Scales a median absolute deviation to a standard deviation for normally distributed data.
+static const float MAD_TO_SIGMA = 1.4826f;
+
+// The 4-neighbour high-pass filter amplifies white fixed pattern noise by sqrt(1 + 4 / 16).
+static const float RESIDUAL_GAIN = 1.1180340f;
+
+// Computes the robust spread of the averaged residuals.
+static float seeknode_nonuniformity_estimate(seeknode_nonuniformity_t* nonuniformity)
+{
+	const size_t width = nonuniformity->width;
+	const size_t height = nonuniformity->height;
+
+	nonuniformity->scratch.clear();
+	for(size_t y = 1; y + 1 < height; ++y)
+	{
+		const float* row = nonuniformity->residuals.data() + y * width;
+		for(size_t x = 1 + y % RESIDUAL_SUBSAMPLING; x + 1 < width; x += RESIDUAL_SUBSAMPLING)
+		{
+			nonuniformity->scratch.push_back(fabsf(row[x]));
+		}
+	}
+	if(nonuniformity->scratch.empty())
+	{
+		return NAN;
+	}
+
+	const size_t median_index = nonuniformity->scratch.size() / 2;
+	std::nth_element(nonuniformity->scratch.begin(), nonuniformity->scratch.begin() + median_index, nonuniformity->scratch.end());
+	return nonuniformity->scratch[median_index] / (float)nonuniformity->num_frames * MAD_TO_SIGMA / RESIDUAL_GAIN;
+}
+
+void seeknode_nonuniformity_init(seeknode_nonuniformity_t* nonuniformity)
+{
+	nonuniformity->uniform_range = 2.0f;
+	nonuniformity->frames = 64;
+	nonuniformity->width = 0;
+	nonuniformity->height = 0;
+	nonuniformity->residuals.clear();
+	nonuniformity->num_frames = 0;
+	nonuniformity->scratch.clear();
+	nonuniformity->estimate = NAN;
+}
+
+void seeknode_nonuniformity_configure(seeknode_nonuniformity_t* nonuniformity, size_t width, size_t height)
+{
+	if(nonuniformity->width == width && nonuniformity->height == height)
+	{
+		return;
+	}
+
+	nonuniformity->width = width;
+	nonuniformity->height = height;
+	nonuniformity->residuals.assign(width * height, 0.0f);
+	nonuniformity->scratch.reserve(width * height / RESIDUAL_SUBSAMPLING + height);
+	nonuniformity->num_frames = 0;
+}
+
+void seeknode_nonuniformity_reset(seeknode_nonuniformity_t* nonuniformity)
+{
+	memset(nonuniformity->residuals.data(), 0, nonuniformity->residuals.size() * sizeof(float));
+	nonuniformity->num_frames = 0;
+}
+
+bool seeknode_nonuniformity_process(seeknode_nonuniformity_t* nonuniformity, const float* pixels, size_t stride, float min_value, float max_value)
+{
+	const size_t width = nonuniformity->width;
+	const size_t height = nonuniformity->height;
+	if(width < 3 || height < 3)
+	{
+		return false;
+	}
+
+	// The header extrema reject non-uniform scenes without touching the pixels.
+	if(!(max_value - min_value <= nonuniformity->uniform_range))
+	{
+		if(nonuniformity->num_frames > 0)
+		{
+			seeknode_nonuniformity_reset(nonuniformity);
+		}
+		return false;
+	}
+
+	// Accumulate the high-pass residuals of the interior pixels.
+	const seeknode_f32x4_t quarter = seeknode_f32x4_set1(0.25f);
+	for(size_t y = 1; y + 1 < height; ++y)
+	{
+		const float* up = (const float*)((const uint8_t*)pixels + (y - 1) * stride);
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride);
+		const float* down = (const float*)((const uint8_t*)pixels + (y + 1) * stride);
+		float* residuals = nonuniformity->residuals.data() + y * width;
+
+		size_t x = 1;
+		for(; x + SEEKNODE_F32X4_LANES + 1 <= width; x += SEEKNODE_F32X4_LANES)
+		{
+			seeknode_f32x4_t neighbours = seeknode_f32x4_add(seeknode_f32x4_load(row + x - 1), seeknode_f32x4_load(row + x + 1));
+			neighbours = seeknode_f32x4_add(neighbours, seeknode_f32x4_add(seeknode_f32x4_load(up + x), seeknode_f32x4_load(down + x)));
+			const seeknode_f32x4_t r = seeknode_f32x4_sub(seeknode_f32x4_load(row + x), seeknode_f32x4_mul(neighbours, quarter));
+			seeknode_f32x4_store(residuals + x, seeknode_f32x4_add(seeknode_f32x4_load(residuals + x), r));
+		}
+		for(; x + 1 < width; ++x)
+		{
+			residuals[x] += row[x] - 0.25f * (row[x - 1] + row[x + 1] + up[x] + down[x]);
+		}
+	}
+
+	++nonuniformity->num_frames;
+	if(nonuniformity->num_frames < std::max(nonuniformity->frames, (size_t)1))
+	{
+		return false;
+	}
+
+	nonuniformity->estimate = seeknode_nonuniformity_estimate(nonuniformity);
+	seeknode_nonuniformity_reset(nonuniformity);
+	return true;
+}
@@ -0,0 +1,442 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Python module exposing the capture pipeline: cameras are driven and frames converted in native threads, and Python
+// receives NumPy arrays that alias frame ring slots. A slot returns to the ring once its array is collected.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "seekcamera/seekcamera.h"
+#include "seekcamera/seekcamera_manager.h"
+#include "seekframe/seekframe.h"
+#include "seeknode/seeknode_convert.h"
+#include "seeknode/seeknode_framering.h"
+
+namespace py = pybind11;
+
+// Enumerated type representing the pixel format handed to Python.
+typedef enum capture_format_t
+{
+	CAPTURE_FORMAT_THERMOGRAPHY = 0,       // float32 degrees Celsius, (height, width)
+	CAPTURE_FORMAT_COLOR_ARGB8888,         // uint8 BGRA, (height, width, 4)
+	CAPTURE_FORMAT_MONO8,                  // uint8 scaled thermography, (height, width)
+} capture_format_t;
+
+// Ring shared by the capture and by the frames still referenced from Python.
+typedef struct capture_ring_t
+{
+	seeknode_frame_ring_t ring;
+} capture_ring_t;
+
+// State reached from the SDK callbacks.
+typedef struct capture_t
+{
+	// Options
+	uint32_t io_type;
+	capture_format_t format;
+	const seeknode_converter_t* converter;  // From the SDK frame format to the format handed to Python
+	bool has_color_palette;
+	seekcamera_color_palette_t color_palette;
+	float min_value;                       // Mono8 range; equal bounds follow the scene
+	float max_value;
+
+	std::shared_ptr<capture_ring_t> ring;
+	seekcamera_manager_t* manager;
+	std::mutex mutex;
+	uint64_t num_cameras;
+	uint64_t num_errors;
+} capture_t;
+
+// Python view of a popped slot.
+// The handle is declared after the ring so that it releases the slot before the ring can go away.
+class Frame
+{
+public:
+	Frame(const std::shared_ptr<capture_ring_t>& ring, seeknode_frame_handle_t&& handle, capture_format_t format)
+		: ring(ring), handle(std::move(handle)), format(format)
+	{
+	}
+
+	Frame(const Frame&) = delete;
+	Frame& operator=(const Frame&) = delete;
+
+	std::shared_ptr<capture_ring_t> ring;
+	seeknode_frame_handle_t handle;
+	capture_format_t format;
+};
+
+static bool parse_format(const std::string& name, capture_format_t* format, const seeknode_converter_t** converter)
+{
+	if(name == "thermography")
+	{
+		*format = CAPTURE_FORMAT_THERMOGRAPHY;
+		*converter = seeknode_converter_find(SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT, SEEKNODE_ENCODING_32FC1);
+	}
+	else if(name == "color_argb8888")
+	{
+		*format = CAPTURE_FORMAT_COLOR_ARGB8888;
+		*converter = seeknode_converter_find(SEEKCAMERA_FRAME_FORMAT_COLOR_ARGB8888, SEEKNODE_ENCODING_BGRA8);
+	}
+	else if(name == "mono8")
+	{
+		*format = CAPTURE_FORMAT_MONO8;
+		*converter = seeknode_converter_find(SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT, SEEKNODE_ENCODING_MONO8);
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+static bool parse_color_palette(const std::string& name, seekcamera_color_palette_t* palette)
+{
+	static const struct
+	{
+		const char* name;
+		seekcamera_color_palette_t palette;
+	} PALETTES[] = {
+		{ "white_hot", SEEKCAMERA_COLOR_PALETTE_WHITE_HOT },
+		{ "black_hot", SEEKCAMERA_COLOR_PALETTE_BLACK_HOT },
+		{ "spectra", SEEKCAMERA_COLOR_PALETTE_SPECTRA },
+		{ "prism", SEEKCAMERA_COLOR_PALETTE_PRISM },
+		{ "tyrian", SEEKCAMERA_COLOR_PALETTE_TYRIAN },
+		{ "iron", SEEKCAMERA_COLOR_PALETTE_IRON },
+		{ "amber", SEEKCAMERA_COLOR_PALETTE_AMBER },
+		{ "hi", SEEKCAMERA_COLOR_PALETTE_HI },
+		{ "green", SEEKCAMERA_COLOR_PALETTE_GREEN },
+	};
+	for(const auto& entry : PALETTES)
+	{
+		if(name == entry.name)
+		{
+			*palette = entry.palette;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Copies (or converts) an SDK frame into a ring slot and publishes it.
+// Runs on the SDK frame thread, without the GIL.
+static void frame_available_callback(seekcamera_t* camera, seekcamera_frame_t* camera_frame, void* user_data)
+{
+	capture_t* capture = (capture_t*)user_data;
+	const seeknode_converter_t* converter = capture->converter;
+
+	seekframe_t* frame = NULL;
+	const seekcamera_error_t status = seekcamera_frame_get_frame_by_format(camera_frame, converter->format, &frame);
+	if(status != SEEKCAMERA_SUCCESS)
+	{
+		return;
+	}
+
+	const size_t width = seekframe_get_width(frame);
+	const size_t height = seekframe_get_height(frame);
+	const size_t src_stride = seekframe_get_line_stride(frame);
+	const size_t stride = width * converter->dst_pixel_size;
+
+	seeknode_frame_ring_t* ring = &capture->ring->ring;
+	seeknode_frame_slot_t* slot = seeknode_frame_ring_acquire(ring, stride * height);
+	if(slot == NULL)
+	{
+		// Python still references every slot; the frame is counted as lost.
+		return;
+	}
+
+	memcpy(&slot->header, seekframe_get_header(frame), sizeof(slot->header));
+	seekcamera_get_chipid(camera, &slot->chipid);
+	slot->encoding = converter->encoding;
+	slot->width = width;
+	slot->height = height;
+	slot->stride = stride;
+
+	// The range only applies to mono8.
+	const bool is_scene_range = capture->min_value >= capture->max_value;
+	converter->convert(
+		seekframe_get_data(frame),
+		src_stride,
+		slot->data.data(),
+		stride,
+		width,
+		height,
+		is_scene_range ? slot->header.thermography_min_value : capture->min_value,
+		is_scene_range ? slot->header.thermography_max_value : capture->max_value);
+
+	seeknode_frame_ring_publish(ring, slot);
+}
+
+static void camera_event_callback(seekcamera_t* camera, seekcamera_manager_event_t event, seekcamera_error_t event_status, void* user_data)
+{
+	capture_t* capture = (capture_t*)user_data;
+	seekcamera_chipid_t cid{};
+	seekcamera_get_chipid(camera, &cid);
+
+	switch(event)
+	{
+		case SEEKCAMERA_MANAGER_EVENT_CONNECT:
+		{
+			if(capture->has_color_palette)
+			{
+				seekcamera_set_color_palette(camera, capture->color_palette);
+			}
+
+			seekcamera_error_t status = seekcamera_register_frame_available_callback(camera, frame_available_callback, capture);
+			if(status == SEEKCAMERA_SUCCESS)
+			{
+				status = seekcamera_capture_session_start(camera, capture->converter->format);
+			}
+			if(status != SEEKCAMERA_SUCCESS)
+			{
+				fprintf(stderr, "failed to start capture session: %s (CID: %s)\n", seekcamera_error_get_str(status), cid);
+				break;
+			}
+
+			std::lock_guard<std::mutex> lock(capture->mutex);
+			++capture->num_cameras;
+			break;
+		}
+		case SEEKCAMERA_MANAGER_EVENT_DISCONNECT:
+		{
+			seekcamera_capture_session_stop(camera);
+			std::lock_guard<std::mutex> lock(capture->mutex);
+			if(capture->num_cameras > 0)
+			{
+				--capture->num_cameras;
+			}
+			break;
+		}
+		case SEEKCAMERA_MANAGER_EVENT_ERROR:
+		{
+			fprintf(stderr, "unhandled camera error: (CID: %s) %s\n", cid, seekcamera_error_get_str(event_status));
+			std::lock_guard<std::mutex> lock(capture->mutex);
+			++capture->num_errors;
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+// Python handle on a running capture.
+class Capture
+{
+public:
+	Capture(const std::string& io_type, const std::string& format, py::object color_palette, size_t depth, size_t slots, float min_value, float max_value)
+	{
+		if(io_type == "usb")
+		{
+			capture.io_type = SEEKCAMERA_IO_TYPE_USB;
+		}
+		else if(io_type == "spi")
+		{
+			capture.io_type = SEEKCAMERA_IO_TYPE_SPI;
+		}
+		else if(io_type == "all")
+		{
+			capture.io_type = SEEKCAMERA_IO_TYPE_USB | SEEKCAMERA_IO_TYPE_SPI;
+		}
+		else
+		{
+			throw std::invalid_argument("unknown io_type: " + io_type);
+		}
+
+		if(!parse_format(format, &capture.format, &capture.converter))
+		{
+			throw std::invalid_argument("unknown format: " + format);
+		}
+
+		capture.has_color_palette = !color_palette.is_none();
+		capture.color_palette = SEEKCAMERA_COLOR_PALETTE_WHITE_HOT;
+		if(capture.has_color_palette && !parse_color_palette(color_palette.cast<std::string>(), &capture.color_palette))
+		{
+			throw std::invalid_argument("unknown color_palette: " + color_palette.cast<std::string>());
+		}
+
+		// Every slot beyond the ready queue and the writers can be held by Python.
+		if(slots < depth + 2)
+		{
+			throw std::invalid_argument("slots must be at least depth + 2");
+		}
+
+		capture.min_value = min_value;
+		capture.max_value = max_value;
+		capture.ring = std::make_shared<capture_ring_t>();
+		seeknode_frame_ring_init(&capture.ring->ring, slots, depth);
+		capture.manager = NULL;
+		capture.num_cameras = 0;
+		capture.num_errors = 0;
+	}
+
+	~Capture()
+	{
+		stop();
+	}
+
+	void start()
+	{
+		if(capture.manager != NULL)
+		{
+			return;
+		}
+
+		// Frames from a previous run may still be referenced from Python; they keep the old ring alive.
+		if(capture.ring->ring.is_closed)
+		{
+			std::shared_ptr<capture_ring_t> ring = std::make_shared<capture_ring_t>();
+			seeknode_frame_ring_init(&ring->ring, capture.ring->ring.slots.size(), capture.ring->ring.depth);
+			capture.ring = ring;
+		}
+
+		seekcamera_error_t status = seekcamera_manager_create(&capture.manager, capture.io_type);
+		if(status != SEEKCAMERA_SUCCESS)
+		{
+			capture.manager = NULL;
+			throw std::runtime_error(std::string("failed to create camera manager: ") + seekcamera_error_get_str(status));
+		}
+
+		status = seekcamera_manager_register_event_callback(capture.manager, camera_event_callback, &capture);
+		if(status != SEEKCAMERA_SUCCESS)
+		{
+			seekcamera_manager_destroy(&capture.manager);
+			capture.manager = NULL;
+			throw std::runtime_error(std::string("failed to register camera event callback: ") + seekcamera_error_get_str(status));
+		}
+	}
+
+	void stop()
+	{
+		if(capture.manager == NULL)
+		{
+			return;
+		}
+
+		// Destroying the manager stops the sessions and joins the SDK threads; they may be waiting on nothing
+		// Python holds, so the GIL is released meanwhile.
+		{
+			py::gil_scoped_release release;
+			seekcamera_manager_destroy(&capture.manager);
+		}
+		capture.manager = NULL;
+		seeknode_frame_ring_close(&capture.ring->ring);
+	}
+
+	py::object read(double timeout)
+	{
+		seeknode_frame_handle_t handle;
+		{
+			py::gil_scoped_release release;
+			handle = seeknode_frame_ring_pop_handle(&capture.ring->ring, (int64_t)(timeout * 1e9));
+		}
+		if(!handle)
+		{
+			return py::none();
+		}
+		return py::cast(new Frame(capture.ring, std::move(handle), capture.format), py::return_value_policy::take_ownership);
+	}
+
+	py::dict stats()
+	{
+		seeknode_frame_ring_t* ring = &capture.ring->ring;
+		py::dict stats;
+		std::lock_guard<std::mutex> ring_lock(ring->mutex);
+		stats["published"] = ring->num_published;
+		stats["dropped"] = ring->num_dropped;
+		stats["exhausted"] = ring->num_exhausted;
+		stats["ready"] = ring->num_ready;
+		std::lock_guard<std::mutex> lock(capture.mutex);
+		stats["cameras"] = capture.num_cameras;
+		stats["errors"] = capture.num_errors;
+		return stats;
+	}
+
+	capture_t capture;
+};
+
+// Array aliasing the slot of a frame; the frame object is its base and outlives it.
+static py::array frame_get_data(py::object self)
+{
+	Frame& frame = self.cast<Frame&>();
+	const seeknode_frame_slot_t* slot = frame.handle.slot;
+	const ssize_t width = (ssize_t)slot->width;
+	const ssize_t height = (ssize_t)slot->height;
+	const ssize_t stride = (ssize_t)slot->stride;
+	void* data = (void*)slot->data.data();
+
+	switch(frame.format)
+	{
+		case CAPTURE_FORMAT_THERMOGRAPHY:
+			return py::array(py::dtype::of<float>(), { height, width }, { stride, (ssize_t)sizeof(float) }, data, self);
+		case CAPTURE_FORMAT_COLOR_ARGB8888:
+			return py::array(py::dtype::of<uint8_t>(), { height, width, (ssize_t)4 }, { stride, (ssize_t)4, (ssize_t)1 }, data, self);
+		case CAPTURE_FORMAT_MONO8:
+		default:
+			return py::array(py::dtype::of<uint8_t>(), { height, width }, { stride, (ssize_t)1 }, data, self);
+	}
+}
+
+PYBIND11_MODULE(seeknode, m)
+{
+	m.doc() = "Seek Thermal capture with frames shared with NumPy without copies";
+
+	py::class_<Frame>(m, "Frame")
+		.def_property_readonly("data", &frame_get_data)
+		.def_property_readonly("chipid", [](const Frame& frame) { return std::string(frame.handle->chipid, strnlen(frame.handle->chipid, sizeof(frame.handle->chipid))); })
+		.def_property_readonly("sequence", [](const Frame& frame) { return frame.handle->sequence; })
+		.def_property_readonly("encoding", [](const Frame& frame) { return std::string(seeknode_encoding_get_str(frame.handle->encoding)); })
+		.def_property_readonly("width", [](const Frame& frame) { return frame.handle->width; })
+		.def_property_readonly("height", [](const Frame& frame) { return frame.handle->height; })
+		.def_property_readonly("timestamp_utc_ns", [](const Frame& frame) { return frame.handle->header.timestamp_utc_ns; })
+		.def_property_readonly("fpa_frame_count", [](const Frame& frame) { return frame.handle->header.fpa_frame_count; })
+		.def_property_readonly("environment_temperature", [](const Frame& frame) { return frame.handle->header.environment_temperature; })
+		.def_property_readonly("min_value", [](const Frame& frame) { return frame.handle->header.thermography_min_value; })
+		.def_property_readonly("max_value", [](const Frame& frame) { return frame.handle->header.thermography_max_value; })
+		.def_property_readonly("spot_value", [](const Frame& frame) { return frame.handle->header.thermography_spot_value; });
+
+	py::class_<Capture>(m, "Capture")
+		.def(py::init<const std::string&, const std::string&, py::object, size_t, size_t, float, float>(),
+			py::arg("io_type") = "usb",
+			py::arg("format") = "thermography",
+			py::arg("color_palette") = py::none(),
+			py::arg("depth") = 2,
+			py::arg("slots") = 8,
+			py::arg("min_value") = 0.0f,
+			py::arg("max_value") = 0.0f)
+		.def("start", &Capture::start)
+		.def("stop", &Capture::stop)
+		.def("read", &Capture::read, py::arg("timeout") = 0.15,
+			"Waits up to timeout seconds for the next frame; returns None on timeout or once stopped.")
+		.def("stats", &Capture::stats)
+		.def("__enter__", [](Capture& capture) -> Capture& { capture.start(); return capture; }, py::return_value_policy::reference)
+		.def("__exit__", [](Capture& capture, py::args) { capture.stop(); });
+}
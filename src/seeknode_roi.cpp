@@ -0,0 +1,422 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "seeknode/seeknode_roi.h"
+#include "seeknode/seeknode_simd.h"
+
+// Inclusive prefix popcount of every 4-bit lane mask: entry m holds the running count after lanes 0..3.
+static const uint8_t MASK_PREFIX_COUNT[16][4] = {
+	{ 0, 0, 0, 0 }, { 1, 1, 1, 1 }, { 0, 1, 1, 1 }, { 1, 2, 2, 2 },
+	{ 0, 0, 1, 1 }, { 1, 1, 2, 2 }, { 0, 1, 2, 2 }, { 1, 2, 3, 3 },
+	{ 0, 0, 0, 1 }, { 1, 1, 1, 2 }, { 0, 1, 1, 2 }, { 1, 2, 2, 3 },
+	{ 0, 0, 1, 2 }, { 1, 1, 2, 3 }, { 0, 1, 2, 3 }, { 1, 2, 3, 4 },
+};
+
+// Registers a threshold and returns the index of its count table.
+static int seeknode_roi_engine_add_threshold(seeknode_roi_engine_t* engine, float threshold)
+{
+	if(isnan(threshold))
+	{
+		return -1;
+	}
+
+	for(size_t i = 0; i < engine->thresholds.size(); ++i)
+	{
+		if(engine->thresholds[i] == threshold)
+		{
+			return (int)i;
+		}
+	}
+
+	engine->thresholds.push_back(threshold);
+	engine->width = 0; // Force the count tables to be reallocated.
+	return (int)engine->thresholds.size() - 1;
+}
+
+// Rasterizes a polygon into spans using the even-odd rule sampled at pixel centers.
+// The frame starts at (origin_x, origin_y) on the sensor the vertices are expressed in.
+static void seeknode_roi_rasterize(seeknode_roi_t* roi, size_t origin_x, size_t origin_y, size_t width, size_t height)
+{
+	roi->spans.clear();
+
+	const size_t num_vertices = roi->vertices.size() / 2;
+	if(num_vertices < 3)
+	{
+		return;
+	}
+
+	std::vector<float> crossings;
+	crossings.reserve(num_vertices);
+
+	for(size_t y = 0; y < height; ++y)
+	{
+		const float yc = (float)(origin_y + y) + 0.5f;
+
+		crossings.clear();
+		for(size_t i = 0, j = num_vertices - 1; i < num_vertices; j = i++)
+		{
+			const float xi = roi->vertices[2 * i];
+			const float yi = roi->vertices[2 * i + 1];
+			const float xj = roi->vertices[2 * j];
+			const float yj = roi->vertices[2 * j + 1];
+			if((yi <= yc) != (yj <= yc))
+			{
+				crossings.push_back(xi + (yc - yi) * (xj - xi) / (yj - yi));
+			}
+		}
+		std::sort(crossings.begin(), crossings.end());
+
+		// A pixel is inside when its center lies in [xa, xb).
+		for(size_t k = 0; k + 1 < crossings.size(); k += 2)
+		{
+			const float x0 = std::max(ceilf(crossings[k] - 0.5f) - (float)origin_x, 0.0f);
+			const float x1 = std::min(ceilf(crossings[k + 1] - 0.5f) - (float)origin_x, (float)width);
+			if(x1 > x0)
+			{
+				seeknode_span_t span;
+				span.y = (uint16_t)y;
+				span.x0 = (uint16_t)x0;
+				span.x1 = (uint16_t)x1;
+				roi->spans.push_back(span);
+			}
+		}
+	}
+}
+
+// Builds the value and squared value tables.
+// Each row is prefix summed four lanes at a time and then added to the previous table row.
+static void seeknode_roi_engine_build_sums(seeknode_roi_engine_t* engine, const float* pixels, size_t stride)
+{
+	const size_t width = engine->width;
+	const size_t height = engine->height;
+	const size_t table_stride = width + 1;
+	double* row_sum = engine->row_sum.data();
+	double* row_sum_sq = engine->row_sum_sq.data();
+
+	for(size_t y = 0; y < height; ++y)
+	{
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride);
+
+		double carry = 0.0;
+		double carry_sq = 0.0;
+		size_t x = 0;
+		for(; x + SEEKNODE_F32X4_LANES <= width; x += SEEKNODE_F32X4_LANES)
+		{
+			const seeknode_f32x4_t v = seeknode_f32x4_load(row + x);
+			const seeknode_f32x4_t v_sum = seeknode_f32x4_prefix_sum(v);
+			const seeknode_f32x4_t v_sum_sq = seeknode_f32x4_prefix_sum(seeknode_f32x4_mul(v, v));
+
+			const seeknode_f64x2_t c = seeknode_f64x2_set1(carry);
+			const seeknode_f64x2_t c_sq = seeknode_f64x2_set1(carry_sq);
+			seeknode_f64x2_store(row_sum + x, seeknode_f64x2_add(c, seeknode_f32x4_cvt_low_f64(v_sum)));
+			seeknode_f64x2_store(row_sum + x + 2, seeknode_f64x2_add(c, seeknode_f32x4_cvt_high_f64(v_sum)));
+			seeknode_f64x2_store(row_sum_sq + x, seeknode_f64x2_add(c_sq, seeknode_f32x4_cvt_low_f64(v_sum_sq)));
+			seeknode_f64x2_store(row_sum_sq + x + 2, seeknode_f64x2_add(c_sq, seeknode_f32x4_cvt_high_f64(v_sum_sq)));
+
+			carry = row_sum[x + 3];
+			carry_sq = row_sum_sq[x + 3];
+		}
+		for(; x < width; ++x)
+		{
+			carry += row[x];
+			carry_sq += (double)row[x] * row[x];
+			row_sum[x] = carry;
+			row_sum_sq[x] = carry_sq;
+		}
+
+		const double* above = engine->sum.data() + y * table_stride + 1;
+		const double* above_sq = engine->sum_sq.data() + y * table_stride + 1;
+		double* dst = engine->sum.data() + (y + 1) * table_stride + 1;
+		double* dst_sq = engine->sum_sq.data() + (y + 1) * table_stride + 1;
+
+		x = 0;
+		for(; x + 2 <= width; x += 2)
+		{
+			seeknode_f64x2_store(dst + x, seeknode_f64x2_add(seeknode_f64x2_load(above + x), seeknode_f64x2_load(row_sum + x)));
+			seeknode_f64x2_store(dst_sq + x, seeknode_f64x2_add(seeknode_f64x2_load(above_sq + x), seeknode_f64x2_load(row_sum_sq + x)));
+		}
+		for(; x < width; ++x)
+		{
+			dst[x] = above[x] + row_sum[x];
+			dst_sq[x] = above_sq[x] + row_sum_sq[x];
+		}
+	}
+}
+
+// Builds the count table of pixels above a threshold.
+static void seeknode_roi_engine_build_counts(seeknode_roi_engine_t* engine, size_t index, const float* pixels, size_t stride)
+{
+	const size_t width = engine->width;
+	const size_t height = engine->height;
+	const size_t table_stride = width + 1;
+	const size_t table_size = table_stride * (height + 1);
+	const float threshold = engine->thresholds[index];
+	const seeknode_f32x4_t t = seeknode_f32x4_set1(threshold);
+	uint32_t* table = engine->counts.data() + index * table_size;
+
+	for(size_t y = 0; y < height; ++y)
+	{
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride);
+		const uint32_t* above = table + y * table_stride + 1;
+		uint32_t* dst = table + (y + 1) * table_stride + 1;
+
+		uint32_t carry = 0;
+		size_t x = 0;
+		for(; x + SEEKNODE_F32X4_LANES <= width; x += SEEKNODE_F32X4_LANES)
+		{
+			const uint8_t* prefix = MASK_PREFIX_COUNT[seeknode_f32x4_cmpgt_mask(seeknode_f32x4_load(row + x), t)];
+			dst[x] = above[x] + carry + prefix[0];
+			dst[x + 1] = above[x + 1] + carry + prefix[1];
+			dst[x + 2] = above[x + 2] + carry + prefix[2];
+			dst[x + 3] = above[x + 3] + carry + prefix[3];
+			carry += prefix[3];
+		}
+		for(; x < width; ++x)
+		{
+			carry += row[x] > threshold ? 1 : 0;
+			dst[x] = above[x] + carry;
+		}
+	}
+}
+
+// Scans a run of pixels for its extrema.
+static inline void seeknode_roi_scan_extrema(const float* row, size_t x0, size_t x1, float* min_value, float* max_value)
+{
+	size_t x = x0;
+	if(x1 - x0 >= SEEKNODE_F32X4_LANES)
+	{
+		seeknode_f32x4_t v_min = seeknode_f32x4_set1(*min_value);
+		seeknode_f32x4_t v_max = seeknode_f32x4_set1(*max_value);
+		for(; x + SEEKNODE_F32X4_LANES <= x1; x += SEEKNODE_F32X4_LANES)
+		{
+			const seeknode_f32x4_t v = seeknode_f32x4_load(row + x);
+			v_min = seeknode_f32x4_min(v_min, v);
+			v_max = seeknode_f32x4_max(v_max, v);
+		}
+		*min_value = seeknode_f32x4_reduce_min(v_min);
+		*max_value = seeknode_f32x4_reduce_max(v_max);
+	}
+	for(; x < x1; ++x)
+	{
+		*min_value = std::min(*min_value, row[x]);
+		*max_value = std::max(*max_value, row[x]);
+	}
+}
+
+// Sums a table over the rectangle [x0, x1) x [y0, y1).
+template<typename T>
+static inline T seeknode_roi_table_sum(const T* table, size_t table_stride, size_t x0, size_t y0, size_t x1, size_t y1)
+{
+	return table[y1 * table_stride + x1] - table[y0 * table_stride + x1] - table[y1 * table_stride + x0] + table[y0 * table_stride + x0];
+}
+
+void seeknode_roi_engine_init(seeknode_roi_engine_t* engine)
+{
+	engine->compute_extrema = true;
+	engine->rois.clear();
+	engine->stats.clear();
+	engine->origin_x = 0;
+	engine->origin_y = 0;
+	engine->width = 0;
+	engine->height = 0;
+	engine->sum.clear();
+	engine->sum_sq.clear();
+	engine->thresholds.clear();
+	engine->counts.clear();
+	engine->row_sum.clear();
+	engine->row_sum_sq.clear();
+}
+
+void seeknode_roi_engine_add_rect(seeknode_roi_engine_t* engine, const std::string& name, int x, int y, int w, int h, float threshold)
+{
+	seeknode_roi_t roi;
+	roi.name = name;
+	roi.is_polygon = false;
+	roi.x = x;
+	roi.y = y;
+	roi.w = w;
+	roi.h = h;
+	roi.threshold = threshold;
+	roi.threshold_index = seeknode_roi_engine_add_threshold(engine, threshold);
+
+	engine->rois.push_back(roi);
+	engine->stats.resize(engine->rois.size());
+}
+
+void seeknode_roi_engine_add_polygon(seeknode_roi_engine_t* engine, const std::string& name, const std::vector<float>& vertices, float threshold)
+{
+	seeknode_roi_t roi;
+	roi.name = name;
+	roi.is_polygon = true;
+	roi.vertices = vertices;
+	roi.threshold = threshold;
+	roi.threshold_index = seeknode_roi_engine_add_threshold(engine, threshold);
+
+	// Keep the bounding box for consumers that need a coarse extent.
+	float min_x = std::numeric_limits<float>::max();
+	float min_y = std::numeric_limits<float>::max();
+	float max_x = -std::numeric_limits<float>::max();
+	float max_y = -std::numeric_limits<float>::max();
+	for(size_t i = 0; i + 1 < vertices.size(); i += 2)
+	{
+		min_x = std::min(min_x, vertices[i]);
+		max_x = std::max(max_x, vertices[i]);
+		min_y = std::min(min_y, vertices[i + 1]);
+		max_y = std::max(max_y, vertices[i + 1]);
+	}
+	roi.x = (int)floorf(min_x);
+	roi.y = (int)floorf(min_y);
+	roi.w = (int)ceilf(max_x) - roi.x;
+	roi.h = (int)ceilf(max_y) - roi.y;
+
+	engine->rois.push_back(roi);
+	engine->stats.resize(engine->rois.size());
+	engine->width = 0; // Force the spans to be rasterized.
+}
+
+void seeknode_roi_engine_configure(seeknode_roi_engine_t* engine, size_t width, size_t height)
+{
+	seeknode_roi_engine_configure_window(engine, 0, 0, width, height);
+}
+
+void seeknode_roi_engine_configure_window(seeknode_roi_engine_t* engine, size_t origin_x, size_t origin_y, size_t width, size_t height)
+{
+	if(engine->origin_x == origin_x && engine->origin_y == origin_y && engine->width == width && engine->height == height)
+	{
+		return;
+	}
+
+	engine->origin_x = origin_x;
+	engine->origin_y = origin_y;
+	engine->width = width;
+	engine->height = height;
+
+	// The first row and column of every table stay zero.
+	const size_t table_size = (width + 1) * (height + 1);
+	engine->sum.assign(table_size, 0.0);
+	engine->sum_sq.assign(table_size, 0.0);
+	engine->counts.assign(table_size * engine->thresholds.size(), 0);
+	engine->row_sum.assign(width, 0.0);
+	engine->row_sum_sq.assign(width, 0.0);
+
+	for(auto& roi : engine->rois)
+	{
+		if(roi.is_polygon)
+		{
+			seeknode_roi_rasterize(&roi, origin_x, origin_y, width, height);
+		}
+	}
+}
+
+void seeknode_roi_engine_process(seeknode_roi_engine_t* engine, const float* pixels, size_t stride)
+{
+	seeknode_roi_engine_build_sums(engine, pixels, stride);
+	for(size_t i = 0; i < engine->thresholds.size(); ++i)
+	{
+		seeknode_roi_engine_build_counts(engine, i, pixels, stride);
+	}
+
+	const size_t table_stride = engine->width + 1;
+	const size_t table_size = table_stride * (engine->height + 1);
+
+	for(size_t i = 0; i < engine->rois.size(); ++i)
+	{
+		const seeknode_roi_t& roi = engine->rois[i];
+		const uint32_t* counts = roi.threshold_index >= 0 ? engine->counts.data() + roi.threshold_index * table_size : NULL;
+
+		double sum = 0.0;
+		double sum_sq = 0.0;
+		uint32_t area = 0;
+		uint32_t area_above = 0;
+		float min_value = std::numeric_limits<float>::max();
+		float max_value = -std::numeric_limits<float>::max();
+
+		if(!roi.is_polygon)
+		{
+			const int x = roi.x - (int)engine->origin_x;
+			const int y = roi.y - (int)engine->origin_y;
+			const size_t x0 = (size_t)std::min(std::max(x, 0), (int)engine->width);
+			const size_t y0 = (size_t)std::min(std::max(y, 0), (int)engine->height);
+			const size_t x1 = (size_t)std::min(std::max(x + roi.w, 0), (int)engine->width);
+			const size_t y1 = (size_t)std::min(std::max(y + roi.h, 0), (int)engine->height);
+			if(x1 > x0 && y1 > y0)
+			{
+				sum = seeknode_roi_table_sum(engine->sum.data(), table_stride, x0, y0, x1, y1);
+				sum_sq = seeknode_roi_table_sum(engine->sum_sq.data(), table_stride, x0, y0, x1, y1);
+				area = (uint32_t)((x1 - x0) * (y1 - y0));
+				if(counts != NULL)
+				{
+					area_above = seeknode_roi_table_sum(counts, table_stride, x0, y0, x1, y1);
+				}
+				if(engine->compute_extrema)
+				{
+					for(size_t y = y0; y < y1; ++y)
+					{
+						const float* row = (const float*)((const uint8_t*)pixels + y * stride);
+						seeknode_roi_scan_extrema(row, x0, x1, &min_value, &max_value);
+					}
+				}
+			}
+		}
+		else
+		{
+			for(const auto& span : roi.spans)
+			{
+				sum += seeknode_roi_table_sum(engine->sum.data(), table_stride, span.x0, span.y, span.x1, span.y + 1);
+				sum_sq += seeknode_roi_table_sum(engine->sum_sq.data(), table_stride, span.x0, span.y, span.x1, span.y + 1);
+				area += span.x1 - span.x0;
+				if(counts != NULL)
+				{
+					area_above += seeknode_roi_table_sum(counts, table_stride, span.x0, span.y, span.x1, span.y + 1);
+				}
+				if(engine->compute_extrema)
+				{
+					const float* row = (const float*)((const uint8_t*)pixels + span.y * stride);
+					seeknode_roi_scan_extrema(row, span.x0, span.x1, &min_value, &max_value);
+				}
+			}
+		}
+
+		seeknode_roi_stats_t& stats = engine->stats[i];
+		stats.area = area;
+		stats.area_above = area_above;
+		if(area > 0)
+		{
+			const double mean = sum / area;
+			stats.mean = (float)mean;
+			stats.stddev = (float)sqrt(std::max(sum_sq / area - mean * mean, 0.0));
+		}
+		else
+		{
+			stats.mean = NAN;
+			stats.stddev = NAN;
+		}
+		stats.min = (area > 0 && engine->compute_extrema) ? min_value : NAN;
+		stats.max = (area > 0 && engine->compute_extrema) ? max_value : NAN;
+	}
+}
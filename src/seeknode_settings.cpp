@@ -0,0 +1,123 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "seeknode/seeknode_settings.h"
+
+void seeknode_settings_init(seeknode_settings_t* settings)
+{
+	settings->shutter_mode = SEEKCAMERA_SHUTTER_MODE_AUTO;
+	settings->scene_emissivity = 1.0f;
+	settings->thermography_offset = 0.0f;
+	settings->gradient_correction = SEEKCAMERA_FILTER_STATE_ENABLED;
+	settings->flat_scene_correction = SEEKCAMERA_FILTER_STATE_ENABLED;
+}
+
+uint32_t seeknode_settings_read(seekcamera_t* camera, seeknode_settings_t* settings)
+{
+	uint32_t failed = 0;
+	if(seekcamera_get_shutter_mode(camera, &settings->shutter_mode) != SEEKCAMERA_SUCCESS)
+	{
+		failed |= SEEKNODE_SETTING_SHUTTER_MODE;
+	}
+	if(seekcamera_get_scene_emissivity(camera, &settings->scene_emissivity) != SEEKCAMERA_SUCCESS)
+	{
+		failed |= SEEKNODE_SETTING_SCENE_EMISSIVITY;
+	}
+	if(seekcamera_get_thermography_offset(camera, &settings->thermography_offset) != SEEKCAMERA_SUCCESS)
+	{
+		failed |= SEEKNODE_SETTING_THERMOGRAPHY_OFFSET;
+	}
+	if(seekcamera_get_filter_state(camera, SEEKCAMERA_FILTER_GRADIENT_CORRECTION, &settings->gradient_correction) != SEEKCAMERA_SUCCESS)
+	{
+		failed |= SEEKNODE_SETTING_GRADIENT_CORRECTION;
+	}
+	if(seekcamera_get_filter_state(camera, SEEKCAMERA_FILTER_FLAT_SCENE_CORRECTION, &settings->flat_scene_correction) != SEEKCAMERA_SUCCESS)
+	{
+		failed |= SEEKNODE_SETTING_FLAT_SCENE_CORRECTION;
+	}
+	return failed;
+}
+
+uint32_t seeknode_settings_diff(const seeknode_settings_t* a, const seeknode_settings_t* b)
+{
+	uint32_t mask = 0;
+	if(a->shutter_mode != b->shutter_mode)
+	{
+		mask |= SEEKNODE_SETTING_SHUTTER_MODE;
+	}
+	if(a->scene_emissivity != b->scene_emissivity)
+	{
+		mask |= SEEKNODE_SETTING_SCENE_EMISSIVITY;
+	}
+	if(a->thermography_offset != b->thermography_offset)
+	{
+		mask |= SEEKNODE_SETTING_THERMOGRAPHY_OFFSET;
+	}
+	if(a->gradient_correction != b->gradient_correction)
+	{
+		mask |= SEEKNODE_SETTING_GRADIENT_CORRECTION;
+	}
+	if(a->flat_scene_correction != b->flat_scene_correction)
+	{
+		mask |= SEEKNODE_SETTING_FLAT_SCENE_CORRECTION;
+	}
+	return mask;
+}
+
+uint32_t seeknode_settings_apply(seekcamera_t* camera, const seeknode_settings_t* settings, uint32_t mask)
+{
+	uint32_t failed = 0;
+	if((mask & SEEKNODE_SETTING_SHUTTER_MODE) != 0 && seekcamera_set_shutter_mode(camera, settings->shutter_mode) != SEEKCAMERA_SUCCESS)
+	{
+		failed |= SEEKNODE_SETTING_SHUTTER_MODE;
+	}
+	if((mask & SEEKNODE_SETTING_SCENE_EMISSIVITY) != 0 && seekcamera_set_scene_emissivity(camera, settings->scene_emissivity) != SEEKCAMERA_SUCCESS)
+	{
+		failed |= SEEKNODE_SETTING_SCENE_EMISSIVITY;
+	}
+	if((mask & SEEKNODE_SETTING_THERMOGRAPHY_OFFSET) != 0 && seekcamera_set_thermography_offset(camera, settings->thermography_offset) != SEEKCAMERA_SUCCESS)
+	{
+		failed |= SEEKNODE_SETTING_THERMOGRAPHY_OFFSET;
+	}
+	if((mask & SEEKNODE_SETTING_GRADIENT_CORRECTION) != 0 &&
+		seekcamera_set_filter_state(camera, SEEKCAMERA_FILTER_GRADIENT_CORRECTION, settings->gradient_correction) != SEEKCAMERA_SUCCESS)
+	{
+		failed |= SEEKNODE_SETTING_GRADIENT_CORRECTION;
+	}
+	if((mask & SEEKNODE_SETTING_FLAT_SCENE_CORRECTION) != 0 &&
+		seekcamera_set_filter_state(camera, SEEKCAMERA_FILTER_FLAT_SCENE_CORRECTION, settings->flat_scene_correction) != SEEKCAMERA_SUCCESS)
+	{
+		failed |= SEEKNODE_SETTING_FLAT_SCENE_CORRECTION;
+	}
+	return failed;
+}
+
+size_t seeknode_settings_count(uint32_t mask)
+{
+	size_t count = 0;
+	for(; mask != 0; mask &= mask - 1)
+	{
+		++count;
+	}
+	return count;
+}
@@ -0,0 +1,354 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "seeknode/seeknode_clock.h"
+#include "seeknode/seeknode_shm.h"
+
+// "SEEK", marks an initialized segment.
+static const uint32_t SHM_MAGIC = 0x4b454553;
+
+// Slots and pixel data start on cache lines so the writer never shares one with the header.
+static const size_t SHM_ALIGNMENT = 64;
+
+static size_t align_up(size_t value)
+{
+	return (value + SHM_ALIGNMENT - 1) / SHM_ALIGNMENT * SHM_ALIGNMENT;
+}
+
+static size_t get_header_size()
+{
+	return align_up(sizeof(seeknode_shm_header_t));
+}
+
+// The futex word is shared between processes, so the private futex operations cannot be used.
+static void futex_wake(std::atomic<uint32_t>* word)
+{
+	syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static void futex_wait(const std::atomic<uint32_t>* word, uint32_t value, int64_t timeout_ns)
+{
+	struct timespec timeout;
+	timeout.tv_sec = (time_t)(timeout_ns / 1000000000LL);
+	timeout.tv_nsec = (long)(timeout_ns % 1000000000LL);
+	syscall(SYS_futex, (const uint32_t*)word, FUTEX_WAIT, value, &timeout, NULL, 0);
+}
+
+void seeknode_shm_writer_init(seeknode_shm_writer_t* writer)
+{
+	writer->name.clear();
+	writer->fd = -1;
+	writer->base = NULL;
+	writer->size = 0;
+	writer->header = NULL;
+	writer->next_index = 0;
+}
+
+bool seeknode_shm_writer_open(seeknode_shm_writer_t* writer, const std::string& name, const char* chipid, size_t num_slots, size_t max_data_size)
+{
+	seeknode_shm_writer_close(writer);
+	if(num_slots < 2 || max_data_size == 0)
+	{
+		return false;
+	}
+
+	const size_t data_offset = align_up(sizeof(seeknode_shm_slot_t));
+	const size_t slot_size = align_up(data_offset + max_data_size);
+	const size_t size = get_header_size() + num_slots * slot_size;
+	if(slot_size > UINT32_MAX)
+	{
+		return false;
+	}
+
+	// A segment left by a previous run is replaced rather than reused; readers still mapping it see the old
+	// writer gone and reopen the name.
+	shm_unlink(name.c_str());
+	const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if(fd < 0)
+	{
+		return false;
+	}
+	if(ftruncate(fd, (off_t)size) != 0)
+	{
+		close(fd);
+		shm_unlink(name.c_str());
+		return false;
+	}
+	void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(base == MAP_FAILED)
+	{
+		close(fd);
+		shm_unlink(name.c_str());
+		return false;
+	}
+
+	// The segment is zero filled: every slot sequence is 0 and nothing is published.
+	seeknode_shm_header_t* header = (seeknode_shm_header_t*)base;
+	header->version = SEEKNODE_SHM_VERSION;
+	header->num_slots = (uint32_t)num_slots;
+	header->slot_size = (uint32_t)slot_size;
+	header->data_offset = (uint32_t)data_offset;
+	header->max_data_size = (uint32_t)max_data_size;
+	header->writer_pid = (uint32_t)getpid();
+	strncpy(header->chipid, chipid, sizeof(header->chipid) - 1);
+	header->magic.store(SHM_MAGIC, std::memory_order_release);
+
+	writer->name = name;
+	writer->fd = fd;
+	writer->base = (uint8_t*)base;
+	writer->size = size;
+	writer->header = header;
+	writer->next_index = 0;
+	return true;
+}
+
+bool seeknode_shm_writer_is_open(const seeknode_shm_writer_t* writer)
+{
+	return writer->header != NULL;
+}
+
+bool seeknode_shm_writer_publish(
+	seeknode_shm_writer_t* writer,
+	const seekcamera_frame_header_t* header,
+	int64_t stamp_ns,
+	seeknode_shm_format_t format,
+	const void* pixels,
+	size_t stride,
+	size_t width,
+	size_t height,
+	size_t pixel_size,
+	size_t origin_x,
+	size_t origin_y)
+{
+	seeknode_shm_header_t* shm = writer->header;
+	const size_t row_size = width * pixel_size;
+	if(shm == NULL || row_size * height > shm->max_data_size)
+	{
+		return false;
+	}
+
+	const uint64_t index = writer->next_index++;
+	uint8_t* slot_base = writer->base + get_header_size() + (size_t)(index % shm->num_slots) * shm->slot_size;
+	seeknode_shm_slot_t* slot = (seeknode_shm_slot_t*)slot_base;
+
+	// Open the seqlock; the fence keeps the writes below from becoming visible before the odd sequence.
+	slot->sequence.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot->frame_index = index;
+	slot->stamp_ns = stamp_ns;
+	slot->format = (uint32_t)format;
+	slot->width = (uint32_t)width;
+	slot->height = (uint32_t)height;
+	slot->stride = (uint32_t)row_size;
+	slot->origin_x = (uint32_t)origin_x;
+	slot->origin_y = (uint32_t)origin_y;
+	memcpy(&slot->header, header, sizeof(slot->header));
+
+	uint8_t* data = slot_base + shm->data_offset;
+	if(stride == row_size)
+	{
+		memcpy(data, pixels, row_size * height);
+	}
+	else
+	{
+		for(size_t y = 0; y < height; ++y)
+		{
+			memcpy(data + y * row_size, (const uint8_t*)pixels + y * stride, row_size);
+		}
+	}
+
+	slot->sequence.store(2 * index + 2, std::memory_order_release);
+	shm->published.store(index + 1, std::memory_order_release);
+	shm->notify.fetch_add(1, std::memory_order_release);
+	futex_wake(&shm->notify);
+	return true;
+}
+
+void seeknode_shm_writer_close(seeknode_shm_writer_t* writer)
+{
+	if(writer->header != NULL)
+	{
+		writer->header->is_closed.store(1, std::memory_order_release);
+		writer->header->notify.fetch_add(1, std::memory_order_release);
+		futex_wake(&writer->header->notify);
+		munmap(writer->base, writer->size);
+		close(writer->fd);
+		shm_unlink(writer->name.c_str());
+	}
+	seeknode_shm_writer_init(writer);
+}
+
+void seeknode_shm_reader_init(seeknode_shm_reader_t* reader)
+{
+	reader->fd = -1;
+	reader->base = NULL;
+	reader->size = 0;
+	reader->header = NULL;
+	reader->next_index = 0;
+	reader->num_read = 0;
+	reader->num_lost = 0;
+	reader->num_torn = 0;
+	reader->lag = 0;
+	reader->max_lag = 0;
+}
+
+bool seeknode_shm_reader_open(seeknode_shm_reader_t* reader, const std::string& name)
+{
+	seeknode_shm_reader_close(reader);
+
+	const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if(fd < 0)
+	{
+		return false;
+	}
+
+	// The writer sizes the segment before initializing it; a segment caught in between is rejected.
+	struct stat status;
+	if(fstat(fd, &status) != 0 || (size_t)status.st_size < get_header_size())
+	{
+		close(fd);
+		return false;
+	}
+	const size_t size = (size_t)status.st_size;
+	void* base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	if(base == MAP_FAILED)
+	{
+		close(fd);
+		return false;
+	}
+
+	const seeknode_shm_header_t* header = (const seeknode_shm_header_t*)base;
+	const bool is_valid = header->magic.load(std::memory_order_acquire) == SHM_MAGIC &&
+		header->version == SEEKNODE_SHM_VERSION &&
+		header->num_slots >= 2 &&
+		get_header_size() + (size_t)header->num_slots * header->slot_size <= size &&
+		(size_t)header->data_offset + header->max_data_size <= header->slot_size;
+	if(!is_valid)
+	{
+		munmap(base, size);
+		close(fd);
+		return false;
+	}
+
+	reader->fd = fd;
+	reader->base = (const uint8_t*)base;
+	reader->size = size;
+	reader->header = header;
+	reader->next_index = header->published.load(std::memory_order_acquire);
+	return true;
+}
+
+seeknode_shm_read_result_t seeknode_shm_reader_next(seeknode_shm_reader_t* reader, seeknode_shm_view_t* view, int64_t timeout_ns)
+{
+	const seeknode_shm_header_t* header = reader->header;
+	if(header == NULL)
+	{
+		return SEEKNODE_SHM_READ_CLOSED;
+	}
+
+	const int64_t deadline_ns = seeknode_clock_monotonic_ns() + timeout_ns;
+	for(;;)
+	{
+		// The futex word is sampled before the check so a publish in between makes the wait return at once.
+		const uint32_t notify = header->notify.load(std::memory_order_acquire);
+		const uint64_t published = header->published.load(std::memory_order_acquire);
+		if(reader->next_index >= published)
+		{
+			const bool is_writer_alive = kill((pid_t)header->writer_pid, 0) == 0 || errno == EPERM;
+			if(header->is_closed.load(std::memory_order_acquire) != 0 || !is_writer_alive)
+			{
+				return SEEKNODE_SHM_READ_CLOSED;
+			}
+
+			const int64_t now_ns = seeknode_clock_monotonic_ns();
+			if(now_ns >= deadline_ns)
+			{
+				return SEEKNODE_SHM_READ_TIMEOUT;
+			}
+			futex_wait(&header->notify, notify, deadline_ns - now_ns);
+			continue;
+		}
+
+		// Frame k lives in slot k % num_slots until frame k + num_slots starts being written.
+		if(reader->next_index + header->num_slots <= published)
+		{
+			reader->num_lost += published - 1 - reader->next_index;
+			reader->next_index = published - 1;
+		}
+
+		const uint64_t index = reader->next_index;
+		const uint8_t* slot_base = reader->base + get_header_size() + (size_t)(index % header->num_slots) * header->slot_size;
+		const seeknode_shm_slot_t* slot = (const seeknode_shm_slot_t*)slot_base;
+		const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+		if(sequence != 2 * index + 2)
+		{
+			// Lapped since published was sampled; the next pass skips ahead.
+			continue;
+		}
+
+		view->slot = slot;
+		view->data = slot_base + header->data_offset;
+		view->sequence = sequence;
+
+		++reader->next_index;
+		++reader->num_read;
+		reader->lag = published - reader->next_index;
+		reader->max_lag = reader->lag > reader->max_lag ? reader->lag : reader->max_lag;
+		return SEEKNODE_SHM_READ_OK;
+	}
+}
+
+bool seeknode_shm_reader_validate(seeknode_shm_reader_t* reader, const seeknode_shm_view_t* view)
+{
+	// Keep the reads of the frame from being reordered after the sequence check.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if(view->slot->sequence.load(std::memory_order_relaxed) == view->sequence)
+	{
+		return true;
+	}
+	++reader->num_torn;
+	return false;
+}
+
+void seeknode_shm_reader_close(seeknode_shm_reader_t* reader)
+{
+	if(reader->base != NULL)
+	{
+		munmap((void*)reader->base, reader->size);
+		close(reader->fd);
+	}
+	seeknode_shm_reader_init(reader);
+}
@@ -0,0 +1,162 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "seeknode/seeknode_shutter.h"
+
+// Weight of a new regular interval in the frame period estimate.
+static const double PERIOD_SMOOTHING = 0.05;
+
+// Blackouts ending within this time after a scheduled shutter are attributed to it.
+static const int64_t SCHEDULED_BLACKOUT_WINDOW_NS = 3000000000LL;
+
+void seeknode_shutter_init(seeknode_shutter_t* shutter)
+{
+	shutter->min_interval_ns = 10000000000LL;
+	shutter->max_interval_ns = 60000000000LL;
+	shutter->hard_interval_ns = 120000000000LL;
+	shutter->temperature_drift = 0.5f;
+	shutter->diode_drift = 0;
+	shutter->gap_factor = 2.5f;
+
+	shutter->has_reference = false;
+	shutter->last_shutter_ns = 0;
+	shutter->reference_temperature = 0.0f;
+	shutter->reference_diode = 0;
+	shutter->last_reason = SEEKNODE_SHUTTER_REASON_NONE;
+
+	shutter->last_frame_ns = 0;
+	shutter->period_ns = 0.0;
+	shutter->num_shutters = 0;
+	shutter->num_blackouts = 0;
+	shutter->num_scheduled_blackouts = 0;
+	shutter->total_blackout_ns = 0;
+	shutter->max_blackout_ns = 0;
+}
+
+const char* seeknode_shutter_reason_get_str(seeknode_shutter_reason_t reason)
+{
+	switch(reason)
+	{
+		case SEEKNODE_SHUTTER_REASON_NONE:
+			return "none";
+		case SEEKNODE_SHUTTER_REASON_INTERVAL:
+			return "interval";
+		case SEEKNODE_SHUTTER_REASON_TEMPERATURE:
+			return "temperature";
+		case SEEKNODE_SHUTTER_REASON_DIODE:
+			return "diode";
+		case SEEKNODE_SHUTTER_REASON_DEADLINE:
+			return "deadline";
+		default:
+			return "unknown";
+	}
+}
+
+int64_t seeknode_shutter_frame(seeknode_shutter_t* shutter, int64_t now_ns)
+{
+	const int64_t last_frame_ns = shutter->last_frame_ns;
+	shutter->last_frame_ns = now_ns;
+	if(last_frame_ns == 0)
+	{
+		return 0;
+	}
+
+	const int64_t interval_ns = now_ns - last_frame_ns;
+	if(shutter->period_ns <= 0.0)
+	{
+		shutter->period_ns = (double)interval_ns;
+		return 0;
+	}
+
+	// Regular intervals refine the period; long ones are blackouts and leave it alone.
+	if(interval_ns <= shutter->gap_factor * shutter->period_ns)
+	{
+		shutter->period_ns += PERIOD_SMOOTHING * ((double)interval_ns - shutter->period_ns);
+		return 0;
+	}
+
+	const int64_t blackout_ns = interval_ns - (int64_t)shutter->period_ns;
+	++shutter->num_blackouts;
+	shutter->total_blackout_ns += blackout_ns;
+	shutter->max_blackout_ns = blackout_ns > shutter->max_blackout_ns ? blackout_ns : shutter->max_blackout_ns;
+	if(shutter->num_shutters > 0 && now_ns - shutter->last_shutter_ns <= SCHEDULED_BLACKOUT_WINDOW_NS)
+	{
+		++shutter->num_scheduled_blackouts;
+	}
+	return blackout_ns;
+}
+
+bool seeknode_shutter_update(seeknode_shutter_t* shutter, int64_t now_ns, float environment_temperature, uint32_t diode_count, bool is_busy)
+{
+	// The first frame is the reference; the core shuttered at start-up.
+	if(!shutter->has_reference)
+	{
+		shutter->has_reference = true;
+		shutter->last_shutter_ns = now_ns;
+		shutter->reference_temperature = environment_temperature;
+		shutter->reference_diode = diode_count;
+		return false;
+	}
+
+	const int64_t elapsed_ns = now_ns - shutter->last_shutter_ns;
+	if(elapsed_ns < shutter->min_interval_ns)
+	{
+		return false;
+	}
+
+	seeknode_shutter_reason_t reason = SEEKNODE_SHUTTER_REASON_NONE;
+	if(elapsed_ns >= shutter->hard_interval_ns)
+	{
+		reason = SEEKNODE_SHUTTER_REASON_DEADLINE;
+	}
+	else if(is_busy)
+	{
+		return false;
+	}
+	else if(elapsed_ns >= shutter->max_interval_ns)
+	{
+		reason = SEEKNODE_SHUTTER_REASON_INTERVAL;
+	}
+	else if(shutter->temperature_drift > 0.0f && fabsf(environment_temperature - shutter->reference_temperature) >= shutter->temperature_drift)
+	{
+		reason = SEEKNODE_SHUTTER_REASON_TEMPERATURE;
+	}
+	else if(shutter->diode_drift > 0 && (uint32_t)labs((long)diode_count - (long)shutter->reference_diode) >= shutter->diode_drift)
+	{
+		reason = SEEKNODE_SHUTTER_REASON_DIODE;
+	}
+	else
+	{
+		return false;
+	}
+
+	shutter->last_reason = reason;
+	shutter->last_shutter_ns = now_ns;
+	shutter->reference_temperature = environment_temperature;
+	shutter->reference_diode = diode_count;
+	++shutter->num_shutters;
+	return true;
+}
@@ -0,0 +1,175 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+
+#include "seeknode/seeknode_clock.h"
+#include "seeknode/seeknode_simcam.h"
+
+// Number of noise patterns cycled through; each frame uses the next one.
+static const size_t NUM_NOISE_PATTERNS = 4;
+
+// Amplitude of the fixed noise, in degrees.
+static const float NOISE_AMPLITUDE = 0.5f;
+
+void seeknode_simcam_init(seeknode_simcam_t* camera)
+{
+	camera->chipid = "SIMCAM";
+	camera->width = 320;
+	camera->height = 240;
+	camera->rate = 27.0;
+	camera->background = 22.0f;
+	camera->hot_spot = 60.0f;
+	camera->hot_spot_size = 8;
+
+	camera->is_running = false;
+	camera->num_frames = 0;
+	camera->num_skipped = 0;
+}
+
+// Builds the noise patterns from a generator seeded by the chip id, so cameras differ but runs repeat.
+static void build_scene(seeknode_simcam_t* camera)
+{
+	uint32_t state = 2166136261u;
+	for(const char c : camera->chipid)
+	{
+		state = (state ^ (uint8_t)c) * 16777619u;
+	}
+
+	const size_t num_pixels = camera->width * camera->height;
+	camera->noise.resize(num_pixels * NUM_NOISE_PATTERNS);
+	for(float& value : camera->noise)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		value = ((state & 0xffff) / 65535.0f - 0.5f) * 2.0f * NOISE_AMPLITUDE;
+	}
+}
+
+// Renders frame number n: background, noise pattern and a hot spot sweeping the frame row by row.
+static void render(const seeknode_simcam_t* camera, seeknode_simcam_frame_t* frame, uint32_t number)
+{
+	const size_t width = camera->width;
+	const size_t height = camera->height;
+	const float* noise = camera->noise.data() + (number % NUM_NOISE_PATTERNS) * width * height;
+	float* pixels = frame->pixels.data();
+	for(size_t i = 0; i < width * height; ++i)
+	{
+		pixels[i] = camera->background + noise[i];
+	}
+
+	const size_t size = std::min(camera->hot_spot_size, std::min(width, height));
+	const size_t columns = width - size + 1;
+	const size_t rows = height - size + 1;
+	const size_t position = (number * 2) % (columns * rows);
+	const size_t spot_x = position % columns;
+	const size_t spot_y = (position / columns) % rows;
+	for(size_t y = spot_y; y < spot_y + size; ++y)
+	{
+		std::fill(pixels + y * width + spot_x, pixels + y * width + spot_x + size, camera->hot_spot);
+	}
+
+	seekcamera_frame_header_t* header = &frame->header;
+	header->fpa_frame_count = number;
+	header->timestamp_utc_ns = (uint64_t)seeknode_clock_realtime_ns();
+	header->environment_temperature = camera->background;
+	header->thermography_min_x = 0;
+	header->thermography_min_y = 0;
+	header->thermography_min_value = camera->background - NOISE_AMPLITUDE;
+	header->thermography_max_x = (uint16_t)spot_x;
+	header->thermography_max_y = (uint16_t)spot_y;
+	header->thermography_max_value = camera->hot_spot;
+	header->thermography_spot_x = (uint16_t)(width / 2);
+	header->thermography_spot_y = (uint16_t)(height / 2);
+	header->thermography_spot_value = pixels[(height / 2) * width + width / 2];
+}
+
+static void run(seeknode_simcam_t* camera, seeknode_simcam_callback_t callback)
+{
+	seeknode_simcam_frame_t frame;
+	memset(&frame.header, 0, sizeof(frame.header));
+	frame.header.type = SEEKCAMERA_FRAME_FORMAT_THERMOGRAPHY_FLOAT;
+	frame.header.width = (uint16_t)camera->width;
+	frame.header.height = (uint16_t)camera->height;
+	frame.header.channels = 1;
+	frame.header.pixel_depth = 32;
+	frame.header.line_stride = (uint16_t)(camera->width * sizeof(float));
+	strncpy(frame.header.chipid, camera->chipid.c_str(), sizeof(frame.header.chipid) - 1);
+	frame.pixels.resize(camera->width * camera->height);
+	frame.stride = camera->width * sizeof(float);
+
+	const int64_t period_ns = (int64_t)(1.0e9 / camera->rate);
+	int64_t deadline_ns = seeknode_clock_monotonic_ns();
+	uint32_t number = 0;
+	while(camera->is_running)
+	{
+		struct timespec deadline;
+		deadline.tv_sec = (time_t)(deadline_ns / 1000000000LL);
+		deadline.tv_nsec = (long)(deadline_ns % 1000000000LL);
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+		if(!camera->is_running)
+		{
+			break;
+		}
+
+		render(camera, &frame, number);
+		frame.capture_ns = deadline_ns;
+		callback(&frame);
+		++camera->num_frames;
+
+		// A late callback delays the next frame; frames due a full period before the callback returned are lost,
+		// but still advance the frame count.
+		deadline_ns += period_ns;
+		++number;
+		const int64_t now_ns = seeknode_clock_monotonic_ns();
+		if(now_ns - deadline_ns >= period_ns)
+		{
+			const int64_t num_missed = (now_ns - deadline_ns) / period_ns;
+			camera->num_skipped += (uint64_t)num_missed;
+			deadline_ns += num_missed * period_ns;
+			number += (uint32_t)num_missed;
+		}
+	}
+}
+
+void seeknode_simcam_start(seeknode_simcam_t* camera, seeknode_simcam_callback_t callback)
+{
+	build_scene(camera);
+	camera->num_frames = 0;
+	camera->num_skipped = 0;
+	camera->is_running = true;
+	camera->thread = std::thread(run, camera, callback);
+}
+
+void seeknode_simcam_stop(seeknode_simcam_t* camera)
+{
+	camera->is_running = false;
+	if(camera->thread.joinable())
+	{
+		camera->thread.join();
+	}
+}
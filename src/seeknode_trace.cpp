@@ -0,0 +1,305 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "seeknode/seeknode_clock.h"
+#include "seeknode/seeknode_trace.h"
+
+// Events of a thread, kept as a ring of the last events.
+// Only the owning thread records; the lock is uncontended except while the trace is written.
+typedef struct trace_buffer_t
+{
+	std::mutex mutex;
+	std::vector<seeknode_trace_event_t> events;
+	uint64_t num_events;        // Recorded since the buffer was cleared
+	int tid;
+	std::string thread_name;
+} trace_buffer_t;
+
+// Number of buffers of exited threads kept for a later write; older ones are dropped.
+// Capture session and SDK threads come and go with restarts and reconnects, so keeping them all would grow forever.
+static const size_t MAX_FINISHED_BUFFERS = 32;
+
+// Owner of the buffer and name of a thread; retires the buffer when the thread exits.
+typedef struct trace_thread_t
+{
+	std::shared_ptr<trace_buffer_t> buffer;
+	std::string name;
+
+	~trace_thread_t();
+} trace_thread_t;
+
+std::atomic<bool> g_seeknode_trace_enabled(false);
+
+// Buffers of the running threads that recorded, and of the last threads that exited.
+static std::mutex g_buffers_mutex;
+static std::vector<std::shared_ptr<trace_buffer_t> > g_buffers;
+static std::deque<std::shared_ptr<trace_buffer_t> > g_finished_buffers;
+static size_t g_capacity = 0;
+
+// The owner has a destructor, which makes every access to it check its initialization; events go through the plain
+// pointer instead.
+static thread_local trace_thread_t t_thread;
+static thread_local trace_buffer_t* t_buffer = NULL;
+static thread_local bool t_is_exiting = false;
+static thread_local char t_camera[SEEKNODE_TRACE_CAMERA_LENGTH] = { 0 };
+
+trace_thread_t::~trace_thread_t()
+{
+	t_is_exiting = true;
+	t_buffer = NULL;
+	if(!buffer)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(g_buffers_mutex);
+	for(auto it = g_buffers.begin(); it != g_buffers.end(); ++it)
+	{
+		if(*it == buffer)
+		{
+			g_buffers.erase(it);
+			break;
+		}
+	}
+	g_finished_buffers.push_back(std::move(buffer));
+	while(g_finished_buffers.size() > MAX_FINISHED_BUFFERS)
+	{
+		g_finished_buffers.pop_front();
+	}
+}
+
+// Gets the buffer of the calling thread, created on its first event.
+// Returns NULL once the thread is exiting.
+static trace_buffer_t* get_buffer()
+{
+	if(t_buffer != NULL || t_is_exiting)
+	{
+		return t_buffer;
+	}
+
+	std::shared_ptr<trace_buffer_t> buffer = std::make_shared<trace_buffer_t>();
+	buffer->num_events = 0;
+	buffer->tid = (int)syscall(SYS_gettid);
+	buffer->thread_name = t_thread.name;
+
+	std::lock_guard<std::mutex> lock(g_buffers_mutex);
+	buffer->events.resize(g_capacity);
+	g_buffers.push_back(buffer);
+	t_thread.buffer = buffer;
+	t_buffer = buffer.get();
+	return t_buffer;
+}
+
+static void record(const char* name, int64_t start_ns, int64_t duration_ns)
+{
+	trace_buffer_t* buffer = get_buffer();
+	if(buffer == NULL)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(buffer->mutex);
+	if(buffer->events.empty())
+	{
+		return;
+	}
+
+	seeknode_trace_event_t* event = &buffer->events[buffer->num_events % buffer->events.size()];
+	event->name = name;
+	event->start_ns = start_ns;
+	event->duration_ns = duration_ns;
+	memcpy(event->camera, t_camera, sizeof(event->camera));
+	++buffer->num_events;
+}
+
+void seeknode_trace_enable(size_t capacity)
+{
+	std::lock_guard<std::mutex> lock(g_buffers_mutex);
+	g_capacity = capacity;
+	for(const auto& buffer : g_buffers)
+	{
+		std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+		buffer->events.assign(capacity, seeknode_trace_event_t());
+		buffer->num_events = 0;
+	}
+	g_finished_buffers.clear();
+	g_seeknode_trace_enabled = capacity > 0;
+}
+
+void seeknode_trace_disable()
+{
+	g_seeknode_trace_enabled = false;
+}
+
+void seeknode_trace_set_camera(const char* camera)
+{
+	strncpy(t_camera, camera, sizeof(t_camera) - 1);
+}
+
+void seeknode_trace_set_thread_name(const std::string& name)
+{
+	if(t_is_exiting)
+	{
+		return;
+	}
+	t_thread.name = name;
+
+	if(t_buffer != NULL)
+	{
+		std::lock_guard<std::mutex> lock(t_buffer->mutex);
+		t_buffer->thread_name = name;
+	}
+}
+
+void seeknode_trace_complete(const char* name, int64_t start_ns, int64_t end_ns)
+{
+	record(name, start_ns, end_ns - start_ns);
+}
+
+void seeknode_trace_instant(const char* name)
+{
+	record(name, seeknode_clock_monotonic_ns(), -1);
+}
+
+seeknode_trace_scope_t::seeknode_trace_scope_t(const char* name) :
+	name(name),
+	start_ns(seeknode_trace_is_enabled() ? seeknode_clock_monotonic_ns() : 0)
+{
+}
+
+seeknode_trace_scope_t::~seeknode_trace_scope_t()
+{
+	if(start_ns != 0 && seeknode_trace_is_enabled())
+	{
+		record(name, start_ns, seeknode_clock_monotonic_ns() - start_ns);
+	}
+}
+
+// Writes a JSON string (names are static, cameras are chip ids, but thread names are free text).
+static void write_string(FILE* file, const char* text)
+{
+	fputc('"', file);
+	for(const char* c = text; *c != '\0'; ++c)
+	{
+		if(*c == '"' || *c == '\\')
+		{
+			fputc('\\', file);
+			fputc(*c, file);
+		}
+		else if((unsigned char)*c < 0x20)
+		{
+			fprintf(file, "\\u%04x", (unsigned char)*c);
+		}
+		else
+		{
+			fputc(*c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+bool seeknode_trace_write_json(const std::string& path)
+{
+	std::vector<std::shared_ptr<trace_buffer_t> > buffers;
+	{
+		std::lock_guard<std::mutex> lock(g_buffers_mutex);
+		buffers.assign(g_finished_buffers.begin(), g_finished_buffers.end());
+		buffers.insert(buffers.end(), g_buffers.begin(), g_buffers.end());
+	}
+
+	FILE* file = fopen(path.c_str(), "w");
+	if(file == NULL)
+	{
+		return false;
+	}
+
+	// Spans are written as complete ("X") events so a span whose begin was overwritten cannot be left dangling.
+	const int pid = (int)getpid();
+	const char* separator = "\n";
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	std::vector<seeknode_trace_event_t> events;
+	for(const auto& buffer : buffers)
+	{
+		std::string thread_name;
+		int tid = 0;
+		{
+			std::lock_guard<std::mutex> lock(buffer->mutex);
+			const size_t capacity = buffer->events.size();
+			const uint64_t first = buffer->num_events > capacity ? buffer->num_events - capacity : 0;
+			events.clear();
+			for(uint64_t i = first; i < buffer->num_events; ++i)
+			{
+				events.push_back(buffer->events[i % capacity]);
+			}
+			thread_name = buffer->thread_name;
+			tid = buffer->tid;
+		}
+
+		if(!thread_name.empty())
+		{
+			fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":", separator, pid, tid);
+			write_string(file, thread_name.c_str());
+			fprintf(file, "}}");
+			separator = ",\n";
+		}
+
+		for(const auto& event : events)
+		{
+			fprintf(file, "%s{\"name\":", separator);
+			write_string(file, event.name);
+			if(event.duration_ns >= 0)
+			{
+				fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", event.start_ns * 1.0e-3, event.duration_ns * 1.0e-3);
+			}
+			else
+			{
+				fprintf(file, ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f", event.start_ns * 1.0e-3);
+			}
+			fprintf(file, ",\"pid\":%d,\"tid\":%d", pid, tid);
+			if(event.camera[0] != '\0')
+			{
+				char camera[SEEKNODE_TRACE_CAMERA_LENGTH + 1] = { 0 };
+				memcpy(camera, event.camera, sizeof(event.camera));
+				fprintf(file, ",\"args\":{\"camera\":");
+				write_string(file, camera);
+				fputc('}', file);
+			}
+			fputc('}', file);
+			separator = ",\n";
+		}
+	}
+	fprintf(file, "\n]}\n");
+
+	const bool is_written = fflush(file) == 0 && ferror(file) == 0;
+	return fclose(file) == 0 && is_written;
+}
@@ -0,0 +1,693 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+
+#include "seeknode/seeknode_clock.h"
+#include "seeknode/seeknode_udp.h"
+
+// "SKUD", marks the packets of this protocol.
+static const uint32_t UDP_MAGIC = 0x44554b53;
+
+// Datagrams read per recvmmsg call and the largest one accepted (jumbo frames).
+static const size_t RECEIVE_BATCH = 32;
+static const size_t MAX_DATAGRAM_SIZE = 9000;
+
+// Wrap-around safe frame id order.
+static bool is_newer(uint32_t frame_id, uint32_t reference)
+{
+	return (int32_t)(frame_id - reference) > 0;
+}
+
+static size_t get_num_groups(size_t num_fragments, size_t group_size)
+{
+	return group_size > 0 ? (num_fragments + group_size - 1) / group_size : 0;
+}
+
+static size_t get_fragment_length(const seeknode_udp_packet_header_t* header, size_t index)
+{
+	return index + 1 < header->num_fragments ? header->fragment_size : header->frame_size - index * header->fragment_size;
+}
+
+// Draws a session id; senders opened in the same nanosecond (or by different processes) still differ.
+static uint32_t new_session_id()
+{
+	static std::atomic<uint32_t> num_sessions(0);
+	uint64_t x = (uint64_t)seeknode_clock_realtime_ns() ^ ((uint64_t)getpid() << 32) ^ (num_sessions++ * 0x9e3779b97f4a7c15ULL);
+
+	// splitmix64 finalizer
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return (uint32_t)x;
+}
+
+static uint32_t next_random(uint32_t* state)
+{
+	// xorshift32
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+void seeknode_udp_sender_init(seeknode_udp_sender_t* sender)
+{
+	sender->fragment_size = 1400;
+	sender->fec_group_size = 8;
+	sender->drop_probability = 0.0;
+
+	sender->fd = -1;
+	sender->session_id = 0;
+	sender->next_frame_id = 0;
+	sender->random_state = 0x9e3779b9;
+	sender->headers.clear();
+	sender->parity.clear();
+	sender->iovecs.clear();
+	sender->messages.clear();
+
+	sender->num_frames = 0;
+	sender->num_packets = 0;
+	sender->num_bytes = 0;
+	sender->num_dropped = 0;
+	sender->num_errors = 0;
+}
+
+bool seeknode_udp_sender_open(seeknode_udp_sender_t* sender, const std::string& host, uint16_t port)
+{
+	seeknode_udp_sender_close(sender);
+
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	struct addrinfo* addresses = NULL;
+	const std::string service = std::to_string(port);
+	if(getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) != 0)
+	{
+		return false;
+	}
+
+	int fd = -1;
+	for(struct addrinfo* address = addresses; address != NULL && fd < 0; address = address->ai_next)
+	{
+		fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+		if(fd >= 0 && connect(fd, address->ai_addr, address->ai_addrlen) != 0)
+		{
+			close(fd);
+			fd = -1;
+		}
+	}
+	freeaddrinfo(addresses);
+	if(fd < 0)
+	{
+		return false;
+	}
+
+	// A frame goes out as one burst; room for a few of them keeps the kernel from refusing packets.
+	const int buffer_size = 4 * 1024 * 1024;
+	setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+
+	sender->fd = fd;
+	sender->session_id = new_session_id();
+	sender->next_frame_id = 0;
+	return true;
+}
+
+bool seeknode_udp_sender_send(seeknode_udp_sender_t* sender, const seeknode_udp_frame_info_t* info, const void* data, size_t size)
+{
+	const size_t frame_size = size;
+	const size_t fragment_size = sender->fragment_size;
+	const size_t group_size = sender->fec_group_size < 255 ? sender->fec_group_size : 255;
+	if(sender->fd < 0 || frame_size == 0 || fragment_size == 0 || fragment_size > 0xffff || frame_size > 0xffffffffULL)
+	{
+		return false;
+	}
+	const size_t num_fragments = (frame_size + fragment_size - 1) / fragment_size;
+	if(num_fragments > 0xffff || info->width > 0xffff || info->height > 0xffff)
+	{
+		return false;
+	}
+	const size_t num_groups = get_num_groups(num_fragments, group_size);
+
+	seeknode_udp_packet_header_t base;
+	memset(&base, 0, sizeof(base));
+	base.magic = UDP_MAGIC;
+	base.version = SEEKNODE_UDP_VERSION;
+	base.type = SEEKNODE_UDP_PACKET_DATA;
+	base.format = (uint8_t)info->format;
+	base.fec_group_size = (uint8_t)group_size;
+	base.session_id = sender->session_id;
+	base.frame_id = sender->next_frame_id++;
+	base.num_fragments = (uint16_t)num_fragments;
+	base.fragment_size = (uint16_t)fragment_size;
+	base.width = (uint16_t)info->width;
+	base.height = (uint16_t)info->height;
+	base.frame_size = (uint32_t)frame_size;
+	base.fpa_frame_count = info->fpa_frame_count;
+	base.timestamp_utc_ns = info->timestamp_utc_ns;
+	base.send_time_ns = seeknode_clock_realtime_ns();
+	base.min_value = info->min_value;
+	base.max_value = info->max_value;
+
+	// Each group of fragments is followed by its parity packet so a burst loss rarely takes both.
+	const size_t num_packets = num_fragments + num_groups;
+	sender->headers.resize(num_packets);
+	sender->parity.assign(num_groups * fragment_size, 0);
+	sender->iovecs.resize(2 * num_packets);
+	sender->messages.resize(num_packets);
+	struct iovec* iovecs = sender->iovecs.data();
+	struct mmsghdr* messages = sender->messages.data();
+	size_t num_messages = 0;
+	size_t packet = 0;
+	for(size_t index = 0; index < num_fragments; ++index)
+	{
+		const size_t length = get_fragment_length(&base, index);
+		const uint8_t* payload = (const uint8_t*)data + index * fragment_size;
+		uint8_t* parity = NULL;
+		if(group_size > 0)
+		{
+			parity = sender->parity.data() + (index / group_size) * fragment_size;
+			for(size_t i = 0; i < length; ++i)
+			{
+				parity[i] ^= payload[i];
+			}
+		}
+
+		seeknode_udp_packet_header_t* header = &sender->headers[packet++];
+		*header = base;
+		header->index = (uint16_t)index;
+		const bool is_group_end = group_size > 0 && ((index + 1) % group_size == 0 || index + 1 == num_fragments);
+
+		for(int part = 0; part < (is_group_end ? 2 : 1); ++part)
+		{
+			if(part == 1)
+			{
+				header = &sender->headers[packet++];
+				*header = base;
+				header->type = SEEKNODE_UDP_PACKET_PARITY;
+				header->index = (uint16_t)(index / group_size);
+			}
+
+			if(sender->drop_probability > 0.0 && next_random(&sender->random_state) < sender->drop_probability * 4294967295.0)
+			{
+				++sender->num_dropped;
+				continue;
+			}
+
+			struct iovec* iov = &iovecs[2 * num_messages];
+			iov[0].iov_base = header;
+			iov[0].iov_len = sizeof(*header);
+			iov[1].iov_base = part == 0 ? (void*)payload : (void*)parity;
+			iov[1].iov_len = part == 0 ? length : fragment_size;
+
+			struct mmsghdr* message = &messages[num_messages++];
+			memset(message, 0, sizeof(*message));
+			message->msg_hdr.msg_iov = iov;
+			message->msg_hdr.msg_iovlen = 2;
+			sender->num_bytes += sizeof(*header) + iov[1].iov_len;
+		}
+	}
+
+	size_t num_sent = 0;
+	while(num_sent < num_messages)
+	{
+		const int result = sendmmsg(sender->fd, messages + num_sent, (unsigned int)(num_messages - num_sent), 0);
+		if(result < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			sender->num_errors += num_messages - num_sent;
+			break;
+		}
+		num_sent += (size_t)result;
+	}
+
+	++sender->num_frames;
+	sender->num_packets += num_sent;
+	return true;
+}
+
+void seeknode_udp_sender_close(seeknode_udp_sender_t* sender)
+{
+	if(sender->fd >= 0)
+	{
+		close(sender->fd);
+		sender->fd = -1;
+	}
+}
+
+void seeknode_udp_receiver_init(seeknode_udp_receiver_t* receiver)
+{
+	receiver->max_frames = 4;
+	receiver->max_delay_ns = 200000000LL;
+
+	receiver->fd = -1;
+	receiver->has_session = false;
+	receiver->session_id = 0;
+	receiver->previous_session_id = 0;
+	receiver->has_delivered = false;
+	receiver->last_frame_id = 0;
+	receiver->num_abandoned = 0;
+	receiver->assemblies.clear();
+	receiver->buffers.clear();
+	receiver->buffer_size = 0;
+	receiver->iovecs.clear();
+	receiver->messages.clear();
+
+	receiver->num_packets = 0;
+	receiver->num_invalid = 0;
+	receiver->num_sessions = 0;
+	receiver->num_frames = 0;
+	receiver->num_recovered = 0;
+	receiver->num_lost = 0;
+	receiver->num_late = 0;
+	receiver->num_fragments_expected = 0;
+	receiver->num_fragments_received = 0;
+	receiver->total_latency_ms = 0.0;
+	receiver->max_latency_ms = 0.0;
+	receiver->total_assembly_ms = 0.0;
+}
+
+bool seeknode_udp_receiver_open(seeknode_udp_receiver_t* receiver, uint16_t port)
+{
+	seeknode_udp_receiver_close(receiver);
+
+	const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if(fd < 0)
+	{
+		return false;
+	}
+
+	const int buffer_size = 4 * 1024 * 1024;
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+	if(bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	receiver->fd = fd;
+	receiver->assemblies.resize(receiver->max_frames > 0 ? receiver->max_frames : 1);
+	for(auto& assembly : receiver->assemblies)
+	{
+		assembly.is_used = false;
+		assembly.is_complete = false;
+	}
+	receiver->buffer_size = MAX_DATAGRAM_SIZE;
+	receiver->buffers.resize(RECEIVE_BATCH * receiver->buffer_size);
+	receiver->iovecs.resize(RECEIVE_BATCH);
+	receiver->messages.resize(RECEIVE_BATCH);
+	return true;
+}
+
+// Removes an assembly from the jitter buffer and accounts its fragments.
+static void release_assembly(seeknode_udp_receiver_t* receiver, seeknode_udp_assembly_t* assembly, bool is_delivered)
+{
+	receiver->num_fragments_expected += assembly->header.num_fragments;
+	receiver->num_fragments_received += assembly->num_received;
+	if(!is_delivered)
+	{
+		++receiver->num_abandoned;
+	}
+	assembly->is_used = false;
+	assembly->is_complete = false;
+}
+
+// Rebuilds the single missing fragment of a FEC group from its parity.
+static void rebuild_group(seeknode_udp_assembly_t* assembly, size_t group)
+{
+	const seeknode_udp_packet_header_t* header = &assembly->header;
+	const size_t group_size = header->fec_group_size;
+	const size_t begin = group * group_size;
+	const size_t end = begin + group_size < header->num_fragments ? begin + group_size : header->num_fragments;
+	if(!assembly->has_parity[group])
+	{
+		return;
+	}
+
+	size_t missing = end;
+	for(size_t index = begin; index < end; ++index)
+	{
+		if(!assembly->has_fragment[index])
+		{
+			if(missing != end)
+			{
+				return;
+			}
+			missing = index;
+		}
+	}
+	if(missing == end)
+	{
+		return;
+	}
+
+	uint8_t* target = assembly->data.data() + missing * header->fragment_size;
+	const size_t length = get_fragment_length(header, missing);
+	memcpy(target, assembly->parity.data() + group * header->fragment_size, length);
+	for(size_t index = begin; index < end; ++index)
+	{
+		if(index != missing)
+		{
+			const uint8_t* source = assembly->data.data() + index * header->fragment_size;
+			const size_t source_length = get_fragment_length(header, index);
+			for(size_t i = 0; i < length && i < source_length; ++i)
+			{
+				target[i] ^= source[i];
+			}
+		}
+	}
+	assembly->has_fragment[missing] = 1;
+	++assembly->num_rebuilt;
+}
+
+static void handle_packet(seeknode_udp_receiver_t* receiver, const uint8_t* packet, size_t size, int64_t now_ns)
+{
+	seeknode_udp_packet_header_t header;
+	if(size < sizeof(header))
+	{
+		++receiver->num_invalid;
+		return;
+	}
+	memcpy(&header, packet, sizeof(header));
+	const uint8_t* payload = packet + sizeof(header);
+	const size_t payload_size = size - sizeof(header);
+
+	const size_t num_groups = get_num_groups(header.num_fragments, header.fec_group_size);
+	const bool is_valid = header.magic == UDP_MAGIC &&
+		header.version == SEEKNODE_UDP_VERSION &&
+		header.fragment_size > 0 &&
+		header.frame_size > 0 &&
+		header.num_fragments == (header.frame_size + header.fragment_size - 1) / header.fragment_size &&
+		((header.type == SEEKNODE_UDP_PACKET_DATA && header.index < header.num_fragments && payload_size == get_fragment_length(&header, header.index)) ||
+		 (header.type == SEEKNODE_UDP_PACKET_PARITY && header.index < num_groups && payload_size == header.fragment_size));
+	if(!is_valid)
+	{
+		++receiver->num_invalid;
+		return;
+	}
+
+	// Parity trailing a frame that completed without it is not late, only unneeded.
+	const bool is_data = header.type == SEEKNODE_UDP_PACKET_DATA;
+
+	// A new session restarts the frame ids: its frames would all look older than the last delivered one.
+	// The frames buffered for the old session are given up and ordering starts over.
+	if(!receiver->has_session || header.session_id != receiver->session_id)
+	{
+		if(receiver->has_session && header.session_id == receiver->previous_session_id)
+		{
+			receiver->num_late += is_data ? 1 : 0;
+			return;
+		}
+		for(auto& assembly : receiver->assemblies)
+		{
+			if(assembly.is_used)
+			{
+				release_assembly(receiver, &assembly, false);
+			}
+		}
+		receiver->num_lost += receiver->has_delivered ? receiver->num_abandoned : 0;
+		receiver->previous_session_id = receiver->has_session ? receiver->session_id : header.session_id;
+		receiver->session_id = header.session_id;
+		receiver->has_session = true;
+		receiver->has_delivered = false;
+		receiver->num_abandoned = 0;
+		++receiver->num_sessions;
+	}
+
+	if(receiver->has_delivered && !is_newer(header.frame_id, receiver->last_frame_id))
+	{
+		receiver->num_late += is_data ? 1 : 0;
+		return;
+	}
+
+	// Find the frame in the jitter buffer, or open it in a free slot (evicting the oldest frame if needed).
+	seeknode_udp_assembly_t* assembly = NULL;
+	seeknode_udp_assembly_t* free_assembly = NULL;
+	seeknode_udp_assembly_t* oldest = NULL;
+	for(auto& candidate : receiver->assemblies)
+	{
+		if(!candidate.is_used)
+		{
+			free_assembly = free_assembly != NULL ? free_assembly : &candidate;
+		}
+		else if(candidate.header.frame_id == header.frame_id)
+		{
+			assembly = &candidate;
+			break;
+		}
+		else if(oldest == NULL || is_newer(oldest->header.frame_id, candidate.header.frame_id))
+		{
+			oldest = &candidate;
+		}
+	}
+	if(assembly == NULL)
+	{
+		if(free_assembly == NULL)
+		{
+			if(is_newer(oldest->header.frame_id, header.frame_id))
+			{
+				// Older than everything buffered; it would be evicted at once.
+				receiver->num_late += is_data ? 1 : 0;
+				return;
+			}
+			release_assembly(receiver, oldest, false);
+			free_assembly = oldest;
+		}
+		assembly = free_assembly;
+		assembly->is_used = true;
+		assembly->is_complete = false;
+		assembly->header = header;
+		assembly->first_arrival_ns = now_ns;
+		assembly->num_received = 0;
+		assembly->num_rebuilt = 0;
+		assembly->has_fragment.assign(header.num_fragments, 0);
+		assembly->has_parity.assign(num_groups, 0);
+		assembly->data.resize(header.frame_size);
+		assembly->parity.resize(num_groups * header.fragment_size);
+	}
+	else if(assembly->header.frame_size != header.frame_size || assembly->header.fragment_size != header.fragment_size || assembly->header.fec_group_size != header.fec_group_size)
+	{
+		++receiver->num_invalid;
+		return;
+	}
+	if(assembly->is_complete)
+	{
+		receiver->num_late += is_data ? 1 : 0;
+		return;
+	}
+
+	size_t group = 0;
+	if(is_data)
+	{
+		if(assembly->has_fragment[header.index])
+		{
+			return;
+		}
+		memcpy(assembly->data.data() + (size_t)header.index * header.fragment_size, payload, payload_size);
+		assembly->has_fragment[header.index] = 1;
+		++assembly->num_received;
+		group = header.fec_group_size > 0 ? header.index / header.fec_group_size : 0;
+	}
+	else
+	{
+		if(assembly->has_parity[header.index])
+		{
+			return;
+		}
+		memcpy(assembly->parity.data() + (size_t)header.index * header.fragment_size, payload, payload_size);
+		assembly->has_parity[header.index] = 1;
+		group = header.index;
+	}
+
+	if(header.fec_group_size > 0)
+	{
+		rebuild_group(assembly, group);
+	}
+	assembly->is_complete = assembly->num_received + assembly->num_rebuilt == header.num_fragments;
+}
+
+// Delivers the oldest complete frame; the incomplete frames before it are given up.
+static bool deliver(seeknode_udp_receiver_t* receiver, seeknode_udp_frame_t* frame)
+{
+	seeknode_udp_assembly_t* ready = NULL;
+	for(auto& candidate : receiver->assemblies)
+	{
+		if(candidate.is_used && candidate.is_complete && (ready == NULL || is_newer(ready->header.frame_id, candidate.header.frame_id)))
+		{
+			ready = &candidate;
+		}
+	}
+	if(ready == NULL)
+	{
+		return false;
+	}
+
+	const seeknode_udp_packet_header_t* header = &ready->header;
+	for(auto& candidate : receiver->assemblies)
+	{
+		if(candidate.is_used && is_newer(header->frame_id, candidate.header.frame_id))
+		{
+			release_assembly(receiver, &candidate, false);
+		}
+	}
+
+	// Frames never seen at all are counted with the fragment count of this one.
+	if(receiver->has_delivered)
+	{
+		const uint64_t skipped = (uint64_t)(header->frame_id - receiver->last_frame_id - 1);
+		receiver->num_lost += skipped;
+		if(skipped > receiver->num_abandoned)
+		{
+			receiver->num_fragments_expected += (skipped - receiver->num_abandoned) * header->num_fragments;
+		}
+	}
+	receiver->num_abandoned = 0;
+	receiver->has_delivered = true;
+	receiver->last_frame_id = header->frame_id;
+
+	frame->info.session_id = header->session_id;
+	frame->info.frame_id = header->frame_id;
+	frame->info.format = (seeknode_udp_format_t)header->format;
+	frame->info.width = header->width;
+	frame->info.height = header->height;
+	frame->info.fpa_frame_count = header->fpa_frame_count;
+	frame->info.timestamp_utc_ns = header->timestamp_utc_ns;
+	frame->info.send_time_ns = header->send_time_ns;
+	frame->info.min_value = header->min_value;
+	frame->info.max_value = header->max_value;
+	frame->data.swap(ready->data);
+
+	const double latency_ms = (seeknode_clock_realtime_ns() - header->send_time_ns) * 1.0e-6;
+	receiver->total_latency_ms += latency_ms;
+	receiver->max_latency_ms = latency_ms > receiver->max_latency_ms ? latency_ms : receiver->max_latency_ms;
+	receiver->total_assembly_ms += (seeknode_clock_monotonic_ns() - ready->first_arrival_ns) * 1.0e-6;
+	++receiver->num_frames;
+	if(ready->num_rebuilt > 0)
+	{
+		++receiver->num_recovered;
+	}
+	release_assembly(receiver, ready, true);
+	return true;
+}
+
+bool seeknode_udp_receiver_receive(seeknode_udp_receiver_t* receiver, seeknode_udp_frame_t* frame, int64_t timeout_ns)
+{
+	if(receiver->fd < 0)
+	{
+		return false;
+	}
+
+	struct iovec* iovecs = receiver->iovecs.data();
+	struct mmsghdr* messages = receiver->messages.data();
+	const int64_t deadline_ns = seeknode_clock_monotonic_ns() + timeout_ns;
+	for(;;)
+	{
+		if(deliver(receiver, frame))
+		{
+			return true;
+		}
+
+		// Give up the frames that waited too long for their missing fragments.
+		int64_t now_ns = seeknode_clock_monotonic_ns();
+		for(auto& assembly : receiver->assemblies)
+		{
+			if(assembly.is_used && now_ns - assembly.first_arrival_ns > receiver->max_delay_ns)
+			{
+				release_assembly(receiver, &assembly, false);
+			}
+		}
+
+		if(now_ns >= deadline_ns)
+		{
+			return false;
+		}
+
+		struct pollfd descriptor;
+		descriptor.fd = receiver->fd;
+		descriptor.events = POLLIN;
+		descriptor.revents = 0;
+		const int timeout_ms = (int)((deadline_ns - now_ns + 999999) / 1000000);
+		if(poll(&descriptor, 1, timeout_ms) <= 0)
+		{
+			continue;
+		}
+
+		for(size_t i = 0; i < RECEIVE_BATCH; ++i)
+		{
+			iovecs[i].iov_base = receiver->buffers.data() + i * receiver->buffer_size;
+			iovecs[i].iov_len = receiver->buffer_size;
+			memset(&messages[i], 0, sizeof(messages[i]));
+			messages[i].msg_hdr.msg_iov = &iovecs[i];
+			messages[i].msg_hdr.msg_iovlen = 1;
+		}
+		const int num_messages = recvmmsg(receiver->fd, messages, (unsigned int)RECEIVE_BATCH, MSG_DONTWAIT, NULL);
+		if(num_messages <= 0)
+		{
+			continue;
+		}
+
+		now_ns = seeknode_clock_monotonic_ns();
+		for(int i = 0; i < num_messages; ++i)
+		{
+			++receiver->num_packets;
+			if(messages[i].msg_hdr.msg_flags & MSG_TRUNC)
+			{
+				++receiver->num_invalid;
+				continue;
+			}
+			handle_packet(receiver, (const uint8_t*)iovecs[i].iov_base, messages[i].msg_len, now_ns);
+		}
+	}
+}
+
+void seeknode_udp_receiver_close(seeknode_udp_receiver_t* receiver)
+{
+	if(receiver->fd >= 0)
+	{
+		close(receiver->fd);
+		receiver->fd = -1;
+	}
+}
@@ -0,0 +1,203 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "seeknode/seeknode_undistort.h"
+#include "seeknode/seeknode_simd.h"
+
+// Sub-pixel positions per axis, including the position of the next pixel (fraction 1) used at the last row/column.
+static const size_t WEIGHT_POSITIONS = SEEKNODE_UNDISTORT_INTER_SIZE + 1;
+
+// Index of the all-zero weights used by output pixels outside the source frame.
+static const uint16_t INVALID_WEIGHT = (uint16_t)(WEIGHT_POSITIONS * WEIGHT_POSITIONS);
+
+// Fills the bilinear weight table.
+static void seeknode_undistort_build_weights(seeknode_undistort_t* undistort)
+{
+	const size_t num_entries = WEIGHT_POSITIONS * WEIGHT_POSITIONS + 1;
+	undistort->weights_f32.assign(num_entries * 4, 0.0f);
+	undistort->bias_f32.assign(num_entries, 0.0f);
+	undistort->bias_f32[INVALID_WEIGHT] = NAN;
+
+	for(size_t fy = 0; fy < WEIGHT_POSITIONS; ++fy)
+	{
+		for(size_t fx = 0; fx < WEIGHT_POSITIONS; ++fx)
+		{
+			const float ax = (float)fx / SEEKNODE_UNDISTORT_INTER_SIZE;
+			const float ay = (float)fy / SEEKNODE_UNDISTORT_INTER_SIZE;
+			const float w[4] = { (1.0f - ax) * (1.0f - ay), ax * (1.0f - ay), (1.0f - ax) * ay, ax * ay };
+
+			const size_t entry = fy * WEIGHT_POSITIONS + fx;
+			memcpy(&undistort->weights_f32[entry * 4], w, sizeof(w));
+		}
+	}
+}
+
+// Returns a pointer to a source pixel.
+static inline const float* seeknode_undistort_source(const float* src, size_t src_stride, uint16_t x, uint16_t y)
+{
+	return (const float*)((const uint8_t*)src + y * src_stride) + x;
+}
+
+// Interpolates four consecutive output pixels.
+// The corners are gathered into lanes and the weighted sum is computed for the four pixels at once.
+static inline seeknode_f32x4_t seeknode_undistort_remap4(const seeknode_undistort_t* undistort, const float* src, size_t src_stride, size_t i)
+{
+	float c00[4], c01[4], c10[4], c11[4];
+	float w00[4], w01[4], w10[4], w11[4];
+	float bias[4];
+	for(size_t k = 0; k < 4; ++k)
+	{
+		const uint16_t* xy = &undistort->map_xy[(i + k) * 2];
+		const float* p0 = seeknode_undistort_source(src, src_stride, xy[0], xy[1]);
+		const float* p1 = (const float*)((const uint8_t*)p0 + src_stride);
+		c00[k] = p0[0];
+		c01[k] = p0[1];
+		c10[k] = p1[0];
+		c11[k] = p1[1];
+
+		const uint16_t entry = undistort->map_weight[i + k];
+		const float* w = &undistort->weights_f32[entry * 4];
+		w00[k] = w[0];
+		w01[k] = w[1];
+		w10[k] = w[2];
+		w11[k] = w[3];
+		bias[k] = undistort->bias_f32[entry];
+	}
+
+	seeknode_f32x4_t v = seeknode_f32x4_mul(seeknode_f32x4_load(c00), seeknode_f32x4_load(w00));
+	v = seeknode_f32x4_add(v, seeknode_f32x4_mul(seeknode_f32x4_load(c01), seeknode_f32x4_load(w01)));
+	v = seeknode_f32x4_add(v, seeknode_f32x4_mul(seeknode_f32x4_load(c10), seeknode_f32x4_load(w10)));
+	v = seeknode_f32x4_add(v, seeknode_f32x4_mul(seeknode_f32x4_load(c11), seeknode_f32x4_load(w11)));
+	return seeknode_f32x4_add(v, seeknode_f32x4_load(bias));
+}
+
+// Interpolates a single output pixel.
+static inline float seeknode_undistort_remap1(const seeknode_undistort_t* undistort, const float* src, size_t src_stride, size_t i)
+{
+	const uint16_t* xy = &undistort->map_xy[i * 2];
+	const float* p0 = seeknode_undistort_source(src, src_stride, xy[0], xy[1]);
+	const float* p1 = (const float*)((const uint8_t*)p0 + src_stride);
+	const uint16_t entry = undistort->map_weight[i];
+	const float* w = &undistort->weights_f32[entry * 4];
+	return p0[0] * w[0] + p0[1] * w[1] + p1[0] * w[2] + p1[1] * w[3] + undistort->bias_f32[entry];
+}
+
+void seeknode_undistort_init(seeknode_undistort_t* undistort)
+{
+	memset(&undistort->model, 0, sizeof(undistort->model));
+	undistort->width = 0;
+	undistort->height = 0;
+	undistort->map_xy.clear();
+	undistort->map_weight.clear();
+	undistort->weights_f32.clear();
+	undistort->bias_f32.clear();
+}
+
+bool seeknode_undistort_model_is_valid(const seeknode_camera_model_t* model)
+{
+	return model->fx > 0.0 && model->fy > 0.0;
+}
+
+void seeknode_undistort_configure(seeknode_undistort_t* undistort, const seeknode_camera_model_t* model, size_t width, size_t height)
+{
+	if(undistort->width == width && undistort->height == height && memcmp(&undistort->model, model, sizeof(*model)) == 0)
+	{
+		return;
+	}
+
+	undistort->model = *model;
+	undistort->width = width;
+	undistort->height = height;
+	undistort->map_xy.assign(width * height * 2, 0);
+	undistort->map_weight.assign(width * height, INVALID_WEIGHT);
+	if(undistort->weights_f32.empty())
+	{
+		seeknode_undistort_build_weights(undistort);
+	}
+
+	if(width < 2 || height < 2 || !seeknode_undistort_model_is_valid(model))
+	{
+		return;
+	}
+
+	// For every rectified pixel, find where the lens puts it in the raw frame.
+	// The rectified image keeps the camera matrix of the raw image.
+	const double max_x = (double)(width - 1);
+	const double max_y = (double)(height - 1);
+	for(size_t v = 0; v < height; ++v)
+	{
+		for(size_t u = 0; u < width; ++u)
+		{
+			const double x = ((double)u - model->cx) / model->fx;
+			const double y = ((double)v - model->cy) / model->fy;
+			const double r2 = x * x + y * y;
+			const double radial = 1.0 + r2 * (model->k1 + r2 * (model->k2 + r2 * model->k3));
+			const double xd = x * radial + 2.0 * model->p1 * x * y + model->p2 * (r2 + 2.0 * x * x);
+			const double yd = y * radial + model->p1 * (r2 + 2.0 * y * y) + 2.0 * model->p2 * x * y;
+			const double sx = model->fx * xd + model->cx;
+			const double sy = model->fy * yd + model->cy;
+
+			if(!(sx >= 0.0 && sx <= max_x && sy >= 0.0 && sy <= max_y))
+			{
+				continue;
+			}
+
+			// Fixed point source position; the last row/column reads from its predecessor with a fraction of 1.
+			const long qx = lrint(sx * SEEKNODE_UNDISTORT_INTER_SIZE);
+			const long qy = lrint(sy * SEEKNODE_UNDISTORT_INTER_SIZE);
+			const long x0 = std::min(qx >> SEEKNODE_UNDISTORT_INTER_BITS, (long)width - 2);
+			const long y0 = std::min(qy >> SEEKNODE_UNDISTORT_INTER_BITS, (long)height - 2);
+			const long fx = qx - x0 * SEEKNODE_UNDISTORT_INTER_SIZE;
+			const long fy = qy - y0 * SEEKNODE_UNDISTORT_INTER_SIZE;
+
+			const size_t i = v * width + u;
+			undistort->map_xy[i * 2 + 0] = (uint16_t)x0;
+			undistort->map_xy[i * 2 + 1] = (uint16_t)y0;
+			undistort->map_weight[i] = (uint16_t)(fy * WEIGHT_POSITIONS + fx);
+		}
+	}
+}
+
+void seeknode_undistort_remap_f32(const seeknode_undistort_t* undistort, const float* src, size_t src_stride, float* dst, size_t dst_stride)
+{
+	const size_t width = undistort->width;
+	for(size_t y = 0; y < undistort->height; ++y)
+	{
+		float* row = (float*)((uint8_t*)dst + y * dst_stride);
+		const size_t i = y * width;
+		size_t x = 0;
+		for(; x + SEEKNODE_F32X4_LANES <= width; x += SEEKNODE_F32X4_LANES)
+		{
+			seeknode_f32x4_store(row + x, seeknode_undistort_remap4(undistort, src, src_stride, i + x));
+		}
+		for(; x < width; ++x)
+		{
+			row[x] = seeknode_undistort_remap1(undistort, src, src_stride, i + x);
+		}
+	}
+}
@@ -0,0 +1,164 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "seeknode/seeknode_welford.h"
+#include "seeknode/seeknode_simd.h"
+
+// Folds the pending batch into the float64 planes and moves the pivot to the new mean.
+static void seeknode_welford_fold(seeknode_welford_t* welford)
+{
+	const size_t k = welford->batch_count;
+	if(k == 0)
+	{
+		return;
+	}
+
+	const size_t num_pixels = welford->width * welford->height;
+	const double n = (double)welford->count;
+	const double inv_k = 1.0 / (double)k;
+	const double weight = n * (double)k / (n + (double)k);
+	const double ratio = (double)k / (n + (double)k);
+	for(size_t i = 0; i < num_pixels; ++i)
+	{
+		const double batch_sum = welford->sum[i];
+		const double batch_mean = welford->pivot[i] + batch_sum * inv_k;
+		const double batch_m2 = std::max(welford->sum_squares[i] - batch_sum * batch_sum * inv_k, 0.0);
+		const double delta = batch_mean - welford->mean[i];
+		welford->mean[i] += delta * ratio;
+		welford->m2[i] += batch_m2 + delta * delta * weight;
+		welford->pivot[i] = (float)welford->mean[i];
+	}
+
+	welford->count += k;
+	welford->batch_count = 0;
+	memset(welford->sum.data(), 0, num_pixels * sizeof(float));
+	memset(welford->sum_squares.data(), 0, num_pixels * sizeof(float));
+}
+
+void seeknode_welford_init(seeknode_welford_t* welford)
+{
+	welford->batch_frames = 32;
+	welford->width = 0;
+	welford->height = 0;
+	welford->count = 0;
+	welford->mean.clear();
+	welford->m2.clear();
+	welford->batch_count = 0;
+	welford->pivot.clear();
+	welford->sum.clear();
+	welford->sum_squares.clear();
+}
+
+void seeknode_welford_configure(seeknode_welford_t* welford, size_t width, size_t height)
+{
+	if(welford->width == width && welford->height == height)
+	{
+		return;
+	}
+
+	welford->width = width;
+	welford->height = height;
+	welford->mean.resize(width * height);
+	welford->m2.resize(width * height);
+	welford->pivot.resize(width * height);
+	welford->sum.resize(width * height);
+	welford->sum_squares.resize(width * height);
+	seeknode_welford_reset(welford);
+}
+
+void seeknode_welford_reset(seeknode_welford_t* welford)
+{
+	const size_t num_pixels = welford->width * welford->height;
+	welford->count = 0;
+	welford->batch_count = 0;
+	memset(welford->mean.data(), 0, num_pixels * sizeof(double));
+	memset(welford->m2.data(), 0, num_pixels * sizeof(double));
+	memset(welford->sum.data(), 0, num_pixels * sizeof(float));
+	memset(welford->sum_squares.data(), 0, num_pixels * sizeof(float));
+}
+
+void seeknode_welford_add(seeknode_welford_t* welford, const float* pixels, size_t stride)
+{
+	const size_t width = welford->width;
+	const size_t height = welford->height;
+
+	// The first frame of a window is the pivot; later pivots are the running mean.
+	if(welford->count == 0 && welford->batch_count == 0)
+	{
+		for(size_t y = 0; y < height; ++y)
+		{
+			memcpy(welford->pivot.data() + y * width, (const uint8_t*)pixels + y * stride, width * sizeof(float));
+		}
+	}
+
+	for(size_t y = 0; y < height; ++y)
+	{
+		const float* row = (const float*)((const uint8_t*)pixels + y * stride);
+		const float* pivot = welford->pivot.data() + y * width;
+		float* sum = welford->sum.data() + y * width;
+		float* sum_squares = welford->sum_squares.data() + y * width;
+
+		size_t x = 0;
+		for(; x + SEEKNODE_F32X4_LANES <= width; x += SEEKNODE_F32X4_LANES)
+		{
+			const seeknode_f32x4_t d = seeknode_f32x4_sub(seeknode_f32x4_load(row + x), seeknode_f32x4_load(pivot + x));
+			seeknode_f32x4_store(sum + x, seeknode_f32x4_add(seeknode_f32x4_load(sum + x), d));
+			seeknode_f32x4_store(sum_squares + x, seeknode_f32x4_add(seeknode_f32x4_load(sum_squares + x), seeknode_f32x4_mul(d, d)));
+		}
+		for(; x < width; ++x)
+		{
+			const float d = row[x] - pivot[x];
+			sum[x] += d;
+			sum_squares[x] += d * d;
+		}
+	}
+
+	++welford->batch_count;
+	if(welford->batch_count >= welford->batch_frames)
+	{
+		seeknode_welford_fold(welford);
+	}
+}
+
+uint64_t seeknode_welford_get_count(const seeknode_welford_t* welford)
+{
+	return welford->count + welford->batch_count;
+}
+
+void seeknode_welford_snapshot(seeknode_welford_t* welford, float* mean, float* stddev)
+{
+	seeknode_welford_fold(welford);
+
+	const size_t num_pixels = welford->width * welford->height;
+	const double inv_n = welford->count > 1 ? 1.0 / (double)(welford->count - 1) : 0.0;
+	for(size_t i = 0; i < num_pixels; ++i)
+	{
+		mean[i] = (float)welford->mean[i];
+		stddev[i] = (float)sqrt(welford->m2[i] * inv_n);
+	}
+}
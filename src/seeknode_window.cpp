@@ -0,0 +1,153 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include "seeknode/seeknode_window.h"
+
+void seeknode_window_init(seeknode_window_t* window)
+{
+	window->margin = 8;
+	window->alignment = 4;
+	window->shrink_ratio = 0.75f;
+
+	window->sensor_width = 0;
+	window->sensor_height = 0;
+	window->x = 0;
+	window->y = 0;
+	window->width = 0;
+	window->height = 0;
+
+	window->num_changes = 0;
+	seeknode_window_begin(window);
+}
+
+void seeknode_window_configure(seeknode_window_t* window, size_t sensor_width, size_t sensor_height)
+{
+	if(window->sensor_width == sensor_width && window->sensor_height == sensor_height)
+	{
+		return;
+	}
+
+	window->sensor_width = sensor_width;
+	window->sensor_height = sensor_height;
+	window->x = 0;
+	window->y = 0;
+	window->width = sensor_width;
+	window->height = sensor_height;
+}
+
+void seeknode_window_begin(seeknode_window_t* window)
+{
+	window->left = 0;
+	window->top = 0;
+	window->right = 0;
+	window->bottom = 0;
+	window->is_full_requested = false;
+}
+
+void seeknode_window_add(seeknode_window_t* window, long x, long y, long width, long height)
+{
+	if(width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	if(window->right <= window->left)
+	{
+		window->left = x;
+		window->top = y;
+		window->right = x + width;
+		window->bottom = y + height;
+		return;
+	}
+
+	window->left = std::min(window->left, x);
+	window->top = std::min(window->top, y);
+	window->right = std::max(window->right, x + width);
+	window->bottom = std::max(window->bottom, y + height);
+}
+
+void seeknode_window_add_full(seeknode_window_t* window)
+{
+	window->is_full_requested = true;
+}
+
+bool seeknode_window_update(seeknode_window_t* window)
+{
+	const long sensor_width = (long)window->sensor_width;
+	const long sensor_height = (long)window->sensor_height;
+	const long alignment = std::max(window->alignment, 1);
+
+	// Grow the union by the margin, align it outwards and clip it to the sensor.
+	const bool is_full = window->is_full_requested || window->right <= window->left || window->bottom <= window->top;
+	long left = 0;
+	long top = 0;
+	long right = sensor_width;
+	long bottom = sensor_height;
+	if(!is_full)
+	{
+		left = std::max(window->left - window->margin, 0L) / alignment * alignment;
+		top = std::max(window->top - window->margin, 0L) / alignment * alignment;
+		right = std::min((window->right + window->margin + alignment - 1) / alignment * alignment, sensor_width);
+		bottom = std::min((window->bottom + window->margin + alignment - 1) / alignment * alignment, sensor_height);
+		if(right <= left || bottom <= top)
+		{
+			left = 0;
+			top = 0;
+			right = sensor_width;
+			bottom = sensor_height;
+		}
+	}
+
+	const long x = (long)window->x;
+	const long y = (long)window->y;
+	const long width = (long)window->width;
+	const long height = (long)window->height;
+	const bool is_covered = !is_full &&
+		window->left >= x && window->top >= y && window->right <= x + width && window->bottom <= y + height;
+	seeknode_window_begin(window);
+
+	if(left == x && top == y && right - left == width && bottom - top == height)
+	{
+		return false;
+	}
+
+	// While the current window still covers every rectangle, it is only replaced if that saves enough area.
+	if(is_covered && (double)(right - left) * (bottom - top) >= (double)window->shrink_ratio * width * height)
+	{
+		return false;
+	}
+
+	window->x = (size_t)left;
+	window->y = (size_t)top;
+	window->width = (size_t)(right - left);
+	window->height = (size_t)(bottom - top);
+	++window->num_changes;
+	return true;
+}
+
+bool seeknode_window_is_full(const seeknode_window_t* window)
+{
+	return window->width == window->sensor_width && window->height == window->sensor_height;
+}
@@ -0,0 +1,157 @@
+/*Copyright (c) [2020] [Seek Thermal, Inc.]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The Software may only be used in combination with Seek cores/products.
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include "seeknode/seeknode_workqueue.h"
+
+// Returns true if a task of the key is running.
+static bool seeknode_workqueue_is_running(const seeknode_workqueue_t* queue, const void* key)
+{
+	return std::find(queue->running.begin(), queue->running.end(), key) != queue->running.end();
+}
+
+// Returns the oldest pending task that can start now: its key is not running, no older task of its key is pending and
+// its delay has elapsed. The earliest time a delayed task becomes startable is written to wake_time.
+static std::deque<seeknode_work_t>::iterator seeknode_workqueue_find(
+	seeknode_workqueue_t* queue,
+	std::chrono::steady_clock::time_point now,
+	std::chrono::steady_clock::time_point* wake_time)
+{
+	*wake_time = std::chrono::steady_clock::time_point::max();
+	for(auto work = queue->pending.begin(); work != queue->pending.end(); ++work)
+	{
+		const void* key = work->key;
+		if(seeknode_workqueue_is_running(queue, key) ||
+			std::any_of(queue->pending.begin(), work, [key](const seeknode_work_t& older) { return older.key == key; }))
+		{
+			continue;
+		}
+		if(work->not_before > now)
+		{
+			*wake_time = std::min(*wake_time, work->not_before);
+			continue;
+		}
+		return work;
+	}
+	return queue->pending.end();
+}
+
+// Worker thread: runs the oldest pending task that can start, sleeping until the next delayed task is due.
+static void seeknode_workqueue_worker(seeknode_workqueue_t* queue)
+{
+	std::unique_lock<std::mutex> lock(queue->mutex);
+	while(true)
+	{
+		auto work = queue->pending.end();
+		while(!queue->is_stopping)
+		{
+			std::chrono::steady_clock::time_point wake_time;
+			work = seeknode_workqueue_find(queue, std::chrono::steady_clock::now(), &wake_time);
+			if(work != queue->pending.end())
+			{
+				break;
+			}
+			if(wake_time == std::chrono::steady_clock::time_point::max())
+			{
+				queue->work_available.wait(lock);
+			}
+			else
+			{
+				queue->work_available.wait_until(lock, wake_time);
+			}
+		}
+		if(queue->is_stopping)
+		{
+			return;
+		}
+
+		const void* key = work->key;
+		std::function<void()> function = std::move(work->function);
+		queue->pending.erase(work);
+		queue->running.push_back(key);
+
+		lock.unlock();
+		function();
+		lock.lock();
+
+		queue->running.erase(std::find(queue->running.begin(), queue->running.end(), key));
+		queue->work_done.notify_all();
+
+		// The next task of this key may have been skipped while it was running.
+		queue->work_available.notify_all();
+	}
+}
+
+void seeknode_workqueue_start(seeknode_workqueue_t* queue, size_t num_threads)
+{
+	queue->is_stopping = false;
+	for(size_t i = 0; i < std::max(num_threads, (size_t)1); ++i)
+	{
+		queue->threads.emplace_back(seeknode_workqueue_worker, queue);
+	}
+}
+
+void seeknode_workqueue_submit(seeknode_workqueue_t* queue, const void* key, std::function<void()> function)
+{
+	seeknode_workqueue_submit_delayed(queue, key, 0, std::move(function));
+}
+
+void seeknode_workqueue_submit_delayed(seeknode_workqueue_t* queue, const void* key, int64_t delay_ms, std::function<void()> function)
+{
+	std::lock_guard<std::mutex> lock(queue->mutex);
+	seeknode_work_t work;
+	work.key = key;
+	work.not_before = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(delay_ms, (int64_t)0));
+	work.function = std::move(function);
+	queue->pending.push_back(std::move(work));
+
+	// Every worker recomputes its wake-up time, so a delayed task never waits behind a longer one.
+	queue->work_available.notify_all();
+}
+
+size_t seeknode_workqueue_cancel(seeknode_workqueue_t* queue, const void* key)
+{
+	std::unique_lock<std::mutex> lock(queue->mutex);
+	const size_t num_pending = queue->pending.size();
+	queue->pending.erase(
+		std::remove_if(queue->pending.begin(), queue->pending.end(), [&](const seeknode_work_t& work) { return work.key == key; }),
+		queue->pending.end());
+	queue->work_done.wait(lock, [&]() { return !seeknode_workqueue_is_running(queue, key); });
+	return num_pending - queue->pending.size();
+}
+
+void seeknode_workqueue_stop(seeknode_workqueue_t* queue)
+{
+	{
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		queue->pending.clear();
+		queue->is_stopping = true;
+		queue->work_available.notify_all();
+	}
+	for(std::thread& thread : queue->threads)
+	{
+		thread.join();
+	}
+	queue->threads.clear();
+}